@@ -0,0 +1,141 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/atom/atom-test-utils.c"
+#include "lv2/atom/atom.h"
+#include "lv2/atom/capture.h"
+#include "lv2/atom/file.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CAPTURE_PATH "capture-test.lv2atom"
+#define N_CYCLES     16
+#define BLOCK_SIZE   64
+
+static const char*
+urid_unmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+	(void)handle;
+	return (urid > 0 && urid <= n_uris) ? uris[urid - 1] : NULL;
+}
+
+/** Write the input for a cycle, with `cycle` events of one URID each. */
+static LV2_Atom_Sequence*
+forge_cycle(LV2_Atom_Forge* forge, uint8_t* buf, uint32_t size, int cycle)
+{
+	const LV2_URID key = urid_map(NULL, "urn:test:key");
+
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_set_buffer(forge, buf, size);
+	LV2_Atom_Sequence* const seq = (LV2_Atom_Sequence*)lv2_atom_forge_deref(
+		forge, lv2_atom_forge_sequence_head(forge, &frame, 0));
+	for (int i = 0; i < cycle; ++i) {
+		lv2_atom_forge_frame_time(forge, i * BLOCK_SIZE / N_CYCLES);
+		lv2_atom_forge_urid(forge, key);
+	}
+	lv2_atom_forge_pop(forge, &frame);
+	return seq;
+}
+
+int
+main(void)
+{
+	LV2_URID_Map   map   = { NULL, urid_map };
+	LV2_URID_Unmap unmap = { NULL, urid_unmap };
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, &map);
+
+	uint64_t mem[64];
+	FILE*    stream = fopen(CAPTURE_PATH, "wb");
+	if (!stream) {
+		return test_fail("Failed to open %s\n", CAPTURE_PATH);
+	}
+
+	// Capture cycles with increasing numbers of events and block lengths
+	LV2_Atom_Capture capture;
+	if (lv2_atom_capture_open(&capture, stream, &map, &unmap)) {
+		return test_fail("Failed to start capture\n");
+	}
+
+	for (int i = 0; i < N_CYCLES; ++i) {
+		const LV2_Atom_Sequence* const seq =
+			forge_cycle(&forge, (uint8_t*)mem, sizeof(mem), i);
+		if (lv2_atom_capture_cycle(&capture, BLOCK_SIZE + i, seq)) {
+			return test_fail("Failed to capture cycle %d\n", i);
+		}
+	}
+
+	if (lv2_atom_capture_close(&capture)) {
+		return test_fail("Failed to finish capture\n");
+	}
+	fclose(stream);
+
+	// Replay cycles twice and check they match
+	LV2_Atom_Replay replay;
+	if (lv2_atom_replay_open(&replay, CAPTURE_PATH, &map)) {
+		return test_fail("Failed to open capture\n");
+	} else if (replay.n_cycles != N_CYCLES) {
+		return test_fail("Capture has %u cycles\n", replay.n_cycles);
+	}
+
+	for (int pass = 0; pass < 2; ++pass) {
+		int                      i        = 0;
+		uint32_t                 n_frames = 0;
+		const LV2_Atom_Sequence* seq      = NULL;
+		while ((seq = lv2_atom_replay_next(&replay, &n_frames))) {
+			const LV2_Atom_Sequence* const expected =
+				forge_cycle(&forge, (uint8_t*)mem, sizeof(mem), i);
+			if (n_frames != (uint32_t)(BLOCK_SIZE + i)) {
+				return test_fail("Cycle %d has %u frames\n", i, n_frames);
+			} else if (!lv2_atom_equals(&seq->atom, &expected->atom)) {
+				return test_fail("Cycle %d sequence differs\n", i);
+			}
+			++i;
+		}
+
+		if (i != N_CYCLES) {
+			return test_fail("Replayed %d cycles\n", i);
+		}
+		lv2_atom_replay_rewind(&replay);
+	}
+
+	lv2_atom_replay_close(&replay);
+
+	// A file of atoms that are not cycles is not a capture
+	stream = fopen(CAPTURE_PATH, "wb");
+	LV2_Atom_File_Types types;
+	lv2_atom_file_types_init(&types, &map);
+
+	const LV2_Atom* const seq =
+		&forge_cycle(&forge, (uint8_t*)mem, sizeof(mem), 4)->atom;
+	if (!stream || lv2_atom_file_write(stream, &types, &unmap, &seq, 1)) {
+		return test_fail("Failed to write file\n");
+	}
+	fclose(stream);
+
+	if (lv2_atom_replay_open(&replay, CAPTURE_PATH, &map) !=
+	    LV2_ATOM_FILE_ERR_ATOM) {
+		return test_fail("Opened file that is not a capture\n");
+	}
+
+	remove(CAPTURE_PATH);
+	return 0;
+}
@@ -0,0 +1,259 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @file capture.h Capturing and replaying sequences.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup capture Capture
+   @ingroup atom
+
+   Recording the sequences sent to a port, and replaying them later.
+
+   A capture records the input of an atom port for every cycle, so the same
+   input can be given to a plugin again, for example to benchmark it with
+   realistic control traffic.  A capture is an atom file (see file.h) with an
+   atom for every cycle: a Tuple of an Int, the number of frames in the cycle,
+   and the Sequence.  Captures can be replayed in a different host, since
+   URIDs are translated when they are loaded.
+
+   Capturing writes to a file, so is not realtime safe.  A host that captures
+   from the audio thread should copy sequences to another thread to be
+   written.
+
+   @{
+*/
+
+#ifndef LV2_ATOM_CAPTURE_H
+#define LV2_ATOM_CAPTURE_H
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/file.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @cond */
+#define LV2_ATOM_CAPTURE_INT_SIZE 16U  // Padded size of an Int in a tuple
+/** @endcond */
+
+/** A capture being recorded. */
+typedef struct {
+	LV2_Atom_File_Writer writer;    /**< Writer for capture file */
+	LV2_URID             atom_Int;  /**< URID of atom:Int */
+	uint8_t*             buf;       /**< Buffer for cycle tuples */
+	size_t               buf_size;  /**< Size of `buf` in bytes */
+} LV2_Atom_Capture;
+
+/** A capture being replayed. */
+typedef struct {
+	LV2_Atom_File   file;      /**< Loaded capture file */
+	const LV2_Atom* next;      /**< Next cycle */
+	uint32_t        n_cycles;  /**< Number of cycles */
+} LV2_Atom_Replay;
+
+/**
+   Start capturing to `stream`.
+
+   @param capture The capture to initialise.
+   @param stream Stream to write to, opened in binary mode, which must be
+   seekable.
+   @param map URID mapper, for the types written.
+   @param unmap URID unmapper, for the URI table.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_capture_open(LV2_Atom_Capture* capture,
+                      FILE*             stream,
+                      LV2_URID_Map*     map,
+                      LV2_URID_Unmap*   unmap)
+{
+	LV2_Atom_File_Types types;
+	lv2_atom_file_types_init(&types, map);
+
+	capture->atom_Int = map->map(map->handle, LV2_ATOM__Int);
+	capture->buf      = NULL;
+	capture->buf_size = 0;
+	return lv2_atom_file_writer_open(&capture->writer, stream, &types, unmap);
+}
+
+/**
+   Record one cycle.
+
+   @param capture The capture to record into.
+   @param n_frames The number of frames in the cycle, the `sample_count`
+   parameter of run().
+   @param seq The sequence given to the port for the cycle.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_capture_cycle(LV2_Atom_Capture*        capture,
+                       uint32_t                 n_frames,
+                       const LV2_Atom_Sequence* seq)
+{
+	const LV2_Atom_Int frames   = { { sizeof(int32_t), capture->atom_Int },
+	                                (int32_t)n_frames };
+	const uint32_t     seq_size = lv2_atom_total_size(&seq->atom);
+	const size_t       size     = sizeof(LV2_Atom) + LV2_ATOM_CAPTURE_INT_SIZE +
+	                              lv2_atom_pad_size(seq_size);
+
+	if (size > capture->buf_size) {
+		uint8_t* const buf = (uint8_t*)realloc(capture->buf, size);
+		if (!buf) {
+			// Record the error so it is reported when the capture is closed
+			if (!capture->writer.status) {
+				capture->writer.status = LV2_ATOM_FILE_ERR_NO_MEM;
+			}
+			return capture->writer.status;
+		}
+
+		capture->buf      = buf;
+		capture->buf_size = size;
+	}
+
+	// Build tuple in buffer, since the writer appends whole atoms
+	LV2_Atom* const tuple = (LV2_Atom*)capture->buf;
+	tuple->size           = (uint32_t)(size - sizeof(LV2_Atom));
+	tuple->type           = capture->writer.types.atom_Tuple;
+	memset(tuple + 1, 0, LV2_ATOM_CAPTURE_INT_SIZE);
+	memcpy(tuple + 1, &frames, sizeof(frames));
+	memcpy((uint8_t*)(tuple + 1) + LV2_ATOM_CAPTURE_INT_SIZE, seq, seq_size);
+
+	return lv2_atom_file_writer_append(&capture->writer, tuple);
+}
+
+/**
+   Finish a capture, and free everything used by it.
+
+   @return The first error that occurred while capturing, if any.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_capture_close(LV2_Atom_Capture* capture)
+{
+	free(capture->buf);
+	capture->buf      = NULL;
+	capture->buf_size = 0;
+	return lv2_atom_file_writer_close(&capture->writer);
+}
+
+/**
+   Open a capture file to replay.
+
+   Every cycle is checked when the capture is opened, so cycles can be
+   replayed with no further checks.
+
+   @param replay The replay to initialise.
+   @param path Path of the capture file.
+   @param map URID mapper for the replaying host.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_replay_open(LV2_Atom_Replay* replay,
+                     const char*      path,
+                     LV2_URID_Map*    map)
+{
+	const LV2_URID atom_Int      = map->map(map->handle, LV2_ATOM__Int);
+	const LV2_URID atom_Sequence = map->map(map->handle, LV2_ATOM__Sequence);
+	const LV2_URID atom_Tuple    = map->map(map->handle, LV2_ATOM__Tuple);
+
+	const LV2_Atom_File_Status status =
+		lv2_atom_file_open(&replay->file, path, map);
+	if (status) {
+		return status;
+	}
+
+	LV2_ATOM_FILE_FOREACH(&replay->file, cycle) {
+		if (cycle->type != atom_Tuple ||
+		    cycle->size < (LV2_ATOM_CAPTURE_INT_SIZE +
+		                   sizeof(LV2_Atom_Sequence))) {
+			lv2_atom_file_close(&replay->file);
+			return LV2_ATOM_FILE_ERR_ATOM;
+		}
+
+		// The file is valid, so the tuple elements fit in the tuple
+		const LV2_Atom* const frames = (const LV2_Atom*)(cycle + 1);
+		const LV2_Atom* const seq    = lv2_atom_tuple_next(frames);
+		if (frames->type != atom_Int || frames->size != sizeof(int32_t) ||
+		    seq->type != atom_Sequence ||
+		    cycle->size != LV2_ATOM_CAPTURE_INT_SIZE +
+		                       lv2_atom_pad_size(lv2_atom_total_size(seq))) {
+			lv2_atom_file_close(&replay->file);
+			return LV2_ATOM_FILE_ERR_ATOM;
+		}
+	}
+
+	replay->next     = replay->file.body;
+	replay->n_cycles = replay->file.n_atoms;
+	return LV2_ATOM_FILE_SUCCESS;
+}
+
+/**
+   Return the next cycle in a replay, or NULL at the end.
+
+   @param replay The replay to read from.
+   @param n_frames Set to the number of frames in the cycle.
+*/
+static inline const LV2_Atom_Sequence*
+lv2_atom_replay_next(LV2_Atom_Replay* replay, uint32_t* n_frames)
+{
+	const LV2_Atom* const cycle = replay->next;
+	if (lv2_atom_tuple_is_end(
+		    replay->file.body, replay->file.body_size, cycle)) {
+		return NULL;
+	}
+
+	const LV2_Atom_Int* const frames = (const LV2_Atom_Int*)(cycle + 1);
+
+	*n_frames    = (uint32_t)frames->body;
+	replay->next = lv2_atom_tuple_next(cycle);
+	return (const LV2_Atom_Sequence*)lv2_atom_tuple_next(&frames->atom);
+}
+
+/** Go back to the first cycle of a replay. */
+static inline void
+lv2_atom_replay_rewind(LV2_Atom_Replay* replay)
+{
+	replay->next = replay->file.body;
+}
+
+/** Close a replay, and free everything used by it. */
+static inline void
+lv2_atom_replay_close(LV2_Atom_Replay* replay)
+{
+	lv2_atom_file_close(&replay->file);
+	replay->next     = NULL;
+	replay->n_cycles = 0;
+}
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif /* LV2_ATOM_CAPTURE_H */
@@ -0,0 +1,203 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark for atom files.
+
+   Writes a file with a large Vector of Float, like sample peaks, and a
+   sequence of many small objects, like a recorded control stream.  The file
+   is then loaded with lv2_atom_file_open(), which maps it into memory, and by
+   reading it into memory and calling lv2_atom_file_load().  Both translate
+   every URID and validate the atoms.  Results are printed as tab-separated
+   lines of name, file size in bytes, and MB/s.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/file.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FILE_PATH "file-bench.lv2atom"
+#define N_FLOATS  (4 * 1024 * 1024)
+#define N_EVENTS  65536
+#define N_REPEATS 10
+#define CAPACITY  (N_FLOATS * 4 + N_EVENTS * 64 + 1024)
+
+static const char* const uris[] = {
+	LV2_ATOM__Blank,    LV2_ATOM__Float,    LV2_ATOM__Int,
+	LV2_ATOM__Literal,  LV2_ATOM__Object,   LV2_ATOM__Resource,
+	LV2_ATOM__Sequence, LV2_ATOM__Tuple,    LV2_ATOM__URID,
+	LV2_ATOM__Vector,   LV2_ATOM__frameTime,
+	"http://example.org/Control", "http://example.org/value",
+	"http://example.org/index" };
+
+#define N_URIS (sizeof(uris) / sizeof(uris[0]))
+
+static LV2_URID
+urid_map(LV2_URID_Map_Handle handle, const char* uri)
+{
+	const LV2_URID offset = *(const LV2_URID*)handle;
+	for (uint32_t i = 0; i < N_URIS; ++i) {
+		if (!strcmp(uri, uris[i])) {
+			return offset + i;
+		}
+	}
+
+	return 0;
+}
+
+static const char*
+urid_unmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+	const LV2_URID offset = *(const LV2_URID*)handle;
+	return (urid >= offset && urid < offset + N_URIS) ? uris[urid - offset]
+	                                                  : NULL;
+}
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/** Write a vector of floats and a sequence of objects to `buf`. */
+static void
+make_atoms(LV2_URID_Map* map, uint8_t* buf, LV2_Atom** atoms)
+{
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, map);
+	lv2_atom_forge_set_buffer(&forge, buf, CAPACITY);
+
+	const LV2_URID control = map->map(map->handle, uris[11]);
+	const LV2_URID value   = map->map(map->handle, uris[12]);
+	const LV2_URID index   = map->map(map->handle, uris[13]);
+
+	float* const floats = (float*)malloc(N_FLOATS * sizeof(float));
+	for (uint32_t i = 0; i < N_FLOATS; ++i) {
+		floats[i] = (float)(i % 1000) / 1000.0f;
+	}
+	atoms[0] = lv2_atom_forge_deref(
+		&forge,
+		lv2_atom_forge_vector(
+			&forge, sizeof(float), forge.Float, N_FLOATS, floats));
+	free(floats);
+
+	LV2_Atom_Forge_Frame seq_frame;
+	atoms[1] = lv2_atom_forge_deref(
+		&forge, lv2_atom_forge_sequence_head(&forge, &seq_frame, 0));
+	for (uint32_t i = 0; i < N_EVENTS; ++i) {
+		LV2_Atom_Forge_Frame frame;
+		lv2_atom_forge_frame_time(&forge, i);
+		lv2_atom_forge_object(&forge, &frame, 0, control);
+		lv2_atom_forge_key(&forge, index);
+		lv2_atom_forge_int(&forge, (int32_t)(i % 16));
+		lv2_atom_forge_key(&forge, value);
+		lv2_atom_forge_float(&forge, (float)i);
+		lv2_atom_forge_pop(&forge, &frame);
+	}
+	lv2_atom_forge_pop(&forge, &seq_frame);
+}
+
+int
+main(void)
+{
+	// The loading host maps URIs to different URIDs than the writing host
+	LV2_URID       write_offset = 1;
+	LV2_URID       load_offset  = 101;
+	LV2_URID_Map   write_map    = { &write_offset, urid_map };
+	LV2_URID_Unmap write_unmap  = { &write_offset, urid_unmap };
+	LV2_URID_Map   load_map     = { &load_offset, urid_map };
+
+	uint8_t* const buf = (uint8_t*)calloc(1, CAPACITY);
+	LV2_Atom*      atoms[2];
+	make_atoms(&write_map, buf, atoms);
+
+	LV2_Atom_File_Types types;
+	lv2_atom_file_types_init(&types, &write_map);
+
+	double start  = now();
+	FILE*  stream = NULL;
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		stream = fopen(FILE_PATH, "wb");
+		if (!stream || lv2_atom_file_write(stream,
+		                                   &types,
+		                                   &write_unmap,
+		                                   (const LV2_Atom* const*)atoms,
+		                                   2)) {
+			fprintf(stderr, "error: Failed to write %s\n", FILE_PATH);
+			return 1;
+		}
+		fclose(stream);
+	}
+	const double write_ns = now() - start;
+
+	// Open by mapping into memory
+	LV2_Atom_File file;
+	size_t        size = 0;
+	start              = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		if (lv2_atom_file_open(&file, FILE_PATH, &load_map)) {
+			fprintf(stderr, "error: Failed to open %s\n", FILE_PATH);
+			return 1;
+		}
+		size = file.size;
+		lv2_atom_file_close(&file);
+	}
+	const double open_ns = now() - start;
+
+	// Read into memory and load
+	uint8_t* const data = (uint8_t*)malloc(size);
+	start               = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		stream = fopen(FILE_PATH, "rb");
+		if (!stream || fread(data, 1, size, stream) != size ||
+		    lv2_atom_file_load(&file, data, size, &load_map)) {
+			fprintf(stderr, "error: Failed to load %s\n", FILE_PATH);
+			return 1;
+		}
+		fclose(stream);
+	}
+	const double load_ns = now() - start;
+
+	// Check that the loaded objects have URIDs of the loading host
+	const LV2_Atom* const seq = lv2_atom_tuple_next(file.body);
+	if (file.body->type != 101 + 9 || seq->type != 101 + 6) {
+		fprintf(stderr, "error: Loaded atoms have wrong types\n");
+		return 1;
+	}
+
+	remove(FILE_PATH);
+
+	const double mb = (double)size * N_REPEATS / 1e6;
+	printf("write\t%u\t%.1f\n", (unsigned)size, mb / (write_ns / 1e9));
+	printf("open\t%u\t%.1f\n", (unsigned)size, mb / (open_ns / 1e9));
+	printf("read_load\t%u\t%.1f\n", (unsigned)size, mb / (load_ns / 1e9));
+
+	free(data);
+	free(buf);
+	return 0;
+}
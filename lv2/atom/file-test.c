@@ -0,0 +1,213 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/atom/atom-test-utils.c"
+#include "lv2/atom/atom.h"
+#include "lv2/atom/file.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_PATH "file-test.lv2atom"
+
+/** Offset of URIDs in the loading host from those in the writing host. */
+#define LOAD_OFFSET 1000
+
+static const char*
+urid_unmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+	(void)handle;
+	return (urid > 0 && urid <= n_uris) ? uris[urid - 1] : NULL;
+}
+
+/** Map URIs to different URIDs than urid_map(), as another host would. */
+static LV2_URID
+load_map(LV2_URID_Map_Handle handle, const char* uri)
+{
+	(void)handle;
+	return urid_map(NULL, uri) + LOAD_OFFSET;
+}
+
+/** Write a tuple, an object, and a sequence with every kind of URID. */
+static uint32_t
+forge_atoms(LV2_URID_Map* map, uint8_t* buf, uint32_t size, LV2_Atom** atoms)
+{
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, map);
+	lv2_atom_forge_set_buffer(&forge, buf, size);
+
+	const LV2_URID key   = map->map(map->handle, "http://example.org/key");
+	const LV2_URID otype = map->map(map->handle, "http://example.org/Type");
+	const LV2_URID datatype =
+		map->map(map->handle, "http://example.org/datatype");
+	const LV2_URID elems[] = { key, otype };
+
+	LV2_Atom_Forge_Frame frame;
+	LV2_Atom_Forge_Frame obj_frame;
+	atoms[0] = lv2_atom_forge_deref(
+		&forge, lv2_atom_forge_tuple(&forge, &frame));
+	lv2_atom_forge_urid(&forge, key);
+	lv2_atom_forge_literal(&forge, "text", 4, datatype, 0);
+	lv2_atom_forge_vector(&forge, sizeof(LV2_URID), forge.URID, 2, elems);
+	lv2_atom_forge_pop(&forge, &frame);
+
+	atoms[1] = lv2_atom_forge_deref(
+		&forge, lv2_atom_forge_object(&forge, &frame, 0, otype));
+	lv2_atom_forge_key(&forge, key);
+	lv2_atom_forge_object(&forge, &obj_frame, key, otype);
+	lv2_atom_forge_key(&forge, key);
+	lv2_atom_forge_int(&forge, 42);
+	lv2_atom_forge_pop(&forge, &obj_frame);
+	lv2_atom_forge_pop(&forge, &frame);
+
+	atoms[2] = lv2_atom_forge_deref(
+		&forge, lv2_atom_forge_sequence_head(&forge, &frame, 0));
+	lv2_atom_forge_frame_time(&forge, 0);
+	lv2_atom_forge_urid(&forge, otype);
+	lv2_atom_forge_pop(&forge, &frame);
+
+	return 3;
+}
+
+static int
+check_file(const LV2_Atom_File* file, LV2_Atom* const* expected)
+{
+	uint32_t i = 0;
+	LV2_ATOM_FILE_FOREACH(file, atom) {
+		if (!lv2_atom_equals(atom, expected[i++])) {
+			return test_fail("Loaded atom %u differs\n", i - 1);
+		}
+	}
+
+	return (i == file->n_atoms) ? 0 : test_fail("Loaded %u atoms\n", i);
+}
+
+int
+main(void)
+{
+	LV2_URID_Map   map   = { NULL, urid_map };
+	LV2_URID_Unmap unmap = { NULL, urid_unmap };
+	LV2_URID_Map   load  = { NULL, load_map };
+
+	// Make atoms, and the same atoms with URIDs of the loading host
+	uint64_t  mem[2][64];
+	LV2_Atom* atoms[3];
+	LV2_Atom* expected[3];
+	const uint32_t n_atoms = forge_atoms(&map, (uint8_t*)mem[0], 512, atoms);
+	forge_atoms(&load, (uint8_t*)mem[1], 512, expected);
+
+	LV2_Atom_File_Types types;
+	lv2_atom_file_types_init(&types, &map);
+
+	// Write file
+	FILE* stream = fopen(FILE_PATH, "wb");
+	if (!stream) {
+		return test_fail("Failed to open %s\n", FILE_PATH);
+	} else if (lv2_atom_file_write(stream,
+	                               &types,
+	                               &unmap,
+	                               (const LV2_Atom* const*)atoms,
+	                               n_atoms)) {
+		return test_fail("Failed to write file\n");
+	}
+	fclose(stream);
+
+	// Open file, which translates URIDs to the loading host
+	LV2_Atom_File file;
+	if (lv2_atom_file_open(&file, FILE_PATH, &load)) {
+		return test_fail("Failed to open file\n");
+	} else if (file.n_atoms != n_atoms || check_file(&file, expected)) {
+		return test_fail("Opened file differs\n");
+	}
+
+	// Load a copy from memory
+	const size_t    size = file.size;
+	uint64_t* const data = (uint64_t*)malloc(size);
+	stream               = fopen(FILE_PATH, "rb");
+	if (!stream || fread(data, 1, size, stream) != size) {
+		return test_fail("Failed to read file\n");
+	}
+	fclose(stream);
+	lv2_atom_file_close(&file);
+	remove(FILE_PATH);
+
+	uint64_t* const copy = (uint64_t*)malloc(size);
+	memcpy(copy, data, size);
+	if (lv2_atom_file_load(&file, copy, size, &load) ||
+	    check_file(&file, expected)) {
+		return test_fail("Failed to load file from memory\n");
+	}
+
+	// Corrupt the last byte of the URI table
+	memcpy(copy, data, size);
+	((uint8_t*)copy)[size - 1] ^= 1;
+	if (lv2_atom_file_load(&file, copy, size, &load) !=
+	    LV2_ATOM_FILE_ERR_CORRUPT) {
+		return test_fail("Loaded corrupt file\n");
+	}
+
+	// Truncate file
+	memcpy(copy, data, size);
+	if (lv2_atom_file_load(&file, copy, size - 8, &load) !=
+	    LV2_ATOM_FILE_ERR_FORMAT) {
+		return test_fail("Loaded truncated file\n");
+	}
+
+	// Change version and magic
+	LV2_Atom_File_Header* const header = (LV2_Atom_File_Header*)copy;
+	header->version = LV2_ATOM_FILE_VERSION + 1;
+	if (lv2_atom_file_load(&file, copy, size, &load) !=
+	    LV2_ATOM_FILE_ERR_VERSION) {
+		return test_fail("Loaded file with unknown version\n");
+	}
+
+	header->magic[0] = 'X';
+	if (lv2_atom_file_load(&file, copy, size, &load) !=
+	    LV2_ATOM_FILE_ERR_FORMAT) {
+		return test_fail("Loaded file with bad magic\n");
+	}
+
+	// Claim more URIs than the table can hold
+	memcpy(copy, data, size);
+	header->n_uris = UINT32_MAX;
+	if (lv2_atom_file_load(&file, copy, size, &load) !=
+	    LV2_ATOM_FILE_ERR_FORMAT) {
+		return test_fail("Loaded file with too many URIs\n");
+	}
+
+	// Make the first atom too large for the file, with a valid checksum
+	memcpy(copy, data, size);
+	uint8_t* const body  = (uint8_t*)copy + sizeof(LV2_Atom_File_Header);
+	uint8_t* const table = body + header->body_size;
+	((LV2_Atom*)body)->size = (uint32_t)header->body_size;
+	header->checksum        = lv2_atom_hash_finish(lv2_atom_hash_update(
+		lv2_atom_hash_update(LV2_ATOM_HASH_SEED, body, header->body_size),
+		table,
+		header->uris_size));
+	if (lv2_atom_file_load(&file, copy, size, &load) !=
+	    LV2_ATOM_FILE_ERR_ATOM) {
+		return test_fail("Loaded file with atom larger than file\n");
+	}
+
+	free(copy);
+	free(data);
+	return 0;
+}
@@ -0,0 +1,847 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @file file.h Binary files of atoms.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup file Files
+   @ingroup atom
+
+   A compact binary file format for atoms.
+
+   An atom file stores a list of atoms in the same layout they have in
+   memory, so a file can be mapped into memory and read with the iterators in
+   util.h, without parsing.  This is much faster than Turtle for large values,
+   like a long Vector of Float.  Since URIDs are only meaningful within a
+   single run of a host, the file contains a table of the URIs of every URID
+   used, and URIDs are translated with a single pass over the atoms when the
+   file is loaded.
+
+   A file has a header, followed by the atoms, followed by the URI table.
+   Atoms are stored one after another and padded to 64 bits, like the body of
+   a Tuple.  URIDs in the file are numbered from 1 in the order of the URI
+   table.  Each URI table entry is a 32-bit length, followed by that many
+   bytes of URI and a terminating null, padded to 64 bits.  The URI table is
+   last so that files can be written incrementally.  Files are written in the
+   native byte order of the writer, which is checked when they are loaded.
+
+   These functions may allocate memory and do I/O, so they must not be called
+   from the audio thread.
+
+   @{
+*/
+
+#ifndef LV2_ATOM_FILE_H
+#define LV2_ATOM_FILE_H
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Magic string at the start of every atom file, including the null. */
+#define LV2_ATOM_FILE_MAGIC "LV2ATOM"
+
+/**
+   Version of the file format written by this header.
+
+   Version 1 had the URI table before the atoms, and is not supported.
+*/
+#define LV2_ATOM_FILE_VERSION 2U
+
+/** Value of a byte order field written in the native byte order. */
+#define LV2_ATOM_FILE_BYTE_ORDER 0x01020304U
+
+/** Status code for atom file functions. */
+typedef enum {
+	LV2_ATOM_FILE_SUCCESS     = 0,  /**< Completed successfully. */
+	LV2_ATOM_FILE_ERR_IO      = 1,  /**< Failed to read or write file. */
+	LV2_ATOM_FILE_ERR_FORMAT  = 2,  /**< Not an atom file. */
+	LV2_ATOM_FILE_ERR_VERSION = 3,  /**< Unsupported version or byte order. */
+	LV2_ATOM_FILE_ERR_CORRUPT = 4,  /**< Checksum does not match. */
+	LV2_ATOM_FILE_ERR_URI     = 5,  /**< Failed to map or unmap a URI. */
+	LV2_ATOM_FILE_ERR_ATOM    = 6,  /**< Invalid atom. */
+	LV2_ATOM_FILE_ERR_NO_MEM  = 7   /**< Failed to allocate memory. */
+} LV2_Atom_File_Status;
+
+/** Header at the start of an atom file. */
+typedef struct {
+	char     magic[8];    /**< LV2_ATOM_FILE_MAGIC */
+	uint32_t version;     /**< LV2_ATOM_FILE_VERSION */
+	uint32_t byte_order;  /**< LV2_ATOM_FILE_BYTE_ORDER */
+	uint32_t n_uris;      /**< Number of entries in URI table */
+	uint32_t n_atoms;     /**< Number of atoms */
+	uint64_t uris_size;   /**< Size of URI table in bytes */
+	uint64_t body_size;   /**< Size of atoms in bytes */
+	uint64_t checksum;    /**< Hash of atoms and URI table */
+} LV2_Atom_File_Header;
+
+/**
+   URIDs of the types which contain URIDs.
+
+   Atoms of these types, and any atoms they contain, have their URIDs
+   translated when written or loaded.  URIDs inside other types, for example
+   in the body of an atom with a type defined by a plugin, are not.
+*/
+typedef struct {
+	LV2_URID atom_Blank;
+	LV2_URID atom_Literal;
+	LV2_URID atom_Object;
+	LV2_URID atom_Resource;
+	LV2_URID atom_Sequence;
+	LV2_URID atom_Tuple;
+	LV2_URID atom_URID;
+	LV2_URID atom_Vector;
+} LV2_Atom_File_Types;
+
+/** An atom file loaded into memory. */
+typedef struct {
+	void*     data;       /**< Contents of the whole file */
+	size_t    size;       /**< Size of `data` in bytes */
+	LV2_Atom* body;       /**< First atom */
+	uint32_t  body_size;  /**< Size of all atoms in bytes */
+	uint32_t  n_atoms;    /**< Number of atoms */
+	bool      owned;      /**< True iff lv2_atom_file_close() frees `data` */
+} LV2_Atom_File;
+
+/** @cond */
+typedef LV2_URID (*LV2_Atom_File_Remap_Func)(void* handle, LV2_URID urid);
+
+typedef struct {
+	const LV2_Atom_File_Types* types;    // Types in host URIDs
+	LV2_Atom_File_Remap_Func   func;     // Translate one URID, 0 on error
+	void*                      handle;   // Data for `func`
+	bool                       to_host;  // True iff translating into host
+} LV2_Atom_File_Remap;
+/** @endcond */
+
+/** Initialise types, mapping their URIs. */
+static inline void
+lv2_atom_file_types_init(LV2_Atom_File_Types* types, LV2_URID_Map* map)
+{
+	types->atom_Blank    = map->map(map->handle, LV2_ATOM__Blank);
+	types->atom_Literal  = map->map(map->handle, LV2_ATOM__Literal);
+	types->atom_Object   = map->map(map->handle, LV2_ATOM__Object);
+	types->atom_Resource = map->map(map->handle, LV2_ATOM__Resource);
+	types->atom_Sequence = map->map(map->handle, LV2_ATOM__Sequence);
+	types->atom_Tuple    = map->map(map->handle, LV2_ATOM__Tuple);
+	types->atom_URID     = map->map(map->handle, LV2_ATOM__URID);
+	types->atom_Vector   = map->map(map->handle, LV2_ATOM__Vector);
+}
+
+/** @cond */
+static inline bool
+lv2_atom_file_remap_urid(const LV2_Atom_File_Remap* remap, LV2_URID* urid)
+{
+	if (*urid) {
+		*urid = remap->func(remap->handle, *urid);
+		return *urid != 0;
+	}
+
+	return true;
+}
+
+/**
+   Translate every URID in `atom`, which has `space` bytes available.
+
+   This checks that everything it reads is within bounds, since it is called
+   on untrusted files before they can be validated, which requires host URIDs.
+*/
+static inline bool
+lv2_atom_file_remap_atom(const LV2_Atom_File_Remap* remap,
+                         LV2_Atom*                  atom,
+                         size_t                     space,
+                         unsigned                   depth)
+{
+	if (depth > LV2_ATOM_VALIDATE_MAX_DEPTH || space < sizeof(LV2_Atom) ||
+	    atom->size > space - sizeof(LV2_Atom)) {
+		return false;
+	}
+
+	// Check type in host URIDs, before or after translating as appropriate
+	const LV2_URID old_type = atom->type;
+	if (!lv2_atom_file_remap_urid(remap, &atom->type)) {
+		return false;
+	}
+
+	const LV2_Atom_File_Types* const t    = remap->types;
+	const LV2_URID                   type = remap->to_host ? atom->type
+	                                                       : old_type;
+
+	uint8_t* const body = (uint8_t*)(atom + 1);
+	uint8_t* const end  = body + atom->size;
+	if (type == t->atom_URID) {
+		return atom->size >= sizeof(LV2_URID) &&
+		       lv2_atom_file_remap_urid(remap, (LV2_URID*)body);
+	}
+
+	if (type == t->atom_Literal) {
+		LV2_Atom_Literal_Body* const lit = (LV2_Atom_Literal_Body*)body;
+		return atom->size >= sizeof(LV2_Atom_Literal_Body) &&
+		       lv2_atom_file_remap_urid(remap, &lit->datatype) &&
+		       lv2_atom_file_remap_urid(remap, &lit->lang);
+	}
+
+	if (type == t->atom_Vector) {
+		LV2_Atom_Vector_Body* const vec = (LV2_Atom_Vector_Body*)body;
+		if (atom->size < sizeof(LV2_Atom_Vector_Body)) {
+			return false;
+		}
+
+		const LV2_URID old_child = vec->child_type;
+		if (!lv2_atom_file_remap_urid(remap, &vec->child_type)) {
+			return false;
+		}
+
+		const LV2_URID child = remap->to_host ? vec->child_type : old_child;
+		if (child == t->atom_URID && vec->child_size == sizeof(LV2_URID)) {
+			for (LV2_URID* u = (LV2_URID*)(vec + 1);
+			     (uint8_t*)(u + 1) <= end;
+			     ++u) {
+				if (!lv2_atom_file_remap_urid(remap, u)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	if (type == t->atom_Tuple) {
+		for (uint8_t* p = body; p < end;) {
+			LV2_Atom* const child = (LV2_Atom*)p;
+			if (!lv2_atom_file_remap_atom(
+				    remap, child, (size_t)(end - p), depth + 1)) {
+				return false;
+			}
+			p += lv2_atom_pad_size(lv2_atom_total_size(child));
+		}
+		return true;
+	}
+
+	if (type == t->atom_Object || type == t->atom_Blank ||
+	    type == t->atom_Resource) {
+		LV2_Atom_Object_Body* const obj = (LV2_Atom_Object_Body*)body;
+		if (atom->size < sizeof(LV2_Atom_Object_Body) ||
+		    !lv2_atom_file_remap_urid(remap, &obj->id) ||
+		    !lv2_atom_file_remap_urid(remap, &obj->otype)) {
+			return false;
+		}
+
+		for (uint8_t* p = (uint8_t*)(obj + 1); p < end;) {
+			LV2_Atom_Property_Body* const prop = (LV2_Atom_Property_Body*)p;
+			if ((size_t)(end - p) < 2 * sizeof(uint32_t) ||
+			    !lv2_atom_file_remap_urid(remap, &prop->key) ||
+			    !lv2_atom_file_remap_urid(remap, &prop->context) ||
+			    !lv2_atom_file_remap_atom(remap,
+			                              &prop->value,
+			                              (size_t)(end - p) - 8,
+			                              depth + 1)) {
+				return false;
+			}
+			p += 8 + lv2_atom_pad_size(lv2_atom_total_size(&prop->value));
+		}
+		return true;
+	}
+
+	if (type == t->atom_Sequence) {
+		LV2_Atom_Sequence_Body* const seq = (LV2_Atom_Sequence_Body*)body;
+		if (atom->size < sizeof(LV2_Atom_Sequence_Body) ||
+		    !lv2_atom_file_remap_urid(remap, &seq->unit)) {
+			return false;
+		}
+
+		for (uint8_t* p = (uint8_t*)(seq + 1); p < end;) {
+			LV2_Atom_Event* const ev = (LV2_Atom_Event*)p;
+			if ((size_t)(end - p) < sizeof(int64_t) ||
+			    !lv2_atom_file_remap_atom(remap,
+			                              &ev->body,
+			                              (size_t)(end - p) - 8,
+			                              depth + 1)) {
+				return false;
+			}
+			p += 8 + lv2_atom_pad_size(lv2_atom_total_size(&ev->body));
+		}
+	}
+
+	return true;
+}
+
+/** Translate URIDs in every atom in a body of `size` bytes. */
+static inline bool
+lv2_atom_file_remap_body(const LV2_Atom_File_Remap* remap,
+                         uint8_t*                   body,
+                         size_t                     size)
+{
+	for (uint8_t* p = body; p < body + size;) {
+		LV2_Atom* const atom = (LV2_Atom*)p;
+		if (!lv2_atom_file_remap_atom(
+			    remap, atom, (size_t)(body + size - p), 0)) {
+			return false;
+		}
+		p += lv2_atom_pad_size(lv2_atom_total_size(atom));
+	}
+
+	return true;
+}
+
+/** Translate a file URID to a host URID with a table. */
+static inline LV2_URID
+lv2_atom_file_load_urid(void* handle, LV2_URID urid)
+{
+	const LV2_URID* const table = (const LV2_URID*)handle;
+	return urid <= table[0] ? table[urid] : 0U;
+}
+
+typedef struct {
+	LV2_URID host;  // URID in host, or 0 for an empty slot
+	LV2_URID file;  // URID in file
+} LV2_Atom_File_URID_Slot;
+/** @endcond */
+
+/**
+   A writer for an atom file.
+
+   A writer appends atoms to a file one at a time, so atoms can be written as
+   they arrive, for example once per cycle.  URIDs are numbered in the file in
+   the order they are first used, and the URI table is written after the
+   atoms when the writer is closed.  The header is written last, so the
+   stream must be seekable, as a regular file is.
+*/
+typedef struct {
+	FILE*                    stream;     /**< Stream being written */
+	long                     start;      /**< Position of header in stream */
+	LV2_Atom_File_Types      types;      /**< Types with host URIDs */
+	LV2_URID_Unmap*          unmap;      /**< URID unmapper for URI table */
+	LV2_Atom_File_Header     header;     /**< Header, written on close */
+	uint64_t                 hash;       /**< Checksum of data so far */
+	LV2_Atom_File_URID_Slot* slots;      /**< Hash table of URIDs */
+	uint32_t                 n_slots;    /**< Size of table, a power of two */
+	LV2_URID*                urids;      /**< Host URID for each file URID */
+	uint32_t                 n_urids;    /**< Number of URIDs in file */
+	uint8_t*                 buf;        /**< Scratch buffer for atoms */
+	size_t                   buf_size;   /**< Size of `buf` in bytes */
+	LV2_Atom_File_Status     status;     /**< First error, if any */
+} LV2_Atom_File_Writer;
+
+/** @cond */
+static inline LV2_Atom_File_URID_Slot*
+lv2_atom_file_writer_slot(const LV2_Atom_File_URID_Slot* slots,
+                          uint32_t                       n_slots,
+                          LV2_URID                       urid)
+{
+	const uint32_t mask = n_slots - 1U;
+	for (uint32_t i = (urid * 2654435761U) & mask;; i = (i + 1U) & mask) {
+		if (!slots[i].host || slots[i].host == urid) {
+			return (LV2_Atom_File_URID_Slot*)&slots[i];
+		}
+	}
+}
+
+/** Translate a host URID to a file URID, adding it to the file if new. */
+static inline LV2_URID
+lv2_atom_file_writer_urid(void* handle, LV2_URID urid)
+{
+	LV2_Atom_File_Writer* const writer = (LV2_Atom_File_Writer*)handle;
+
+	LV2_Atom_File_URID_Slot* slot =
+		lv2_atom_file_writer_slot(writer->slots, writer->n_slots, urid);
+	if (slot->host) {
+		return slot->file;
+	}
+
+	// Grow table and list to keep the table at most half full
+	if (writer->n_urids + 1U > writer->n_slots / 2U) {
+		const uint32_t                 n_slots = writer->n_slots * 2U;
+		LV2_Atom_File_URID_Slot* const slots =
+			(LV2_Atom_File_URID_Slot*)calloc(n_slots, sizeof(*slots));
+		LV2_URID* const urids = (LV2_URID*)realloc(
+			writer->urids, n_slots / 2U * sizeof(LV2_URID));
+		if (!slots || !urids) {
+			free(slots);
+			writer->urids  = urids ? urids : writer->urids;
+			writer->status = LV2_ATOM_FILE_ERR_NO_MEM;
+			return 0;
+		}
+
+		for (uint32_t i = 0; i < writer->n_slots; ++i) {
+			if (writer->slots[i].host) {
+				*lv2_atom_file_writer_slot(
+					slots, n_slots, writer->slots[i].host) = writer->slots[i];
+			}
+		}
+
+		free(writer->slots);
+		writer->slots   = slots;
+		writer->n_slots = n_slots;
+		writer->urids   = urids;
+		slot = lv2_atom_file_writer_slot(slots, n_slots, urid);
+	}
+
+	writer->urids[writer->n_urids++] = urid;
+	slot->host                       = urid;
+	slot->file                       = writer->n_urids;
+	return slot->file;
+}
+
+/** Write `size` bytes of `data` and add them to the checksum. */
+static inline LV2_Atom_File_Status
+lv2_atom_file_writer_write(LV2_Atom_File_Writer* writer,
+                           const void*           data,
+                           size_t                size)
+{
+	if (fwrite(data, 1, size, writer->stream) != size) {
+		return LV2_ATOM_FILE_ERR_IO;
+	}
+
+	writer->hash = lv2_atom_hash_update(writer->hash, data, size);
+	return LV2_ATOM_FILE_SUCCESS;
+}
+
+/** Make the scratch buffer at least `size` bytes. */
+static inline LV2_Atom_File_Status
+lv2_atom_file_writer_reserve(LV2_Atom_File_Writer* writer, size_t size)
+{
+	if (size > writer->buf_size) {
+		uint8_t* const buf = (uint8_t*)realloc(writer->buf, size);
+		if (!buf) {
+			return LV2_ATOM_FILE_ERR_NO_MEM;
+		}
+
+		writer->buf      = buf;
+		writer->buf_size = size;
+	}
+
+	return LV2_ATOM_FILE_SUCCESS;
+}
+/** @endcond */
+
+/**
+   Open a writer, and start a file at the current position of `stream`.
+
+   @param writer The writer to initialise.
+   @param stream Stream to write to, opened in binary mode.
+   @param types Types with URIDs, from lv2_atom_file_types_init().
+   @param unmap URID unmapper for the URI table.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_file_writer_open(LV2_Atom_File_Writer*      writer,
+                          FILE*                      stream,
+                          const LV2_Atom_File_Types* types,
+                          LV2_URID_Unmap*            unmap)
+{
+	memset(writer, 0, sizeof(LV2_Atom_File_Writer));
+	writer->stream  = stream;
+	writer->start   = ftell(stream);
+	writer->types   = *types;
+	writer->unmap   = unmap;
+	writer->hash    = LV2_ATOM_HASH_SEED;
+	writer->n_slots = 64;
+	writer->slots   = (LV2_Atom_File_URID_Slot*)calloc(
+		writer->n_slots, sizeof(LV2_Atom_File_URID_Slot));
+	writer->urids = (LV2_URID*)calloc(writer->n_slots / 2, sizeof(LV2_URID));
+	if (!writer->slots || !writer->urids) {
+		return (writer->status = LV2_ATOM_FILE_ERR_NO_MEM);
+	}
+
+	memcpy(writer->header.magic,
+	       LV2_ATOM_FILE_MAGIC,
+	       sizeof(LV2_ATOM_FILE_MAGIC));
+	writer->header.version    = LV2_ATOM_FILE_VERSION;
+	writer->header.byte_order = LV2_ATOM_FILE_BYTE_ORDER;
+
+	// Write the header now to reserve space, it is rewritten on close
+	if (writer->start < 0 ||
+	    fwrite(&writer->header, sizeof(writer->header), 1, stream) != 1) {
+		writer->status = LV2_ATOM_FILE_ERR_IO;
+	}
+
+	return writer->status;
+}
+
+/**
+   Append an atom to a file.
+
+   After an error, nothing more is written, and the error is returned by
+   every further call, including lv2_atom_file_writer_close().
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_file_writer_append(LV2_Atom_File_Writer* writer,
+                            const LV2_Atom*       atom)
+{
+	const uint32_t size   = lv2_atom_total_size(atom);
+	const uint32_t padded = lv2_atom_pad_size(size);
+	if (writer->status ||
+	    (writer->status = lv2_atom_file_writer_reserve(writer, padded))) {
+		return writer->status;
+	}
+
+	// Copy atom with zero padding, so the checksum is deterministic
+	memcpy(writer->buf, atom, size);
+	memset(writer->buf + size, 0, padded - size);
+
+	const LV2_Atom_File_Remap remap = {
+		&writer->types, lv2_atom_file_writer_urid, writer, false };
+	if (!lv2_atom_file_remap_body(&remap, writer->buf, padded)) {
+		// Keep the status set if translating a URID failed to allocate
+		if (!writer->status) {
+			writer->status = LV2_ATOM_FILE_ERR_ATOM;
+		}
+		return writer->status;
+	} else if ((writer->status =
+	                lv2_atom_file_writer_write(writer, writer->buf, padded))) {
+		return writer->status;
+	}
+
+	writer->header.body_size += padded;
+	++writer->header.n_atoms;
+	return LV2_ATOM_FILE_SUCCESS;
+}
+
+/**
+   Finish a file, and free everything used by the writer.
+
+   This writes the URI table and header, but does not close `stream`.
+
+   @return The first error that occurred while writing, if any.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_file_writer_close(LV2_Atom_File_Writer* writer)
+{
+	LV2_Atom_File_Header* const header = &writer->header;
+
+	// Write URI table
+	for (uint32_t i = 0; i < writer->n_urids && !writer->status; ++i) {
+		const char* const uri =
+			writer->unmap->unmap(writer->unmap->handle, writer->urids[i]);
+		if (!uri) {
+			writer->status = LV2_ATOM_FILE_ERR_URI;
+			break;
+		}
+
+		const uint32_t len  = (uint32_t)strlen(uri);
+		const uint32_t size = lv2_atom_pad_size(
+			(uint32_t)sizeof(len) + len + 1U);
+		if (!(writer->status = lv2_atom_file_writer_reserve(writer, size))) {
+			memset(writer->buf, 0, size);
+			memcpy(writer->buf, &len, sizeof(len));
+			memcpy(writer->buf + sizeof(len), uri, len);
+			writer->status =
+				lv2_atom_file_writer_write(writer, writer->buf, size);
+			header->uris_size += size;
+			++header->n_uris;
+		}
+	}
+
+	// Rewrite header, and leave stream at the end of the file
+	header->checksum = lv2_atom_hash_finish(writer->hash);
+	if (!writer->status &&
+	    (fseek(writer->stream, writer->start, SEEK_SET) ||
+	     fwrite(header, sizeof(*header), 1, writer->stream) != 1 ||
+	     fseek(writer->stream, 0, SEEK_END))) {
+		writer->status = LV2_ATOM_FILE_ERR_IO;
+	}
+
+	free(writer->buf);
+	free(writer->urids);
+	free(writer->slots);
+	writer->buf   = NULL;
+	writer->urids = NULL;
+	writer->slots = NULL;
+	return writer->status;
+}
+
+/**
+   Write atoms to an atom file.
+
+   @param stream Stream to write to, opened in binary mode.
+   @param types Types with URIDs, from lv2_atom_file_types_init().
+   @param unmap URID unmapper for the URI table.
+   @param atoms Atoms to write.
+   @param n_atoms Number of elements in `atoms`.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_file_write(FILE*                      stream,
+                    const LV2_Atom_File_Types* types,
+                    LV2_URID_Unmap*            unmap,
+                    const LV2_Atom* const*     atoms,
+                    uint32_t                   n_atoms)
+{
+	LV2_Atom_File_Writer writer;
+	lv2_atom_file_writer_open(&writer, stream, types, unmap);
+	for (uint32_t i = 0; i < n_atoms; ++i) {
+		lv2_atom_file_writer_append(&writer, atoms[i]);
+	}
+
+	return lv2_atom_file_writer_close(&writer);
+}
+
+/**
+   Load an atom file from memory, translating URIDs in place.
+
+   On success, `file` refers to `data`, which must be 64-bit aligned and stay
+   valid while the file is used.  The file is validated, so its atoms can be
+   read with the iterators in util.h without further checks.  This does not
+   take ownership of `data`, which must be freed by the caller.
+
+   @param file The file to initialise.
+   @param data Contents of the file, which are modified.
+   @param size Size of `data` in bytes.
+   @param map URID mapper for the URI table.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_file_load(LV2_Atom_File* file,
+                   void*          data,
+                   size_t         size,
+                   LV2_URID_Map*  map)
+{
+	const LV2_Atom_File_Header* const header =
+		(const LV2_Atom_File_Header*)data;
+
+	memset(file, 0, sizeof(LV2_Atom_File));
+	if ((uintptr_t)data % 8 || size < sizeof(LV2_Atom_File_Header) ||
+	    memcmp(header->magic, LV2_ATOM_FILE_MAGIC, sizeof(header->magic))) {
+		return LV2_ATOM_FILE_ERR_FORMAT;
+	} else if (header->version != LV2_ATOM_FILE_VERSION ||
+	           header->byte_order != LV2_ATOM_FILE_BYTE_ORDER) {
+		return LV2_ATOM_FILE_ERR_VERSION;
+	}
+
+	/* The checksum does not cover the header, so check that it fits the
+	   file, and that every URI table entry, which is at least 8 bytes once
+	   padded, fits the table before allocating for it. */
+	const size_t space = size - sizeof(LV2_Atom_File_Header);
+	if (header->uris_size % 8 || header->body_size % 8 ||
+	    header->body_size > UINT32_MAX || header->uris_size > space ||
+	    header->body_size != space - header->uris_size ||
+	    header->n_uris > header->uris_size / 8) {
+		return LV2_ATOM_FILE_ERR_FORMAT;
+	}
+
+	uint8_t* const body    = (uint8_t*)data + sizeof(LV2_Atom_File_Header);
+	uint8_t* const entries = body + header->body_size;
+	const uint64_t checksum = lv2_atom_hash_finish(lv2_atom_hash_update(
+		lv2_atom_hash_update(LV2_ATOM_HASH_SEED, body, header->body_size),
+		entries,
+		header->uris_size));
+	if (checksum != header->checksum) {
+		return LV2_ATOM_FILE_ERR_CORRUPT;
+	}
+
+	// Map every URI, the first element of the table is its size
+	LV2_URID* const table = (LV2_URID*)malloc(
+		((size_t)header->n_uris + 1U) * sizeof(LV2_URID));
+	if (!table) {
+		return LV2_ATOM_FILE_ERR_NO_MEM;
+	}
+
+	table[0]                 = header->n_uris;
+	const uint8_t*       p   = entries;
+	const uint8_t* const end = entries + header->uris_size;
+	for (uint32_t i = 0; i < header->n_uris; ++i) {
+		uint32_t len = 0;
+		if ((size_t)(end - p) >= sizeof(len)) {
+			memcpy(&len, p, sizeof(len));
+		}
+
+		if ((size_t)(end - p) <= sizeof(len) ||
+		    len >= (size_t)(end - p) - sizeof(len) ||
+		    p[sizeof(len) + len] != '\0') {
+			free(table);
+			return LV2_ATOM_FILE_ERR_FORMAT;
+		}
+
+		const char* const uri = (const char*)p + sizeof(len);
+		if (!(table[i + 1] = map->map(map->handle, uri))) {
+			free(table);
+			return LV2_ATOM_FILE_ERR_URI;
+		}
+
+		p += lv2_atom_pad_size((uint32_t)sizeof(len) + len + 1);
+	}
+
+	// Translate atoms to host URIDs, then check them
+	LV2_Atom_File_Types types;
+	lv2_atom_file_types_init(&types, map);
+
+	const LV2_Atom_File_Remap remap = {
+		&types, lv2_atom_file_load_urid, table, true };
+	const bool remapped =
+		lv2_atom_file_remap_body(&remap, body, header->body_size);
+	free(table);
+	if (!remapped) {
+		return LV2_ATOM_FILE_ERR_ATOM;
+	}
+
+	LV2_Atom_Validator validator;
+	lv2_atom_validator_init(&validator, map);
+
+	uint32_t n_atoms = 0;
+	LV2_ATOM_TUPLE_BODY_FOREACH(body, (uint32_t)header->body_size, atom) {
+		const size_t offset = (size_t)((uint8_t*)atom - body);
+		if (!lv2_atom_validate(
+			    &validator, atom, header->body_size - offset)) {
+			return LV2_ATOM_FILE_ERR_ATOM;
+		}
+		++n_atoms;
+	}
+
+	if (n_atoms != header->n_atoms) {
+		return LV2_ATOM_FILE_ERR_FORMAT;
+	}
+
+	file->data      = data;
+	file->size      = size;
+	file->body      = (LV2_Atom*)body;
+	file->body_size = (uint32_t)header->body_size;
+	file->n_atoms   = n_atoms;
+	return LV2_ATOM_FILE_SUCCESS;
+}
+
+/**
+   Open an atom file, mapping it into memory.
+
+   The file is mapped privately, so translating URIDs does not modify it.
+   Where mmap() is not available, the file is read into memory instead.  The
+   file must be closed with lv2_atom_file_close().
+
+   @param file The file to initialise.
+   @param path Path of the file to open.
+   @param map URID mapper for the URI table.
+*/
+static inline LV2_Atom_File_Status
+lv2_atom_file_open(LV2_Atom_File* file, const char* path, LV2_URID_Map* map)
+{
+	void*  data = NULL;
+	size_t size = 0;
+
+	memset(file, 0, sizeof(LV2_Atom_File));
+
+#ifndef _WIN32
+	const int fd = open(path, O_RDONLY);
+	struct stat st;
+	if (fd < 0) {
+		return LV2_ATOM_FILE_ERR_IO;
+	} else if (fstat(fd, &st) || st.st_size < 0) {
+		close(fd);
+		return LV2_ATOM_FILE_ERR_IO;
+	}
+
+	size = (size_t)st.st_size;
+	data = size ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+	            : MAP_FAILED;
+	close(fd);
+	if (data == MAP_FAILED) {
+		return size ? LV2_ATOM_FILE_ERR_IO : LV2_ATOM_FILE_ERR_FORMAT;
+	}
+#else
+	FILE* const stream = fopen(path, "rb");
+	if (!stream) {
+		return LV2_ATOM_FILE_ERR_IO;
+	}
+
+	long end = -1;
+	if (!fseek(stream, 0, SEEK_END) && (end = ftell(stream)) >= 0) {
+		size = (size_t)end;
+		data = malloc(size ? size : 1);  // Aligned for any type
+		rewind(stream);
+	}
+
+	if (!data || fread(data, 1, size, stream) != size) {
+		free(data);
+		fclose(stream);
+		return end < 0 ? LV2_ATOM_FILE_ERR_IO : LV2_ATOM_FILE_ERR_NO_MEM;
+	}
+	fclose(stream);
+#endif
+
+	const LV2_Atom_File_Status status =
+		lv2_atom_file_load(file, data, size, map);
+	if (status) {
+#ifndef _WIN32
+		munmap(data, size);
+#else
+		free(data);
+#endif
+		return status;
+	}
+
+	file->owned = true;
+	return LV2_ATOM_FILE_SUCCESS;
+}
+
+/** Close a file opened with lv2_atom_file_open(). */
+static inline void
+lv2_atom_file_close(LV2_Atom_File* file)
+{
+	if (file->owned) {
+#ifndef _WIN32
+		munmap(file->data, file->size);
+#else
+		free(file->data);
+#endif
+	}
+
+	memset(file, 0, sizeof(LV2_Atom_File));
+}
+
+/**
+   A macro for iterating over all atoms in a file.
+
+   @param file The file to iterate over.
+   @param iter The name of the iterator.
+
+   This macro is used similarly to a for loop (which it expands to), for
+   example:
+
+   @code
+   LV2_ATOM_FILE_FOREACH(&file, atom) {
+       // Do something with atom here...
+   }
+   @endcode
+*/
+#define LV2_ATOM_FILE_FOREACH(file, iter) \
+	LV2_ATOM_TUPLE_BODY_FOREACH((file)->body, (file)->body_size, iter)
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif /* LV2_ATOM_FILE_H */
@@ -0,0 +1,488 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmarks for the forge and the atom utilities.
+
+   Covers writing every primitive type with the forge, writing nested
+   objects, looking up properties with lv2_atom_object_query() and
+   lv2_atom_object_get() in objects of several sizes, iterating over and
+   appending to sequences, and walking tuples and vectors.
+
+   Every case is run several times, and the median is reported, so results
+   are comparable between runs.  Results are printed as tab-separated lines
+   of name, size, and ns per item, where an item is an atom, object, lookup,
+   event, or element.  The size is the number of items, or the number of
+   properties in the object for lookups.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_ITEMS   4096
+#define N_LOOKUPS 4096
+#define N_RUNS    9
+#define CAPACITY  (N_ITEMS * 64)
+#define MAX_PROPS 64
+
+static const char* const uris[] = {
+	LV2_ATOM__Blank,    LV2_ATOM__Bool,     LV2_ATOM__Chunk,
+	LV2_ATOM__Double,   LV2_ATOM__Float,    LV2_ATOM__Int,
+	LV2_ATOM__Literal,  LV2_ATOM__Long,     LV2_ATOM__Object,
+	LV2_ATOM__Path,     LV2_ATOM__Property, LV2_ATOM__Resource,
+	LV2_ATOM__Sequence, LV2_ATOM__String,   LV2_ATOM__Tuple,
+	LV2_ATOM__URI,      LV2_ATOM__URID,     LV2_ATOM__Vector,
+	LV2_ATOM__Event,    LV2_ATOM__beatTime, LV2_ATOM__frameTime,
+	"http://example.org/Thing" };
+
+#define N_URIS (sizeof(uris) / sizeof(uris[0]))
+#define THING  ((LV2_URID)N_URIS)
+#define KEY(i) ((LV2_URID)(100 + (i)))
+
+typedef struct {
+	LV2_Atom_Forge     forge;
+	uint8_t*           buf;
+	LV2_Atom_Sequence* seq;
+	const LV2_Atom*    tuple;
+	const LV2_Atom*    vector;
+	const LV2_Atom*    objects[3];
+	uint32_t           n_props;
+} Context;
+
+typedef uint64_t (*BenchFunc)(Context* ctx);
+
+static LV2_URID
+urid_map(LV2_URID_Map_Handle handle, const char* uri)
+{
+	(void)handle;
+	for (uint32_t i = 0; i < N_URIS; ++i) {
+		if (!strcmp(uri, uris[i])) {
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int
+compare_doubles(const void* a, const void* b)
+{
+	const double da = *(const double*)a;
+	const double db = *(const double*)b;
+	return (da > db) - (da < db);
+}
+
+static uint64_t
+forge_int(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (int32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_int(&ctx->forge, i);
+	}
+	return ctx->forge.offset;
+}
+
+static uint64_t
+forge_long(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (int64_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_long(&ctx->forge, i);
+	}
+	return ctx->forge.offset;
+}
+
+static uint64_t
+forge_float(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (int32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_float(&ctx->forge, (float)i);
+	}
+	return ctx->forge.offset;
+}
+
+static uint64_t
+forge_double(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (int32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_double(&ctx->forge, (double)i);
+	}
+	return ctx->forge.offset;
+}
+
+static uint64_t
+forge_bool(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (int32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_bool(&ctx->forge, i & 1);
+	}
+	return ctx->forge.offset;
+}
+
+static uint64_t
+forge_urid(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (uint32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_urid(&ctx->forge, KEY(i));
+	}
+	return ctx->forge.offset;
+}
+
+static uint64_t
+forge_string(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (uint32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_string(&ctx->forge, "sixteen letters!", 16);
+	}
+	return ctx->forge.offset;
+}
+
+static uint64_t
+forge_literal(Context* ctx)
+{
+	lv2_atom_forge_set_buffer(&ctx->forge, ctx->buf, CAPACITY);
+	for (uint32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_literal(&ctx->forge, "sixteen letters!", 16, 0, 1);
+	}
+	return ctx->forge.offset;
+}
+
+/** Write objects with 4 properties, one of which is an object. */
+static uint64_t
+forge_object_nested(Context* ctx)
+{
+	LV2_Atom_Forge* const forge = &ctx->forge;
+	lv2_atom_forge_set_buffer(forge, ctx->buf, CAPACITY);
+	for (uint32_t i = 0; i < N_ITEMS / 8; ++i) {
+		LV2_Atom_Forge_Frame frame;
+		LV2_Atom_Forge_Frame child;
+		lv2_atom_forge_object(forge, &frame, 0, THING);
+		lv2_atom_forge_key(forge, KEY(0));
+		lv2_atom_forge_int(forge, (int32_t)i);
+		lv2_atom_forge_key(forge, KEY(1));
+		lv2_atom_forge_float(forge, (float)i);
+		lv2_atom_forge_key(forge, KEY(2));
+		lv2_atom_forge_urid(forge, THING);
+		lv2_atom_forge_key(forge, KEY(3));
+		lv2_atom_forge_object(forge, &child, 0, THING);
+		for (uint32_t k = 0; k < 4; ++k) {
+			lv2_atom_forge_key(forge, KEY(k));
+			lv2_atom_forge_int(forge, (int32_t)k);
+		}
+		lv2_atom_forge_pop(forge, &child);
+		lv2_atom_forge_pop(forge, &frame);
+	}
+	return ctx->forge.offset;
+}
+
+/** Return the object with `ctx->n_props` properties. */
+static const LV2_Atom_Object*
+lookup_object(const Context* ctx)
+{
+	return (const LV2_Atom_Object*)
+		ctx->objects[ctx->n_props == 4 ? 0 : ctx->n_props == 16 ? 1 : 2];
+}
+
+/** Look up the first, last, and two middle properties of an object. */
+static uint64_t
+object_query(Context* ctx)
+{
+	const LV2_Atom_Object* const obj = lookup_object(ctx);
+	const uint32_t               n   = ctx->n_props;
+
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < N_LOOKUPS; ++i) {
+		const LV2_Atom* a = NULL;
+		const LV2_Atom* b = NULL;
+		const LV2_Atom* c = NULL;
+		const LV2_Atom* d = NULL;
+
+		LV2_Atom_Object_Query q[] = { { KEY(0), &a },
+		                              { KEY(n / 3), &b },
+		                              { KEY(2 * n / 3), &c },
+		                              { KEY(n - 1), &d },
+		                              LV2_ATOM_OBJECT_QUERY_END };
+		lv2_atom_object_query(obj, q);
+		sum += (uint64_t)(((const LV2_Atom_Int*)a)->body +
+		                  ((const LV2_Atom_Int*)b)->body +
+		                  ((const LV2_Atom_Int*)c)->body +
+		                  ((const LV2_Atom_Int*)d)->body);
+	}
+	return sum;
+}
+
+static uint64_t
+object_get(Context* ctx)
+{
+	const LV2_Atom_Object* const obj = lookup_object(ctx);
+	const uint32_t               n   = ctx->n_props;
+
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < N_LOOKUPS; ++i) {
+		const LV2_Atom* a = NULL;
+		const LV2_Atom* b = NULL;
+		const LV2_Atom* c = NULL;
+		const LV2_Atom* d = NULL;
+
+		lv2_atom_object_get(obj,
+		                    KEY(0), &a,
+		                    KEY(n / 3), &b,
+		                    KEY(2 * n / 3), &c,
+		                    KEY(n - 1), &d,
+		                    0);
+		sum += (uint64_t)(((const LV2_Atom_Int*)a)->body +
+		                  ((const LV2_Atom_Int*)b)->body +
+		                  ((const LV2_Atom_Int*)c)->body +
+		                  ((const LV2_Atom_Int*)d)->body);
+	}
+	return sum;
+}
+
+static uint64_t
+sequence_iterate(Context* ctx)
+{
+	uint64_t sum = 0;
+	LV2_ATOM_SEQUENCE_FOREACH(ctx->seq, ev) {
+		sum += (uint64_t)ev->time.frames +
+		       (uint64_t)((const LV2_Atom_Int*)&ev->body)->body;
+	}
+	return sum;
+}
+
+static uint64_t
+sequence_append_event(Context* ctx)
+{
+	LV2_Atom_Sequence* const seq = (LV2_Atom_Sequence*)ctx->buf;
+	seq->atom.type               = ctx->forge.Sequence;
+	lv2_atom_sequence_clear(seq);
+
+	struct {
+		LV2_Atom_Event event;
+		int32_t        value;
+	} ev = { { { 0 }, { sizeof(int32_t), ctx->forge.Int } }, 0 };
+
+	for (uint32_t i = 0; i < N_ITEMS; ++i) {
+		ev.event.time.frames = i;
+		ev.value             = (int32_t)i;
+		lv2_atom_sequence_append_event(seq, CAPACITY, &ev.event);
+	}
+	return seq->atom.size;
+}
+
+static uint64_t
+tuple_walk(Context* ctx)
+{
+	uint64_t sum = 0;
+	LV2_ATOM_TUPLE_FOREACH((const LV2_Atom_Tuple*)ctx->tuple, elem) {
+		sum += (uint64_t)((const LV2_Atom_Int*)elem)->body;
+	}
+	return sum;
+}
+
+/** Walk a vector generically, by child size. */
+static uint64_t
+vector_walk(Context* ctx)
+{
+	const LV2_Atom_Vector* const vec  = (const LV2_Atom_Vector*)ctx->vector;
+	const uint8_t*               elem = (const uint8_t*)(vec + 1);
+	const uint8_t* const         end  =
+		(const uint8_t*)LV2_ATOM_BODY_CONST(&vec->atom) + vec->atom.size;
+
+	uint64_t sum = 0;
+	for (; elem < end; elem += vec->body.child_size) {
+		sum += (uint64_t)*(const int32_t*)elem;
+	}
+	return sum;
+}
+
+/** Run `func` several times, and return the median time in ns per item. */
+static double
+measure(BenchFunc func, Context* ctx, uint32_t n_items, uint64_t* check)
+{
+	double times[N_RUNS];
+	for (unsigned r = 0; r < N_RUNS; ++r) {
+		const double   start  = now();
+		const uint64_t result = func(ctx);
+		times[r]              = now() - start;
+
+		if (r > 0 && result != *check) {
+			return -1.0;
+		}
+		*check = result;
+	}
+
+	qsort(times, N_RUNS, sizeof(double), compare_doubles);
+	return times[N_RUNS / 2] / n_items;
+}
+
+/** Write the atoms that are read by the benchmarks. */
+static bool
+make_atoms(Context* ctx, uint8_t* buf)
+{
+	static const uint32_t sizes[] = { 4, 16, MAX_PROPS };
+
+	LV2_Atom_Forge* const forge = &ctx->forge;
+	lv2_atom_forge_set_buffer(forge, buf, CAPACITY * 2);
+
+	LV2_Atom_Forge_Frame frame;
+	ctx->seq = (LV2_Atom_Sequence*)lv2_atom_forge_deref(
+		forge, lv2_atom_forge_sequence_head(forge, &frame, 0));
+	for (uint32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_frame_time(forge, i);
+		lv2_atom_forge_int(forge, (int32_t)i);
+	}
+	lv2_atom_forge_pop(forge, &frame);
+
+	ctx->tuple = (const LV2_Atom*)lv2_atom_forge_deref(
+		forge, lv2_atom_forge_tuple(forge, &frame));
+	for (uint32_t i = 0; i < N_ITEMS; ++i) {
+		lv2_atom_forge_int(forge, (int32_t)i);
+	}
+	lv2_atom_forge_pop(forge, &frame);
+
+	int32_t* const elems = (int32_t*)ctx->buf;
+	for (uint32_t i = 0; i < N_ITEMS; ++i) {
+		elems[i] = (int32_t)i;
+	}
+	ctx->vector = (const LV2_Atom*)lv2_atom_forge_deref(
+		forge,
+		lv2_atom_forge_vector(
+			forge, sizeof(int32_t), forge->Int, N_ITEMS, elems));
+
+	for (unsigned o = 0; o < 3; ++o) {
+		ctx->objects[o] = (const LV2_Atom*)lv2_atom_forge_deref(
+			forge, lv2_atom_forge_object(forge, &frame, 0, THING));
+		for (uint32_t k = 0; k < sizes[o]; ++k) {
+			lv2_atom_forge_key(forge, KEY(k));
+			lv2_atom_forge_int(forge, (int32_t)k);
+		}
+		lv2_atom_forge_pop(forge, &frame);
+	}
+
+	return ctx->objects[2] != NULL;
+}
+
+int
+main(void)
+{
+	static const struct {
+		const char* name;
+		BenchFunc   func;
+		uint32_t    n_items;
+	} cases[] = {
+		{ "forge_int", forge_int, N_ITEMS },
+		{ "forge_long", forge_long, N_ITEMS },
+		{ "forge_float", forge_float, N_ITEMS },
+		{ "forge_double", forge_double, N_ITEMS },
+		{ "forge_bool", forge_bool, N_ITEMS },
+		{ "forge_urid", forge_urid, N_ITEMS },
+		{ "forge_string", forge_string, N_ITEMS },
+		{ "forge_literal", forge_literal, N_ITEMS },
+		{ "forge_object_nested", forge_object_nested, N_ITEMS / 8 },
+		{ "sequence_iterate", sequence_iterate, N_ITEMS },
+		{ "sequence_append_event", sequence_append_event, N_ITEMS },
+		{ "tuple_walk", tuple_walk, N_ITEMS },
+		{ "vector_walk", vector_walk, N_ITEMS },
+	};
+
+	static const struct {
+		const char* name;
+		BenchFunc   func;
+	} lookups[] = { { "object_query", object_query },
+	                { "object_get", object_get } };
+
+	static const uint32_t n_props[] = { 4, 16, MAX_PROPS };
+
+	LV2_URID_Map map = { NULL, urid_map };
+	Context      ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	lv2_atom_forge_init(&ctx.forge, &map);
+
+	uint8_t* const atoms = (uint8_t*)calloc(2, CAPACITY);
+	if (!(ctx.buf = (uint8_t*)calloc(1, CAPACITY)) || !atoms ||
+	    !make_atoms(&ctx, atoms)) {
+		fprintf(stderr, "error: Failed to make atoms\n");
+		return 1;
+	}
+
+	// Sum of 0..N_ITEMS-1, the expected result of every walk
+	const uint64_t walk_sum = (uint64_t)N_ITEMS * (N_ITEMS - 1) / 2;
+
+	int ret = 0;
+	for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+		uint64_t     check = 0;
+		const double ns    =
+			measure(cases[i].func, &ctx, cases[i].n_items, &check);
+		if (ns < 0.0 ||
+		    (cases[i].func == sequence_iterate && check != 2 * walk_sum) ||
+		    ((cases[i].func == tuple_walk || cases[i].func == vector_walk) &&
+		     check != walk_sum)) {
+			fprintf(stderr, "error: %s result is incorrect\n", cases[i].name);
+			ret = 1;
+			continue;
+		}
+
+		printf("%s\t%u\t%.2f\n", cases[i].name, cases[i].n_items, ns);
+	}
+
+	for (unsigned l = 0; l < sizeof(lookups) / sizeof(lookups[0]); ++l) {
+		for (unsigned p = 0; p < sizeof(n_props) / sizeof(n_props[0]); ++p) {
+			const uint32_t n = n_props[p];
+
+			uint64_t check = 0;
+			ctx.n_props    = n;
+			const double ns =
+				measure(lookups[l].func, &ctx, N_LOOKUPS, &check);
+			if (ns < 0.0 ||
+			    check != (uint64_t)N_LOOKUPS *
+			                 (0 + n / 3 + 2 * n / 3 + (n - 1))) {
+				fprintf(stderr, "error: %s result is incorrect\n",
+				        lookups[l].name);
+				ret = 1;
+				continue;
+			}
+
+			printf("%s\t%u\t%.2f\n", lookups[l].name, n, ns);
+		}
+	}
+
+	free(atoms);
+	free(ctx.buf);
+	return ret;
+}
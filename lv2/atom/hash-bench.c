@@ -0,0 +1,195 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark for hashing atoms and deduplicating them with a store.
+
+   Makes a stream of patch:Set messages, many of which are repeated, as a
+   host might receive from a UI.  Every message is hashed with lv2_atom_hash()
+   and lv2_atom_object_hash(), then deduplicated with an LV2_Atom_Store, and
+   by searching a list of unique messages with lv2_atom_equals().  Results are
+   printed as tab-separated lines of name, number of messages, and either
+   MB/s for hashing or ns per message for deduplication.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_MESSAGES 100000
+#define N_UNIQUE   1000
+#define N_SLOTS    2048
+#define N_REPEATS  10
+#define MSG_SIZE   96
+
+static const char* const uris[] = {
+	LV2_ATOM__Float, LV2_ATOM__Object, LV2_ATOM__URID };
+
+static LV2_URID
+urid_map(LV2_URID_Map_Handle handle, const char* uri)
+{
+	(void)handle;
+	for (uint32_t i = 0; i < sizeof(uris) / sizeof(uris[0]); ++i) {
+		if (!strcmp(uri, uris[i])) {
+			return 1 + i;
+		}
+	}
+
+	return 100;
+}
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/** Write a patch:Set of one of a few properties to one of many values. */
+static void
+make_message(LV2_Atom_Forge* forge, uint8_t* buf, uint32_t n)
+{
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_set_buffer(forge, buf, MSG_SIZE);
+	lv2_atom_forge_object(forge, &frame, 0, 1000);
+	lv2_atom_forge_key(forge, 1001);
+	lv2_atom_forge_urid(forge, 2000 + n % 8);
+	lv2_atom_forge_key(forge, 1002);
+	lv2_atom_forge_float(forge, (float)(n / 8));
+	lv2_atom_forge_pop(forge, &frame);
+}
+
+static const LV2_Atom*
+message(const uint8_t* messages, uint32_t i)
+{
+	return (const LV2_Atom*)(messages + (size_t)i * MSG_SIZE);
+}
+
+int
+main(void)
+{
+	LV2_URID_Map   map = { NULL, urid_map };
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, &map);
+
+	// Make messages, with values drawn at random from a smaller set
+	uint8_t* const messages = (uint8_t*)calloc(N_MESSAGES, MSG_SIZE);
+	uint32_t       rng      = 1;
+	size_t         n_bytes  = 0;
+	for (uint32_t i = 0; i < N_MESSAGES; ++i) {
+		rng = rng * 1664525u + 1013904223u;
+		make_message(&forge, messages + (size_t)i * MSG_SIZE,
+		             (rng >> 8) % N_UNIQUE);
+		n_bytes += lv2_atom_total_size(message(messages, i));
+	}
+
+	const double mb = (double)n_bytes * N_REPEATS / 1e6;
+
+	// Hash every message
+	uint64_t sum   = 0;
+	double   start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		for (uint32_t i = 0; i < N_MESSAGES; ++i) {
+			sum += lv2_atom_hash(message(messages, i));
+		}
+	}
+	const double hash_ns = now() - start;
+
+	start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		for (uint32_t i = 0; i < N_MESSAGES; ++i) {
+			sum += lv2_atom_object_hash(
+				(const LV2_Atom_Object*)message(messages, i));
+		}
+	}
+	const double object_hash_ns = now() - start;
+
+	// Deduplicate with a store
+	uint8_t* const             store_buf = (uint8_t*)calloc(N_UNIQUE, MSG_SIZE);
+	LV2_Atom_Store_Slot* const slots =
+		(LV2_Atom_Store_Slot*)calloc(N_SLOTS, sizeof(LV2_Atom_Store_Slot));
+	LV2_Atom_Store store;
+	lv2_atom_store_init(&store, store_buf, N_UNIQUE * MSG_SIZE, slots, N_SLOTS);
+
+	const LV2_Atom** const stored =
+		(const LV2_Atom**)calloc(N_MESSAGES, sizeof(const LV2_Atom*));
+	start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		lv2_atom_store_clear(&store);
+		for (uint32_t i = 0; i < N_MESSAGES; ++i) {
+			stored[i] = lv2_atom_store_insert(&store, message(messages, i));
+		}
+	}
+	const double store_ns = (now() - start) / N_REPEATS / N_MESSAGES;
+
+	// Deduplicate by searching a list of unique messages
+	const LV2_Atom** const unique =
+		(const LV2_Atom**)calloc(N_UNIQUE, sizeof(const LV2_Atom*));
+	uint32_t n_unique = 0;
+	start             = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		n_unique = 0;
+		for (uint32_t i = 0; i < N_MESSAGES; ++i) {
+			const LV2_Atom* const msg = message(messages, i);
+			uint32_t              u   = 0;
+			while (u < n_unique && !lv2_atom_equals(unique[u], msg)) {
+				++u;
+			}
+			if (u == n_unique) {
+				unique[n_unique++] = msg;
+			}
+		}
+	}
+	const double list_ns = (now() - start) / N_REPEATS / N_MESSAGES;
+
+	// Check that the store found the same unique messages
+	for (uint32_t i = 0; i < N_MESSAGES; ++i) {
+		if (!stored[i] || !lv2_atom_equals(stored[i], message(messages, i))) {
+			fprintf(stderr, "error: Message %u not stored\n", i);
+			return 1;
+		}
+	}
+
+	if (store.n_atoms != n_unique) {
+		fprintf(stderr,
+		        "error: Store has %u messages, not %u\n",
+		        store.n_atoms,
+		        n_unique);
+		return 1;
+	}
+
+	printf("hash\t%u\t%.1f\n", N_MESSAGES, mb / (hash_ns / 1e9));
+	printf("object_hash\t%u\t%.1f\n", N_MESSAGES, mb / (object_hash_ns / 1e9));
+	printf("store\t%u\t%.2f\n", N_MESSAGES, store_ns);
+	printf("list\t%u\t%.2f\n", N_MESSAGES, list_ns);
+
+	free(unique);
+	free(stored);
+	free(slots);
+	free(store_buf);
+	free(messages);
+	return sum == 0;
+}
@@ -0,0 +1,227 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark for merging sequences.
+
+   Merges 16 input sequences of short events into one, with a simple linear
+   scan of the inputs for every event, with lv2_atom_sequence_merge_next(),
+   and with lv2_atom_sequence_merge().  Inputs are either finely interleaved,
+   with random times, or clustered, where every input has runs of events at
+   once.  Results are printed as tab-separated lines of name, number of
+   inputs, and ns per event.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_INPUTS     16
+#define N_EVENTS     1024
+#define N_FRAMES     4096
+#define N_REPEATS    200
+#define EVENT_SIZE   24
+#define IN_CAPACITY  (sizeof(LV2_Atom_Sequence_Body) + N_EVENTS * EVENT_SIZE)
+#define OUT_CAPACITY (sizeof(LV2_Atom_Sequence_Body) + \
+                      N_INPUTS * N_EVENTS * EVENT_SIZE)
+
+typedef struct {
+	LV2_Atom_Event event;
+	uint8_t        msg[3];
+} MIDINoteEvent;
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static LV2_Atom_Sequence*
+new_sequence(size_t capacity)
+{
+	LV2_Atom_Sequence* seq = (LV2_Atom_Sequence*)calloc(
+		1, sizeof(LV2_Atom) + capacity);
+	lv2_atom_sequence_clear(seq);
+	return seq;
+}
+
+static int
+compare_times(const void* a, const void* b)
+{
+	const int64_t ta = *(const int64_t*)a;
+	const int64_t tb = *(const int64_t*)b;
+	return (ta > tb) - (ta < tb);
+}
+
+/** Fill every input with events at random or clustered times. */
+static void
+make_inputs(LV2_Atom_Sequence** inputs, uint32_t cluster)
+{
+	uint32_t rng = 1;
+	for (uint32_t i = 0; i < N_INPUTS; ++i) {
+		int64_t times[N_EVENTS];
+		for (uint32_t j = 0; j < N_EVENTS; j += cluster) {
+			rng = rng * 1664525u + 1013904223u;
+			for (uint32_t k = 0; k < cluster; ++k) {
+				times[j + k] = (rng >> 8) % N_FRAMES;
+			}
+		}
+		qsort(times, N_EVENTS, sizeof(int64_t), compare_times);
+
+		lv2_atom_sequence_clear(inputs[i]);
+		for (uint32_t j = 0; j < N_EVENTS; ++j) {
+			MIDINoteEvent ev;
+			memset(&ev, 0, sizeof(ev));
+			ev.event.time.frames = times[j];
+			ev.event.body.type   = 1;
+			ev.event.body.size   = 3;
+			ev.msg[0]            = 0x90;
+			ev.msg[1]            = (uint8_t)i;
+			ev.msg[2]            = (uint8_t)(j & 0x7F);
+			lv2_atom_sequence_append_event(inputs[i], IN_CAPACITY, &ev.event);
+		}
+	}
+}
+
+/** Merge by scanning every input for the earliest event each time. */
+static void
+merge_linear(LV2_Atom_Sequence*              out,
+             const LV2_Atom_Sequence* const* inputs)
+{
+	const LV2_Atom_Event* iters[N_INPUTS];
+	for (uint32_t i = 0; i < N_INPUTS; ++i) {
+		iters[i] = lv2_atom_sequence_begin(&inputs[i]->body);
+	}
+
+	for (;;) {
+		const LV2_Atom_Event* first = NULL;
+		uint32_t              index = 0;
+		for (uint32_t i = 0; i < N_INPUTS; ++i) {
+			const LV2_Atom_Sequence* in = inputs[i];
+			if (!lv2_atom_sequence_is_end(&in->body, in->atom.size, iters[i]) &&
+			    (!first || iters[i]->time.frames < first->time.frames)) {
+				first = iters[i];
+				index = i;
+			}
+		}
+
+		if (!first) {
+			break;
+		}
+
+		lv2_atom_sequence_append_event(out, OUT_CAPACITY, first);
+		iters[index] = lv2_atom_sequence_next(first);
+	}
+}
+
+static void
+merge_iterator(LV2_Atom_Sequence*              out,
+               const LV2_Atom_Sequence* const* inputs)
+{
+	LV2_Atom_Sequence_Merge merge;
+	lv2_atom_sequence_merge_init(&merge, inputs, N_INPUTS);
+
+	const LV2_Atom_Event* ev = NULL;
+	while ((ev = lv2_atom_sequence_merge_next(&merge, NULL))) {
+		lv2_atom_sequence_append_event(out, OUT_CAPACITY, ev);
+	}
+}
+
+static void
+merge_buffer(LV2_Atom_Sequence*              out,
+             const LV2_Atom_Sequence* const* inputs)
+{
+	lv2_atom_sequence_merge(out, OUT_CAPACITY, inputs, N_INPUTS);
+}
+
+static double
+bench(void (*func)(LV2_Atom_Sequence*, const LV2_Atom_Sequence* const*),
+      LV2_Atom_Sequence*              out,
+      const LV2_Atom_Sequence* const* inputs)
+{
+	const double start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		lv2_atom_sequence_clear(out);
+		func(out, inputs);
+	}
+
+	return (now() - start) / N_REPEATS / (N_INPUTS * N_EVENTS);
+}
+
+int
+main(void)
+{
+	LV2_Atom_Sequence* inputs[N_INPUTS];
+	for (uint32_t i = 0; i < N_INPUTS; ++i) {
+		inputs[i] = new_sequence(IN_CAPACITY);
+	}
+
+	LV2_Atom_Sequence* out      = new_sequence(OUT_CAPACITY);
+	LV2_Atom_Sequence* expected = new_sequence(OUT_CAPACITY);
+
+	static const struct {
+		const char* name;
+		uint32_t    cluster;
+	} layouts[] = { { "interleaved", 1 }, { "clustered", 32 } };
+
+	static const struct {
+		const char* name;
+		void (*func)(LV2_Atom_Sequence*, const LV2_Atom_Sequence* const*);
+	} funcs[] = { { "linear", merge_linear },
+	              { "merge_next", merge_iterator },
+	              { "merge", merge_buffer } };
+
+	for (unsigned l = 0; l < sizeof(layouts) / sizeof(layouts[0]); ++l) {
+		make_inputs(inputs, layouts[l].cluster);
+
+		const LV2_Atom_Sequence* const* in =
+			(const LV2_Atom_Sequence* const*)inputs;
+
+		lv2_atom_sequence_clear(expected);
+		merge_linear(expected, in);
+
+		for (unsigned f = 0; f < sizeof(funcs) / sizeof(funcs[0]); ++f) {
+			const double ns = bench(funcs[f].func, out, in);
+			if (out->atom.size != expected->atom.size ||
+			    memcmp(out + 1,
+			           expected + 1,
+			           out->atom.size - sizeof(LV2_Atom_Sequence_Body))) {
+				fprintf(stderr, "error: %s output differs\n", funcs[f].name);
+				return 1;
+			}
+
+			printf("%s_%s\t%u\t%.2f\n",
+			       funcs[f].name, layouts[l].name, N_INPUTS, ns);
+		}
+	}
+
+	free(expected);
+	free(out);
+	for (uint32_t i = 0; i < N_INPUTS; ++i) {
+		free(inputs[i]);
+	}
+
+	return 0;
+}
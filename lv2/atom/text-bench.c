@@ -0,0 +1,221 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark for writing atoms as text.
+
+   Writes a recorded control stream, a sequence of small objects and MIDI
+   events for every cycle, as Turtle and JSON.  Text is written to a buffer
+   that is reset for every cycle, as when logging, and through a buffer to a
+   stream that discards it, as when dumping a capture.  Results are printed
+   as tab-separated lines of name, bytes of text per pass, and MB/s of text.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/text.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_CYCLES       4096
+#define N_EVENTS       16
+#define N_REPEATS      20
+#define CYCLE_CAPACITY 4096
+#define TEXT_CAPACITY  65536
+
+static const char* const uris[] = {
+	LV2_ATOM__Blank,    LV2_ATOM__Bool,     LV2_ATOM__Chunk,
+	LV2_ATOM__Double,   LV2_ATOM__Float,    LV2_ATOM__Int,
+	LV2_ATOM__Literal,  LV2_ATOM__Long,     LV2_ATOM__Object,
+	LV2_ATOM__Path,     LV2_ATOM__Property, LV2_ATOM__Resource,
+	LV2_ATOM__Sequence, LV2_ATOM__String,   LV2_ATOM__Tuple,
+	LV2_ATOM__URI,      LV2_ATOM__URID,     LV2_ATOM__Vector,
+	LV2_ATOM__Event,    LV2_ATOM__beatTime, LV2_ATOM__frameTime,
+	"http://lv2plug.in/ns/ext/patch#Set",
+	"http://lv2plug.in/ns/ext/patch#property",
+	"http://lv2plug.in/ns/ext/patch#value",
+	"http://lv2plug.in/ns/ext/midi#MidiEvent",
+	"http://lv2plug.in/plugins/eg-params#int",
+	"http://lv2plug.in/plugins/eg-params#float" };
+
+#define N_URIS (sizeof(uris) / sizeof(uris[0]))
+
+static LV2_URID
+urid_map(LV2_URID_Map_Handle handle, const char* uri)
+{
+	(void)handle;
+	for (uint32_t i = 0; i < N_URIS; ++i) {
+		if (!strcmp(uri, uris[i])) {
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
+
+static const char*
+urid_unmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+	(void)handle;
+	return (urid > 0 && urid <= N_URIS) ? uris[urid - 1] : NULL;
+}
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/** Write the input for every cycle, with parameter changes and notes. */
+static void
+make_cycles(LV2_URID_Map* map, uint8_t* buf, const LV2_Atom** cycles)
+{
+	const LV2_URID patch_Set      = urid_map(NULL, uris[21]);
+	const LV2_URID patch_property = urid_map(NULL, uris[22]);
+	const LV2_URID patch_value    = urid_map(NULL, uris[23]);
+	const LV2_URID midi_Event     = urid_map(NULL, uris[24]);
+	const LV2_URID eg_int         = urid_map(NULL, uris[25]);
+	const LV2_URID eg_float       = urid_map(NULL, uris[26]);
+
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, map);
+	for (uint32_t c = 0; c < N_CYCLES; ++c) {
+		uint8_t* const cycle_buf = buf + (size_t)c * CYCLE_CAPACITY;
+		lv2_atom_forge_set_buffer(&forge, cycle_buf, CYCLE_CAPACITY);
+
+		LV2_Atom_Forge_Frame seq_frame;
+		lv2_atom_forge_sequence_head(&forge, &seq_frame, 0);
+		for (uint32_t i = 0; i < N_EVENTS; ++i) {
+			lv2_atom_forge_frame_time(&forge, i * 16);
+			if (i % 4 == 0) {
+				const uint8_t msg[3] = { 0x90, (uint8_t)(48 + i), 100 };
+				lv2_atom_forge_atom(&forge, sizeof(msg), midi_Event);
+				lv2_atom_forge_write(&forge, msg, sizeof(msg));
+				continue;
+			}
+
+			LV2_Atom_Forge_Frame frame;
+			lv2_atom_forge_object(&forge, &frame, 0, patch_Set);
+			lv2_atom_forge_key(&forge, patch_property);
+			lv2_atom_forge_urid(&forge, i % 2 ? eg_int : eg_float);
+			lv2_atom_forge_key(&forge, patch_value);
+			if (i % 2) {
+				lv2_atom_forge_int(&forge, (int32_t)(c * 7 + i));
+			} else {
+				lv2_atom_forge_float(&forge, (float)c / (float)(i + 1));
+			}
+			lv2_atom_forge_pop(&forge, &frame);
+		}
+		lv2_atom_forge_pop(&forge, &seq_frame);
+
+		cycles[c] = (const LV2_Atom*)cycle_buf;
+	}
+}
+
+/** Write every cycle, and return the time taken in ns. */
+static double
+bench(LV2_Atom_Text_Writer* writer, const LV2_Atom** cycles, size_t* len)
+{
+	bool ok = true;
+
+	const double start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		*len = 0;
+		lv2_atom_text_reset(writer);
+		for (uint32_t c = 0; c < N_CYCLES; ++c) {
+			if (!writer->stream) {
+				*len += writer->total;
+				lv2_atom_text_reset(writer);
+			}
+			ok = lv2_atom_text_write(writer, cycles[c]) && ok;
+		}
+		ok = lv2_atom_text_finish(writer) && ok;
+		*len += writer->total;
+	}
+
+	const double ns = now() - start;
+	return ok ? ns : -1.0;
+}
+
+int
+main(void)
+{
+	LV2_URID_Map   map   = { NULL, urid_map };
+	LV2_URID_Unmap unmap = { NULL, urid_unmap };
+
+	uint8_t* const         buf    = (uint8_t*)calloc(N_CYCLES, CYCLE_CAPACITY);
+	const LV2_Atom** const cycles =
+		(const LV2_Atom**)calloc(N_CYCLES, sizeof(LV2_Atom*));
+	char* const text   = (char*)malloc(TEXT_CAPACITY);
+	FILE* const stream = fopen("/dev/null", "wb");
+	if (!buf || !cycles || !text || !stream) {
+		fprintf(stderr, "error: Failed to allocate buffers\n");
+		return 1;
+	}
+
+	make_cycles(&map, buf, cycles);
+
+	static const struct {
+		const char*          name;
+		LV2_Atom_Text_Format format;
+	} formats[] = { { "turtle", LV2_ATOM_TEXT_TURTLE },
+	                { "json", LV2_ATOM_TEXT_JSON } };
+
+	int ret = 0;
+	for (unsigned f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+		for (unsigned s = 0; s < 2; ++s) {
+			LV2_Atom_Text_Writer writer;
+			lv2_atom_text_writer_init(&writer,
+			                          formats[f].format,
+			                          &map,
+			                          &unmap,
+			                          s ? stream : NULL,
+			                          text,
+			                          TEXT_CAPACITY);
+
+			size_t       len = 0;
+			const double ns  = bench(&writer, (const LV2_Atom**)cycles, &len);
+			if (ns < 0.0) {
+				fprintf(stderr, "error: Failed to write %s\n", formats[f].name);
+				ret = 1;
+				continue;
+			}
+
+			const double mb = (double)len * N_REPEATS / (1024.0 * 1024.0);
+			printf("%s_%s\t%u\t%.1f\n",
+			       formats[f].name,
+			       s ? "stream" : "buffer",
+			       (unsigned)len,
+			       mb / (ns / 1e9));
+		}
+	}
+
+	fclose(stream);
+	free(text);
+	free(cycles);
+	free(buf);
+	return ret;
+}
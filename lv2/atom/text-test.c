@@ -0,0 +1,266 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/atom/atom-test-utils.c"
+#include "lv2/atom/atom.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/text.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* const turtle_object =
+	"[\n"
+	"\ta <urn:test:Thing> ;\n"
+	"\t<urn:test:int> -42 ;\n"
+	"\t<urn:test:long> \"9000000000\"^^xsd:long ;\n"
+	"\t<urn:test:float> \"0.5\"^^xsd:float ;\n"
+	"\t<urn:test:bool> true ;\n"
+	"\t<urn:test:string> \"say \\\"hi\\\"\\n\\u0001\" ;\n"
+	"\t<urn:test:urid> <urn:test:Thing> ;\n"
+	"\t<urn:test:uri> <urn:test:a\\u0020b> ;\n"
+	"\t<urn:test:literal> \"bonjour\"@fr ;\n"
+	"\t<urn:test:tuple> ( 1 false ) ;\n"
+	"\t<urn:test:vector> ( 1 2 3 ) ;\n"
+	"\t<urn:test:events> (\n"
+	"\t\t[ atom:frameTime 0 ; rdf:value [\n"
+	"\t\t\t@id <urn:test:id> ;\n"
+	"\t\t\ta <urn:test:Thing>\n"
+	"\t\t] ]\n"
+	"\t\t[ atom:frameTime 7 ; rdf:value "
+	"[ a <urn:test:Midi> ; rdf:value \"903C40\"^^xsd:hexBinary ] ]\n"
+	"\t) ;\n"
+	"\t<urn:test:nothing> ()\n"
+	"]\n";
+
+static const char* const json_object =
+	"{\"@type\":\"urn:test:Thing\","
+	"\"urn:test:int\":-42,"
+	"\"urn:test:long\":9000000000,"
+	"\"urn:test:float\":0.5,"
+	"\"urn:test:bool\":true,"
+	"\"urn:test:string\":\"say \\\"hi\\\"\\n\\u0001\","
+	"\"urn:test:urid\":{\"@id\":\"urn:test:Thing\"},"
+	"\"urn:test:uri\":{\"@id\":\"urn:test:a b\"},"
+	"\"urn:test:literal\":{\"@value\":\"bonjour\",\"@language\":\"fr\"},"
+	"\"urn:test:tuple\":[1,false],"
+	"\"urn:test:vector\":[1,2,3],"
+	"\"urn:test:events\":["
+	"{\"frameTime\":0,\"value\":{\"@id\":\"urn:test:id\","
+	"\"@type\":\"urn:test:Thing\"}},"
+	"{\"frameTime\":7,\"value\":{\"@type\":\"urn:test:Midi\","
+	"\"@value\":\"903C40\"}}],"
+	"\"urn:test:nothing\":null}\n";
+
+static const char*
+urid_unmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+	(void)handle;
+	return (urid > 0 && urid <= n_uris) ? uris[urid - 1] : NULL;
+}
+
+static LV2_URID
+key(const char* name)
+{
+	char uri[64];
+	snprintf(uri, sizeof(uri), "urn:test:%s", name);
+	return urid_map(NULL, uri);
+}
+
+/** Write an object with a property of every type written as text. */
+static const LV2_Atom*
+forge_object(LV2_Atom_Forge* forge, uint8_t* buf, uint32_t size)
+{
+	static const int32_t elems[] = { 1, 2, 3 };
+	static const uint8_t midi[]  = { 0x90, 0x3C, 0x40 };
+
+	const LV2_URID thing = key("Thing");
+	const LV2_URID lang  = urid_map(NULL, "http://lexvo.org/id/iso639-1/fr");
+
+	LV2_Atom_Forge_Frame frame;
+	LV2_Atom_Forge_Frame child;
+	LV2_Atom_Forge_Frame object;
+	lv2_atom_forge_set_buffer(forge, buf, size);
+	const LV2_Atom_Forge_Ref ref =
+		lv2_atom_forge_object(forge, &frame, 0, thing);
+
+	lv2_atom_forge_key(forge, key("int"));
+	lv2_atom_forge_int(forge, -42);
+	lv2_atom_forge_key(forge, key("long"));
+	lv2_atom_forge_long(forge, 9000000000);
+	lv2_atom_forge_key(forge, key("float"));
+	lv2_atom_forge_float(forge, 0.5f);
+	lv2_atom_forge_key(forge, key("bool"));
+	lv2_atom_forge_bool(forge, true);
+	lv2_atom_forge_key(forge, key("string"));
+	lv2_atom_forge_string(forge, "say \"hi\"\n\x01", 11);
+	lv2_atom_forge_key(forge, key("urid"));
+	lv2_atom_forge_urid(forge, thing);
+	lv2_atom_forge_key(forge, key("uri"));
+	lv2_atom_forge_uri(forge, "urn:test:a b", 12);
+	lv2_atom_forge_key(forge, key("literal"));
+	lv2_atom_forge_literal(forge, "bonjour", 7, 0, lang);
+
+	lv2_atom_forge_key(forge, key("tuple"));
+	lv2_atom_forge_tuple(forge, &child);
+	lv2_atom_forge_int(forge, 1);
+	lv2_atom_forge_bool(forge, false);
+	lv2_atom_forge_pop(forge, &child);
+
+	lv2_atom_forge_key(forge, key("vector"));
+	lv2_atom_forge_vector(forge, sizeof(int32_t), forge->Int, 3, elems);
+
+	lv2_atom_forge_key(forge, key("events"));
+	lv2_atom_forge_sequence_head(forge, &child, 0);
+	lv2_atom_forge_frame_time(forge, 0);
+	lv2_atom_forge_object(forge, &object, key("id"), thing);
+	lv2_atom_forge_pop(forge, &object);
+	lv2_atom_forge_frame_time(forge, 7);
+	lv2_atom_forge_atom(forge, sizeof(midi), key("Midi"));
+	lv2_atom_forge_write(forge, midi, sizeof(midi));
+	lv2_atom_forge_pop(forge, &child);
+
+	lv2_atom_forge_key(forge, key("nothing"));
+	lv2_atom_forge_atom(forge, 0, 0);
+
+	lv2_atom_forge_pop(forge, &frame);
+	return lv2_atom_forge_deref(forge, ref);
+}
+
+static int
+test_format(LV2_Atom_Text_Format format,
+            const LV2_Atom*      atom,
+            const char*          expected)
+{
+	LV2_URID_Map   map   = { NULL, urid_map };
+	LV2_URID_Unmap unmap = { NULL, urid_unmap };
+	const size_t   len   = strlen(expected);
+
+	// Write to a buffer large enough for everything
+	char                 buf[2048];
+	LV2_Atom_Text_Writer writer;
+	lv2_atom_text_writer_init(
+		&writer, format, &map, &unmap, NULL, buf, sizeof(buf));
+	if (!lv2_atom_text_write(&writer, atom) || !lv2_atom_text_finish(&writer)) {
+		return test_fail("Failed to write text\n");
+	} else if (strcmp(buf, expected) || writer.total != len) {
+		return test_fail("Incorrect text:\n%s\nExpected:\n%s\n", buf, expected);
+	}
+
+	// Write to a buffer that is too small, which truncates
+	char small[16];
+	lv2_atom_text_writer_init(
+		&writer, format, &map, &unmap, NULL, small, sizeof(small));
+	if (lv2_atom_text_write(&writer, atom) || lv2_atom_text_finish(&writer)) {
+		return test_fail("Truncated text not reported\n");
+	} else if (strncmp(small, expected, sizeof(small) - 1) ||
+	           small[sizeof(small) - 1] || writer.total != len) {
+		return test_fail("Incorrect truncated text '%s'\n", small);
+	}
+
+	// Write through a small buffer to a stream, twice
+	FILE* const stream = tmpfile();
+	if (!stream) {
+		return test_fail("Failed to open temporary file\n");
+	}
+
+	lv2_atom_text_writer_init(
+		&writer, format, &map, &unmap, stream, small, sizeof(small));
+	if (!lv2_atom_text_write(&writer, atom) ||
+	    !lv2_atom_text_write(&writer, atom) ||
+	    !lv2_atom_text_finish(&writer)) {
+		fclose(stream);
+		return test_fail("Failed to write text to stream\n");
+	}
+
+	const long size = ftell(stream);
+	rewind(stream);
+	memset(buf, 0, sizeof(buf));
+	const size_t n_read = fread(buf, 1, sizeof(buf) - 1, stream);
+	fclose(stream);
+	if (size != (long)(2 * len) || n_read != 2 * len ||
+	    strncmp(buf, expected, len) || strcmp(buf + len, expected)) {
+		return test_fail("Incorrect streamed text:\n%s\n", buf);
+	}
+
+	return 0;
+}
+
+static int
+test_reals(void)
+{
+	LV2_URID_Map   map   = { NULL, urid_map };
+	LV2_URID_Unmap unmap = { NULL, urid_unmap };
+	const LV2_URID Double = urid_map(NULL, LV2_ATOM__Double);
+
+	const struct {
+		LV2_Atom_Double atom;
+		const char*     turtle;
+		const char*     json;
+	} tests[] = {
+		{ { { sizeof(double), Double }, 0.1 },
+		  "\"0.10000000000000001\"^^xsd:double\n",
+		  "0.10000000000000001\n" },
+		{ { { sizeof(double), Double }, -INFINITY },
+		  "\"-INF\"^^xsd:double\n",
+		  "null\n" },
+	};
+
+	for (unsigned i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		for (unsigned f = 0; f < 2; ++f) {
+			const char* const expected = f ? tests[i].json : tests[i].turtle;
+
+			char                 buf[64];
+			LV2_Atom_Text_Writer writer;
+			lv2_atom_text_writer_init(&writer,
+			                          (LV2_Atom_Text_Format)f,
+			                          &map,
+			                          &unmap,
+			                          NULL,
+			                          buf,
+			                          sizeof(buf));
+			lv2_atom_text_write(&writer, &tests[i].atom.atom);
+			if (!lv2_atom_text_finish(&writer) || strcmp(buf, expected)) {
+				return test_fail("Incorrect real '%s'\n", buf);
+			}
+		}
+	}
+
+	return 0;
+}
+
+int
+main(void)
+{
+	LV2_URID_Map   map = { NULL, urid_map };
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, &map);
+
+	uint64_t              mem[128];
+	const LV2_Atom* const object =
+		forge_object(&forge, (uint8_t*)mem, sizeof(mem));
+	if (!object) {
+		return test_fail("Failed to forge object\n");
+	}
+
+	return (test_format(LV2_ATOM_TEXT_TURTLE, object, turtle_object) ||
+	        test_format(LV2_ATOM_TEXT_JSON, object, json_object) ||
+	        test_reals());
+}
@@ -0,0 +1,718 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @file text.h Writing atoms as text.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup text Text
+   @ingroup atom
+
+   Writing atoms as human-readable text, for logging and debugging.
+
+   Atoms can be written as Turtle, or as JSON with one atom per line.  The
+   output is meant to be read by people, so it is only Turtle-like: prefixed
+   names are used for the atom, rdf, and xsd namespaces without being
+   declared, and the ID of an object is written as an "@id" property.  In
+   JSON, objects are written similarly to JSON-LD, with "@id", "@type", and
+   "@value" keys.  Types that are not known are written as hex.
+
+   Text is written to a buffer supplied by the caller, and nothing is
+   allocated.  If a stream is given, the buffer is written to it whenever it
+   is full, so any amount of text can be written with a small buffer.
+   Otherwise, text that does not fit in the buffer is dropped, and the buffer
+   is a null-terminated string when finished.
+
+   Atoms are not checked, so atoms from an untrusted source should be checked
+   with lv2_atom_validate() first.
+
+   @{
+*/
+
+#ifndef LV2_ATOM_TEXT_H
+#define LV2_ATOM_TEXT_H
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Text format to write atoms in. */
+typedef enum {
+	LV2_ATOM_TEXT_TURTLE = 0,  /**< Turtle-like, indented. */
+	LV2_ATOM_TEXT_JSON   = 1   /**< JSON, one atom per line. */
+} LV2_Atom_Text_Format;
+
+/** URIDs of the types written as text. */
+typedef struct {
+	LV2_URID atom_Blank;
+	LV2_URID atom_Bool;
+	LV2_URID atom_Chunk;
+	LV2_URID atom_Double;
+	LV2_URID atom_Float;
+	LV2_URID atom_Int;
+	LV2_URID atom_Literal;
+	LV2_URID atom_Long;
+	LV2_URID atom_Object;
+	LV2_URID atom_Path;
+	LV2_URID atom_Resource;
+	LV2_URID atom_Sequence;
+	LV2_URID atom_String;
+	LV2_URID atom_Tuple;
+	LV2_URID atom_URI;
+	LV2_URID atom_URID;
+	LV2_URID atom_Vector;
+	LV2_URID atom_beatTime;
+} LV2_Atom_Text_Types;
+
+/** A writer of atoms as text. */
+typedef struct {
+	LV2_Atom_Text_Types  types;     /**< Types of atoms */
+	LV2_URID_Unmap*      unmap;     /**< URID unmapper for URIs */
+	LV2_Atom_Text_Format format;    /**< Text format */
+	FILE*                stream;    /**< Stream to write to, or NULL */
+	char*                buf;       /**< Buffer supplied by caller */
+	size_t               capacity;  /**< Usable size of `buf` in bytes */
+	size_t               len;       /**< Length of text in `buf` */
+	size_t               total;     /**< Length of all text written */
+	bool                 error;     /**< True if text was lost */
+} LV2_Atom_Text_Writer;
+
+/** @cond */
+static inline void
+lv2_atom_text_overflow(LV2_Atom_Text_Writer* writer,
+                       const char*           str,
+                       size_t                len)
+{
+	if (!writer->stream) {
+		// Fill the buffer, and drop the rest
+		const size_t n = writer->capacity - writer->len;
+		memcpy(writer->buf + writer->len, str, n);
+		writer->len   = writer->capacity;
+		writer->error = true;
+		return;
+	}
+
+	if (fwrite(writer->buf, 1, writer->len, writer->stream) != writer->len) {
+		writer->error = true;
+	}
+
+	writer->len = 0;
+	if (len > writer->capacity) {
+		if (fwrite(str, 1, len, writer->stream) != len) {
+			writer->error = true;
+		}
+	} else {
+		memcpy(writer->buf, str, len);
+		writer->len = len;
+	}
+}
+
+static inline void
+lv2_atom_text_put(LV2_Atom_Text_Writer* writer, const char* str, size_t len)
+{
+	writer->total += len;
+	if (writer->len + len <= writer->capacity) {
+		memcpy(writer->buf + writer->len, str, len);
+		writer->len += len;
+	} else {
+		lv2_atom_text_overflow(writer, str, len);
+	}
+}
+
+static inline void
+lv2_atom_text_putc(LV2_Atom_Text_Writer* writer, char c)
+{
+	if (writer->len < writer->capacity) {
+		writer->buf[writer->len++] = c;
+		++writer->total;
+	} else {
+		lv2_atom_text_put(writer, &c, 1);
+	}
+}
+
+static inline void
+lv2_atom_text_puts(LV2_Atom_Text_Writer* writer, const char* str)
+{
+	lv2_atom_text_put(writer, str, strlen(str));
+}
+
+static inline void
+lv2_atom_text_put_uint(LV2_Atom_Text_Writer* writer, uint64_t value)
+{
+	char  digits[20];
+	char* d = digits + sizeof(digits);
+	do {
+		*--d = (char)('0' + value % 10);
+		value /= 10;
+	} while (value);
+
+	lv2_atom_text_put(writer, d, (size_t)(digits + sizeof(digits) - d));
+}
+
+static inline void
+lv2_atom_text_put_int(LV2_Atom_Text_Writer* writer, int64_t value)
+{
+	if (value < 0) {
+		lv2_atom_text_putc(writer, '-');
+		lv2_atom_text_put_uint(writer, (uint64_t)0 - (uint64_t)value);
+	} else {
+		lv2_atom_text_put_uint(writer, (uint64_t)value);
+	}
+}
+
+static inline void
+lv2_atom_text_put_real(LV2_Atom_Text_Writer* writer,
+                       double                value,
+                       int                   precision,
+                       const char*           datatype)
+{
+	const bool        json    = writer->format == LV2_ATOM_TEXT_JSON;
+	const char* const special = (isnan(value) ? "NaN"
+	                             : !isinf(value) ? NULL
+	                             : value < 0.0 ? "-INF" : "INF");
+	if (special && json) {
+		lv2_atom_text_put(writer, "null", 4);
+		return;
+	}
+
+	char      str[32];
+	const int len =
+		special ? 0 : snprintf(str, sizeof(str), "%.*g", precision, value);
+	if (!json) {
+		lv2_atom_text_putc(writer, '"');
+	}
+
+	if (special) {
+		lv2_atom_text_puts(writer, special);
+	} else {
+		lv2_atom_text_put(writer, str, (size_t)len);
+	}
+
+	if (!json) {
+		lv2_atom_text_put(writer, "\"^^xsd:", 7);
+		lv2_atom_text_puts(writer, datatype);
+	}
+}
+
+static inline void
+lv2_atom_text_put_escaped(LV2_Atom_Text_Writer* writer,
+                          const char*           str,
+                          size_t                len,
+                          bool                  iri)
+{
+	static const char hex[] = "0123456789ABCDEF";
+
+	size_t start = 0;
+	for (size_t i = 0; i < len; ++i) {
+		const unsigned char c = (unsigned char)str[i];
+		if (c >= 0x20 && c != '"' && c != '\\' &&
+		    !(iri && (c == ' ' || c == '<' || c == '>' || c == '{' ||
+		              c == '}' || c == '|' || c == '^' || c == '`'))) {
+			continue;
+		}
+
+		lv2_atom_text_put(writer, str + start, i - start);
+		start = i + 1;
+
+		char esc[6] = { '\\', 0, '0', '0', hex[c >> 4], hex[c & 0xF] };
+		switch (iri ? 0 : c) {
+		case '"': esc[1] = '"'; break;
+		case '\\': esc[1] = '\\'; break;
+		case '\b': esc[1] = 'b'; break;
+		case '\f': esc[1] = 'f'; break;
+		case '\n': esc[1] = 'n'; break;
+		case '\r': esc[1] = 'r'; break;
+		case '\t': esc[1] = 't'; break;
+		default: esc[1] = 'u'; break;
+		}
+
+		lv2_atom_text_put(writer, esc, esc[1] == 'u' ? 6 : 2);
+	}
+
+	lv2_atom_text_put(writer, str + start, len - start);
+}
+
+static inline void
+lv2_atom_text_put_string(LV2_Atom_Text_Writer* writer,
+                         const char*           str,
+                         size_t                len)
+{
+	lv2_atom_text_putc(writer, '"');
+	lv2_atom_text_put_escaped(writer, str, len, false);
+	lv2_atom_text_putc(writer, '"');
+}
+
+/** Write a URI as a Turtle IRI or a JSON string. */
+static inline void
+lv2_atom_text_put_uri(LV2_Atom_Text_Writer* writer, const char* uri)
+{
+	if (writer->format == LV2_ATOM_TEXT_JSON) {
+		lv2_atom_text_put_string(writer, uri, strlen(uri));
+	} else {
+		lv2_atom_text_putc(writer, '<');
+		lv2_atom_text_put_escaped(writer, uri, strlen(uri), true);
+		lv2_atom_text_putc(writer, '>');
+	}
+}
+
+/** Write a URID as a URI, or as urid:N if it can not be unmapped. */
+static inline void
+lv2_atom_text_put_urid(LV2_Atom_Text_Writer* writer, LV2_URID urid)
+{
+	const char* const uri = writer->unmap->unmap(writer->unmap->handle, urid);
+	if (uri) {
+		lv2_atom_text_put_uri(writer, uri);
+		return;
+	}
+
+	const bool json = writer->format == LV2_ATOM_TEXT_JSON;
+	lv2_atom_text_put(writer, json ? "\"urid:" : "<urid:", 6);
+	lv2_atom_text_put_uint(writer, urid);
+	lv2_atom_text_putc(writer, json ? '"' : '>');
+}
+
+static inline void
+lv2_atom_text_put_hex(LV2_Atom_Text_Writer* writer,
+                      const void*           data,
+                      uint32_t              size)
+{
+	static const char hex[] = "0123456789ABCDEF";
+
+	const uint8_t* const bytes = (const uint8_t*)data;
+	char                 str[128];
+	for (uint32_t i = 0; i < size;) {
+		size_t len = 0;
+		for (; i < size && len < sizeof(str); ++i) {
+			str[len++] = hex[bytes[i] >> 4];
+			str[len++] = hex[bytes[i] & 0xF];
+		}
+
+		lv2_atom_text_put(writer, str, len);
+	}
+}
+
+/** Write a newline and indentation, in Turtle only. */
+static inline void
+lv2_atom_text_newline(LV2_Atom_Text_Writer* writer, unsigned indent)
+{
+	if (writer->format == LV2_ATOM_TEXT_TURTLE) {
+		lv2_atom_text_putc(writer, '\n');
+		for (unsigned i = 0; i < indent; ++i) {
+			lv2_atom_text_putc(writer, '\t');
+		}
+	}
+}
+
+/** Write a literal with a datatype or language, either of which may be 0. */
+static inline void
+lv2_atom_text_put_literal(LV2_Atom_Text_Writer* writer,
+                          const char*           str,
+                          size_t                len,
+                          LV2_URID              datatype,
+                          LV2_URID              lang)
+{
+	static const char lexvo[] = "http://lexvo.org/id/iso639-1/";
+
+	const char* const lang_uri =
+		lang ? writer->unmap->unmap(writer->unmap->handle, lang) : NULL;
+	const char* const tag =
+		(lang_uri && !strncmp(lang_uri, lexvo, sizeof(lexvo) - 1))
+		? lang_uri + sizeof(lexvo) - 1 : NULL;
+
+	if (writer->format == LV2_ATOM_TEXT_JSON) {
+		lv2_atom_text_put(writer, "{\"@value\":", 10);
+		lv2_atom_text_put_string(writer, str, len);
+		if (tag) {
+			lv2_atom_text_put(writer, ",\"@language\":", 13);
+			lv2_atom_text_put_string(writer, tag, strlen(tag));
+		} else if (datatype) {
+			lv2_atom_text_put(writer, ",\"@type\":", 9);
+			lv2_atom_text_put_urid(writer, datatype);
+		}
+		lv2_atom_text_putc(writer, '}');
+	} else {
+		lv2_atom_text_put_string(writer, str, len);
+		if (tag) {
+			lv2_atom_text_putc(writer, '@');
+			lv2_atom_text_puts(writer, tag);
+		} else if (datatype) {
+			lv2_atom_text_put(writer, "^^", 2);
+			lv2_atom_text_put_urid(writer, datatype);
+		}
+	}
+}
+
+static inline void
+lv2_atom_text_put_value(LV2_Atom_Text_Writer* writer,
+                        LV2_URID              type,
+                        uint32_t              size,
+                        const void*           body,
+                        unsigned              indent);
+
+static inline void
+lv2_atom_text_put_atom(LV2_Atom_Text_Writer* writer,
+                       const LV2_Atom*       atom,
+                       unsigned              indent)
+{
+	lv2_atom_text_put_value(writer, atom->type, atom->size, atom + 1, indent);
+}
+
+static inline void
+lv2_atom_text_put_object(LV2_Atom_Text_Writer*      writer,
+                         const LV2_Atom_Object_Body* body,
+                         uint32_t                   size,
+                         unsigned                   indent)
+{
+	const bool json  = writer->format == LV2_ATOM_TEXT_JSON;
+	bool       first = true;
+
+	lv2_atom_text_putc(writer, json ? '{' : '[');
+	if (body->id) {
+		lv2_atom_text_newline(writer, indent + 1);
+		lv2_atom_text_put(writer, json ? "\"@id\":" : "@id ", json ? 6 : 4);
+		lv2_atom_text_put_urid(writer, body->id);
+		first = false;
+	}
+
+	if (body->otype) {
+		if (!first) {
+			lv2_atom_text_put(writer, json ? "," : " ;", json ? 1 : 2);
+		}
+		lv2_atom_text_newline(writer, indent + 1);
+		lv2_atom_text_put(writer, json ? "\"@type\":" : "a ", json ? 8 : 2);
+		lv2_atom_text_put_urid(writer, body->otype);
+		first = false;
+	}
+
+	LV2_ATOM_OBJECT_BODY_FOREACH(body, size, prop) {
+		if (!first) {
+			lv2_atom_text_put(writer, json ? "," : " ;", json ? 1 : 2);
+		}
+		lv2_atom_text_newline(writer, indent + 1);
+		lv2_atom_text_put_urid(writer, prop->key);
+		lv2_atom_text_putc(writer, json ? ':' : ' ');
+		lv2_atom_text_put_atom(writer, &prop->value, indent + 1);
+		first = false;
+	}
+
+	if (!first) {
+		lv2_atom_text_newline(writer, indent);
+	}
+	lv2_atom_text_putc(writer, json ? '}' : ']');
+}
+
+static inline void
+lv2_atom_text_put_sequence(LV2_Atom_Text_Writer*        writer,
+                           const LV2_Atom_Sequence_Body* body,
+                           uint32_t                     size,
+                           unsigned                     indent)
+{
+	const bool json  = writer->format == LV2_ATOM_TEXT_JSON;
+	const bool beats =
+		body->unit && body->unit == writer->types.atom_beatTime;
+	bool       first = true;
+
+	lv2_atom_text_putc(writer, json ? '[' : '(');
+	LV2_ATOM_SEQUENCE_BODY_FOREACH(body, size, ev) {
+		if (!first && json) {
+			lv2_atom_text_putc(writer, ',');
+		}
+
+		lv2_atom_text_newline(writer, indent + 1);
+		if (json) {
+			lv2_atom_text_puts(writer, beats ? "{\"beatTime\":"
+			                                 : "{\"frameTime\":");
+		} else {
+			lv2_atom_text_puts(writer, beats ? "[ atom:beatTime "
+			                                 : "[ atom:frameTime ");
+		}
+
+		if (beats) {
+			char      str[32];
+			const int len =
+				snprintf(str, sizeof(str), "%.17g", ev->time.beats);
+			lv2_atom_text_put(writer, str, (size_t)len);
+		} else {
+			lv2_atom_text_put_int(writer, ev->time.frames);
+		}
+
+		lv2_atom_text_puts(writer, json ? ",\"value\":" : " ; rdf:value ");
+		lv2_atom_text_put_atom(writer, &ev->body, indent + 1);
+		lv2_atom_text_put(writer, json ? "}" : " ]", json ? 1 : 2);
+		first = false;
+	}
+
+	if (!first) {
+		lv2_atom_text_newline(writer, indent);
+	}
+	lv2_atom_text_putc(writer, json ? ']' : ')');
+}
+
+static inline void
+lv2_atom_text_put_value(LV2_Atom_Text_Writer* writer,
+                        LV2_URID              type,
+                        uint32_t              size,
+                        const void*           body,
+                        unsigned              indent)
+{
+	const LV2_Atom_Text_Types* const t   = &writer->types;
+	const char* const                str = (const char*)body;
+	const bool json = writer->format == LV2_ATOM_TEXT_JSON;
+
+	if (!type && !size) {
+		lv2_atom_text_put(writer, json ? "null" : "()", json ? 4 : 2);
+	} else if (type == t->atom_Int && size == sizeof(int32_t)) {
+		lv2_atom_text_put_int(writer, *(const int32_t*)body);
+	} else if (type == t->atom_Long && size == sizeof(int64_t)) {
+		if (json) {
+			lv2_atom_text_put_int(writer, *(const int64_t*)body);
+		} else {
+			lv2_atom_text_putc(writer, '"');
+			lv2_atom_text_put_int(writer, *(const int64_t*)body);
+			lv2_atom_text_put(writer, "\"^^xsd:long", 11);
+		}
+	} else if (type == t->atom_Float && size == sizeof(float)) {
+		lv2_atom_text_put_real(writer, *(const float*)body, 9, "float");
+	} else if (type == t->atom_Double && size == sizeof(double)) {
+		lv2_atom_text_put_real(writer, *(const double*)body, 17, "double");
+	} else if (type == t->atom_Bool && size == sizeof(int32_t)) {
+		if (*(const int32_t*)body) {
+			lv2_atom_text_put(writer, "true", 4);
+		} else {
+			lv2_atom_text_put(writer, "false", 5);
+		}
+	} else if (type == t->atom_URID && size == sizeof(LV2_URID)) {
+		if (json) {
+			lv2_atom_text_put(writer, "{\"@id\":", 7);
+		}
+		lv2_atom_text_put_urid(writer, *(const LV2_URID*)body);
+		if (json) {
+			lv2_atom_text_putc(writer, '}');
+		}
+	} else if (type == t->atom_String || type == t->atom_Path ||
+	           type == t->atom_URI) {
+		const char* const end = (const char*)memchr(str, '\0', size);
+		const size_t      len = end ? (size_t)(end - str) : size;
+		if (type == t->atom_String) {
+			lv2_atom_text_put_string(writer, str, len);
+		} else if (type == t->atom_Path) {
+			lv2_atom_text_put_literal(writer, str, len, type, 0);
+		} else if (json) {
+			lv2_atom_text_put(writer, "{\"@id\":", 7);
+			lv2_atom_text_put_string(writer, str, len);
+			lv2_atom_text_putc(writer, '}');
+		} else {
+			lv2_atom_text_putc(writer, '<');
+			lv2_atom_text_put_escaped(writer, str, len, true);
+			lv2_atom_text_putc(writer, '>');
+		}
+	} else if (type == t->atom_Literal &&
+	           size >= sizeof(LV2_Atom_Literal_Body)) {
+		const LV2_Atom_Literal_Body* const lit =
+			(const LV2_Atom_Literal_Body*)body;
+
+		const char* const chars = (const char*)(lit + 1);
+		const uint32_t    n     = size - (uint32_t)sizeof(*lit);
+		const char* const end   = (const char*)memchr(chars, '\0', n);
+		lv2_atom_text_put_literal(writer,
+		                          chars,
+		                          end ? (size_t)(end - chars) : n,
+		                          lit->datatype,
+		                          lit->lang);
+	} else if (type == t->atom_Tuple) {
+		lv2_atom_text_putc(writer, json ? '[' : '(');
+		LV2_ATOM_TUPLE_BODY_FOREACH(body, size, elem) {
+			if (elem != body) {
+				lv2_atom_text_putc(writer, json ? ',' : ' ');
+			} else if (!json) {
+				lv2_atom_text_putc(writer, ' ');
+			}
+			lv2_atom_text_put_atom(writer, elem, indent);
+		}
+		lv2_atom_text_put(writer, json ? "]" : " )", json ? 1 : 2);
+	} else if (type == t->atom_Vector &&
+	           size >= sizeof(LV2_Atom_Vector_Body)) {
+		const LV2_Atom_Vector_Body* const vec =
+			(const LV2_Atom_Vector_Body*)body;
+
+		const uint32_t n_elems = vec->child_size
+			? (size - (uint32_t)sizeof(*vec)) / vec->child_size
+			: 0;
+
+		const uint8_t* elem = (const uint8_t*)(vec + 1);
+		lv2_atom_text_putc(writer, json ? '[' : '(');
+		for (uint32_t i = 0; i < n_elems; ++i, elem += vec->child_size) {
+			if (i > 0 || !json) {
+				lv2_atom_text_putc(writer, json ? ',' : ' ');
+			}
+			lv2_atom_text_put_value(
+				writer, vec->child_type, vec->child_size, elem, indent);
+		}
+		lv2_atom_text_put(writer, json ? "]" : " )", json ? 1 : 2);
+	} else if ((type == t->atom_Object || type == t->atom_Resource ||
+	            type == t->atom_Blank) &&
+	           size >= sizeof(LV2_Atom_Object_Body)) {
+		lv2_atom_text_put_object(
+			writer, (const LV2_Atom_Object_Body*)body, size, indent);
+	} else if (type == t->atom_Sequence &&
+	           size >= sizeof(LV2_Atom_Sequence_Body)) {
+		lv2_atom_text_put_sequence(
+			writer, (const LV2_Atom_Sequence_Body*)body, size, indent);
+	} else if (json) {
+		lv2_atom_text_put(writer, "{\"@type\":", 9);
+		lv2_atom_text_put_urid(writer, type);
+		lv2_atom_text_put(writer, ",\"@value\":\"", 11);
+		lv2_atom_text_put_hex(writer, body, size);
+		lv2_atom_text_put(writer, "\"}", 2);
+	} else {
+		if (type != t->atom_Chunk) {
+			lv2_atom_text_put(writer, "[ a ", 4);
+			lv2_atom_text_put_urid(writer, type);
+			lv2_atom_text_put(writer, " ; rdf:value ", 13);
+		}
+
+		lv2_atom_text_putc(writer, '"');
+		lv2_atom_text_put_hex(writer, body, size);
+		lv2_atom_text_put(writer, "\"^^xsd:hexBinary", 16);
+		if (type != t->atom_Chunk) {
+			lv2_atom_text_put(writer, " ]", 2);
+		}
+	}
+}
+/** @endcond */
+
+/** Initialise `types` by mapping the URIs of the types written as text. */
+static inline void
+lv2_atom_text_types_init(LV2_Atom_Text_Types* types, LV2_URID_Map* map)
+{
+	types->atom_Blank    = map->map(map->handle, LV2_ATOM__Blank);
+	types->atom_Bool     = map->map(map->handle, LV2_ATOM__Bool);
+	types->atom_Chunk    = map->map(map->handle, LV2_ATOM__Chunk);
+	types->atom_Double   = map->map(map->handle, LV2_ATOM__Double);
+	types->atom_Float    = map->map(map->handle, LV2_ATOM__Float);
+	types->atom_Int      = map->map(map->handle, LV2_ATOM__Int);
+	types->atom_Literal  = map->map(map->handle, LV2_ATOM__Literal);
+	types->atom_Long     = map->map(map->handle, LV2_ATOM__Long);
+	types->atom_Object   = map->map(map->handle, LV2_ATOM__Object);
+	types->atom_Path     = map->map(map->handle, LV2_ATOM__Path);
+	types->atom_Resource = map->map(map->handle, LV2_ATOM__Resource);
+	types->atom_Sequence = map->map(map->handle, LV2_ATOM__Sequence);
+	types->atom_String   = map->map(map->handle, LV2_ATOM__String);
+	types->atom_Tuple    = map->map(map->handle, LV2_ATOM__Tuple);
+	types->atom_URI      = map->map(map->handle, LV2_ATOM__URI);
+	types->atom_URID     = map->map(map->handle, LV2_ATOM__URID);
+	types->atom_Vector   = map->map(map->handle, LV2_ATOM__Vector);
+	types->atom_beatTime = map->map(map->handle, LV2_ATOM__beatTime);
+}
+
+/**
+   Initialise a text writer.
+
+   @param writer The writer to initialise.
+   @param format The format to write.
+   @param map URID mapper, for the types of atoms.
+   @param unmap URID unmapper, for writing URIDs as URIs.
+   @param stream Stream to write text to, or NULL to only write to `buf`.
+   @param buf Buffer for text.
+   @param size Size of `buf` in bytes, which must be at least 1.
+*/
+static inline void
+lv2_atom_text_writer_init(LV2_Atom_Text_Writer* writer,
+                          LV2_Atom_Text_Format  format,
+                          LV2_URID_Map*         map,
+                          LV2_URID_Unmap*       unmap,
+                          FILE*                 stream,
+                          char*                 buf,
+                          size_t                size)
+{
+	lv2_atom_text_types_init(&writer->types, map);
+	writer->unmap    = unmap;
+	writer->format   = format;
+	writer->stream   = stream;
+	writer->buf      = buf;
+	writer->capacity = stream ? size : size - 1;  // Space for null
+	writer->len      = 0;
+	writer->total    = 0;
+	writer->error    = false;
+}
+
+/**
+   Write an atom, followed by a newline.
+
+   @return False if any text has been lost since the writer was reset.
+*/
+static inline bool
+lv2_atom_text_write(LV2_Atom_Text_Writer* writer, const LV2_Atom* atom)
+{
+	lv2_atom_text_put_atom(writer, atom, 0);
+	lv2_atom_text_putc(writer, '\n');
+	return !writer->error;
+}
+
+/**
+   Finish writing.
+
+   If the writer has a stream, buffered text is written to it, otherwise the
+   buffer is null terminated.  The writer may continue to be used afterwards.
+
+   @return False if any text has been lost since the writer was reset.
+*/
+static inline bool
+lv2_atom_text_finish(LV2_Atom_Text_Writer* writer)
+{
+	if (!writer->stream) {
+		writer->buf[writer->len] = '\0';
+	} else if (writer->len) {
+		const size_t n = fwrite(writer->buf, 1, writer->len, writer->stream);
+		writer->error |= (n != writer->len);
+		writer->len = 0;
+	}
+
+	return !writer->error;
+}
+
+/** Discard all text in the buffer, and clear any error. */
+static inline void
+lv2_atom_text_reset(LV2_Atom_Text_Writer* writer)
+{
+	writer->len   = 0;
+	writer->total = 0;
+	writer->error = false;
+}
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif /* LV2_ATOM_TEXT_H */
@@ -0,0 +1,782 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MIDI_EVENT 1
+#define N_NOTES    4
+
+typedef struct {
+	LV2_Atom_Event event;
+	uint8_t        msg[3];
+} MIDINoteEvent;
+
+typedef struct {
+	LV2_Atom_Sequence seq;
+	uint8_t           events[N_NOTES * sizeof(MIDINoteEvent)];
+} SequenceBuffer;
+
+static int
+test_fail(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	fprintf(stderr, "error: ");
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	return 1;
+}
+
+/** Map URIs to their position in a fixed table. */
+static LV2_URID
+urid_map(LV2_URID_Map_Handle handle, const char* uri)
+{
+	static const char* const uris[] = {
+		LV2_ATOM__Blank,    LV2_ATOM__Float,    LV2_ATOM__Int,
+		LV2_ATOM__Object,   LV2_ATOM__Resource, LV2_ATOM__Sequence,
+		LV2_ATOM__Tuple,    LV2_ATOM__Vector,   LV2_ATOM__beatTime,
+		LV2_ATOM__frameTime };
+
+	(void)handle;
+	for (uint32_t i = 0; i < sizeof(uris) / sizeof(uris[0]); ++i) {
+		if (!strcmp(uri, uris[i])) {
+			return 100 + i;
+		}
+	}
+
+	return 1000 + (LV2_URID)strlen(uri);
+}
+
+static void
+set_note(MIDINoteEvent* note, int64_t frames, uint8_t key)
+{
+	memset(note, 0, sizeof(MIDINoteEvent));
+	note->event.time.frames = frames;
+	note->event.body.type   = MIDI_EVENT;
+	note->event.body.size   = 3;
+	note->msg[0]            = 0x90;
+	note->msg[1]            = key;
+	note->msg[2]            = 64;
+}
+
+/** Check that `seq` contains exactly the notes `first` to `first + n - 1`. */
+static int
+check_notes(const LV2_Atom_Sequence* seq, uint8_t first, uint32_t n)
+{
+	uint32_t i = 0;
+	LV2_ATOM_SEQUENCE_FOREACH(seq, ev) {
+		const uint8_t* const msg = (const uint8_t*)(ev + 1);
+		if (i >= n) {
+			return test_fail("Too many events\n");
+		} else if (ev->time.frames != first + i ||
+		           ev->body.type != MIDI_EVENT || ev->body.size != 3 ||
+		           msg[1] != first + i) {
+			return test_fail("Bad event %u\n", i);
+		}
+		++i;
+	}
+
+	return (i == n) ? 0 : test_fail("Found %u events, not %u\n", i, n);
+}
+
+static int
+test_append_events(void)
+{
+	const uint32_t capacity = sizeof(SequenceBuffer) - sizeof(LV2_Atom);
+	SequenceBuffer buf;
+	lv2_atom_sequence_clear(&buf.seq);
+
+	// An array of fixed-size events has the same layout as a sequence
+	MIDINoteEvent notes[N_NOTES];
+	for (uint32_t i = 0; i < N_NOTES; ++i) {
+		set_note(&notes[i], i, (uint8_t)i);
+	}
+
+	// Append the first note singly, then the rest in one go
+	if (!lv2_atom_sequence_append_event(&buf.seq, capacity, &notes[0].event)) {
+		return test_fail("Failed to append single event\n");
+	}
+
+	const LV2_Atom_Event* e = lv2_atom_sequence_append_events(
+		&buf.seq, capacity, &notes[1].event, sizeof(notes) - sizeof(notes[0]));
+	if (e != lv2_atom_sequence_next(lv2_atom_sequence_begin(&buf.seq.body))) {
+		return test_fail("Appended events at wrong position\n");
+	} else if (check_notes(&buf.seq, 0, N_NOTES)) {
+		return 1;
+	}
+
+	// Sequence is now full
+	if (lv2_atom_sequence_append_events(
+		    &buf.seq, capacity, &notes[0].event, sizeof(notes[0]))) {
+		return test_fail("Appended events past end of sequence\n");
+	}
+
+	// Appending a batch which does not fit writes nothing
+	lv2_atom_sequence_clear(&buf.seq);
+	lv2_atom_sequence_append_event(&buf.seq, capacity, &notes[0].event);
+	if (lv2_atom_sequence_append_events(
+		    &buf.seq, capacity, &notes[0].event, sizeof(notes))) {
+		return test_fail("Appended batch larger than free space\n");
+	} else if (check_notes(&buf.seq, 0, 1)) {
+		return 1;
+	}
+
+	return 0;
+}
+
+static int
+test_append_range(void)
+{
+	const uint32_t capacity = sizeof(SequenceBuffer) - sizeof(LV2_Atom);
+	SequenceBuffer in;
+	SequenceBuffer out;
+	lv2_atom_sequence_clear(&in.seq);
+	lv2_atom_sequence_clear(&out.seq);
+
+	for (uint32_t i = 0; i < N_NOTES; ++i) {
+		MIDINoteEvent note;
+		set_note(&note, i, (uint8_t)i);
+		lv2_atom_sequence_append_event(&in.seq, capacity, &note.event);
+	}
+
+	// Copy the events from frame 1 up to frame 3
+	const LV2_Atom_Event* begin = NULL;
+	const LV2_Atom_Event* end   = NULL;
+	LV2_ATOM_SEQUENCE_FOREACH(&in.seq, ev) {
+		if (!begin && ev->time.frames >= 1) {
+			begin = ev;
+		} else if (!end && ev->time.frames >= 3) {
+			end = ev;
+		}
+	}
+
+	if (!lv2_atom_sequence_append_range(&out.seq, capacity, begin, end)) {
+		return test_fail("Failed to append range\n");
+	} else if (check_notes(&out.seq, 1, 2)) {
+		return 1;
+	}
+
+	// Copy the rest of the input
+	begin = lv2_atom_sequence_begin(&in.seq.body);
+	end   = lv2_atom_sequence_end(&in.seq.body, in.seq.atom.size);
+	lv2_atom_sequence_clear(&out.seq);
+	if (!lv2_atom_sequence_append_range(&out.seq, capacity, begin, end)) {
+		return test_fail("Failed to append whole sequence\n");
+	}
+
+	return check_notes(&out.seq, 0, N_NOTES);
+}
+
+static int
+test_reserve(void)
+{
+	const uint32_t capacity = sizeof(SequenceBuffer) - sizeof(LV2_Atom);
+	SequenceBuffer buf;
+	lv2_atom_sequence_clear(&buf.seq);
+
+	// Reserving more than the capacity fails and leaves the sequence unchanged
+	if (lv2_atom_sequence_reserve(&buf.seq, capacity, N_NOTES + 1, 3)) {
+		return test_fail("Reserved events past end of sequence\n");
+	} else if (buf.seq.atom.size != sizeof(LV2_Atom_Sequence_Body)) {
+		return test_fail("Failed reserve changed sequence size\n");
+	}
+
+	// Reserve space for every note and write them in place
+	LV2_Atom_Event* ev =
+		lv2_atom_sequence_reserve(&buf.seq, capacity, N_NOTES, 3);
+	if (!ev) {
+		return test_fail("Failed to reserve events\n");
+	}
+
+	for (uint32_t i = 0; i < N_NOTES; ++i) {
+		MIDINoteEvent* const note = (MIDINoteEvent*)ev;
+		set_note(note, i, (uint8_t)i);
+		ev = lv2_atom_sequence_next(ev);
+	}
+
+	if (ev != lv2_atom_sequence_end(&buf.seq.body, buf.seq.atom.size)) {
+		return test_fail("Reserved wrong amount of space\n");
+	} else if (lv2_atom_sequence_reserve(&buf.seq, capacity, 1, 0)) {
+		return test_fail("Reserved event in full sequence\n");
+	}
+
+	return check_notes(&buf.seq, 0, N_NOTES);
+}
+
+static int
+test_merge(void)
+{
+	// Note numbers are the expected output order, inputs have equal times
+	static const int64_t times[3][N_NOTES] = {
+		{ 0, 2, 2, 5 }, { 1, 2, 3, 4 }, { 0, 2, 6, 7 } };
+	static const uint8_t keys[3][N_NOTES] = {
+		{ 0, 3, 4, 9 }, { 2, 5, 7, 8 }, { 1, 6, 10, 11 } };
+
+	const uint32_t capacity = sizeof(SequenceBuffer) - sizeof(LV2_Atom);
+	SequenceBuffer in[4];
+	for (uint32_t i = 0; i < 3; ++i) {
+		lv2_atom_sequence_clear(&in[i].seq);
+		for (uint32_t j = 0; j < N_NOTES; ++j) {
+			MIDINoteEvent note;
+			set_note(&note, times[i][j], keys[i][j]);
+			lv2_atom_sequence_append_event(&in[i].seq, capacity, &note.event);
+		}
+	}
+	lv2_atom_sequence_clear(&in[3].seq);  // Empty input
+
+	const LV2_Atom_Sequence* inputs[] = {
+		&in[0].seq, &in[3].seq, &in[1].seq, &in[2].seq };
+
+	// Iterate over all events in order
+	LV2_Atom_Sequence_Merge merge;
+	if (!lv2_atom_sequence_merge_init(&merge, inputs, 4)) {
+		return test_fail("Failed to initialise merge\n");
+	}
+
+	static const uint32_t expected_inputs[] = {
+		0, 3, 2, 0, 0, 2, 3, 2, 2, 0, 3, 3 };
+
+	uint32_t n     = 0;
+	uint32_t input = 0;
+	for (const LV2_Atom_Event* ev = NULL;
+	     (ev = lv2_atom_sequence_merge_next(&merge, &input));
+	     ++n) {
+		const uint8_t* const msg = (const uint8_t*)(ev + 1);
+		if (msg[1] != n) {
+			return test_fail("Merged note %u out of order\n", msg[1]);
+		} else if (input != expected_inputs[n]) {
+			return test_fail("Note %u from input %u\n", n, input);
+		}
+	}
+
+	if (n != 3 * N_NOTES) {
+		return test_fail("Merged %u events, not %u\n", n, 3 * N_NOTES);
+	} else if (lv2_atom_sequence_merge_next(&merge, NULL)) {
+		return test_fail("Merge iterated past end\n");
+	}
+
+	// Merge into a buffer
+	struct {
+		LV2_Atom_Sequence seq;
+		MIDINoteEvent     events[3 * N_NOTES];
+	} out;
+
+	const uint32_t out_capacity = sizeof(out) - sizeof(LV2_Atom);
+	lv2_atom_sequence_clear(&out.seq);
+	if (!lv2_atom_sequence_merge(&out.seq, out_capacity, inputs, 4)) {
+		return test_fail("Failed to merge into buffer\n");
+	}
+
+	n = 0;
+	LV2_ATOM_SEQUENCE_FOREACH(&out.seq, ev) {
+		const uint8_t* const msg = (const uint8_t*)(ev + 1);
+		if (msg[1] != n++) {
+			return test_fail("Merged note %u out of order\n", msg[1]);
+		}
+	}
+
+	if (n != 3 * N_NOTES) {
+		return test_fail("Merged %u events into buffer\n", n);
+	}
+
+	// Merge into a buffer which is too small
+	lv2_atom_sequence_clear(&out.seq);
+	if (lv2_atom_sequence_merge(&out.seq, out_capacity - 8, inputs, 4)) {
+		return test_fail("Merged past end of buffer\n");
+	} else if (lv2_atom_sequence_merge_init(
+		           &merge, inputs, LV2_ATOM_MERGE_MAX_INPUTS + 1)) {
+		return test_fail("Initialised merge with too many inputs\n");
+	}
+
+	return 0;
+}
+
+static int
+test_slicer(void)
+{
+	static const int64_t times[] = { 0, 10, 12, 13, 40, 40, 200 };
+	static const uint32_t n_times = sizeof(times) / sizeof(times[0]);
+
+	// Expected slices as (start, end, number of events)
+	static const uint32_t coalesced[][3] = {
+		{ 0, 0, 1 }, { 0, 10, 3 }, { 10, 40, 2 }, { 40, 100, 1 },
+		{ 100, 100, 0 } };
+	static const uint32_t exact[][3] = {
+		{ 0, 0, 1 }, { 0, 10, 1 }, { 10, 12, 1 }, { 12, 13, 1 },
+		{ 13, 40, 2 }, { 40, 100, 1 }, { 100, 100, 0 } };
+
+	struct {
+		LV2_Atom_Sequence seq;
+		MIDINoteEvent     events[sizeof(times) / sizeof(times[0])];
+	} buf;
+
+	const uint32_t capacity = sizeof(buf) - sizeof(LV2_Atom);
+	lv2_atom_sequence_clear(&buf.seq);
+	for (uint32_t i = 0; i < n_times; ++i) {
+		MIDINoteEvent note;
+		set_note(&note, times[i], (uint8_t)i);
+		lv2_atom_sequence_append_event(&buf.seq, capacity, &note.event);
+	}
+
+	for (uint32_t min_span = 0; min_span <= 8; min_span += 8) {
+		const uint32_t (*slices)[3] = min_span ? coalesced : exact;
+		const uint32_t n_slices     = min_span ? 5 : 7;
+
+		LV2_Atom_Sequence_Slicer slicer;
+		LV2_Atom_Sequence_Slice  slice;
+		lv2_atom_sequence_slicer_init(&slicer, &buf.seq, 100, min_span);
+
+		uint32_t n       = 0;
+		uint32_t n_notes = 0;
+		for (; lv2_atom_sequence_slicer_next(&slicer, &slice); ++n) {
+			uint32_t n_events = 0;
+			LV2_ATOM_SLICE_FOREACH(&slice, ev) {
+				const uint8_t* const msg = (const uint8_t*)(ev + 1);
+				if (msg[1] != n_notes++) {
+					return test_fail("Sliced event %u out of order\n", msg[1]);
+				}
+				++n_events;
+			}
+
+			if (n >= n_slices) {
+				return test_fail("Too many slices\n");
+			} else if (slice.start != slices[n][0] ||
+			           slice.end != slices[n][1] ||
+			           n_events != slices[n][2]) {
+				return test_fail("Bad slice %u [%u, %u) with %u events\n",
+				                 n, slice.start, slice.end, n_events);
+			}
+		}
+
+		if (n != n_slices) {
+			return test_fail("Made %u slices, not %u\n", n, n_slices);
+		} else if (n_notes != n_times) {
+			return test_fail("Sliced %u events, not %u\n", n_notes, n_times);
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_index(void)
+{
+	// Sequence of events with two at every even frame
+	struct {
+		LV2_Atom_Sequence seq;
+		MIDINoteEvent     events[64];
+	} buf;
+
+	const uint32_t capacity = sizeof(buf) - sizeof(LV2_Atom);
+	lv2_atom_sequence_clear(&buf.seq);
+	for (uint32_t i = 0; i < 64; ++i) {
+		MIDINoteEvent note;
+		set_note(&note, (int64_t)(i / 2 * 2), (uint8_t)i);
+		lv2_atom_sequence_append_event(&buf.seq, capacity, &note.event);
+	}
+
+	uint32_t                offsets[64];
+	LV2_Atom_Sequence_Index index;
+	if (lv2_atom_sequence_count(&buf.seq) != 64) {
+		return test_fail("Counted wrong number of events\n");
+	} else if (lv2_atom_sequence_index_init(&index, &buf.seq, offsets, 63)) {
+		return test_fail("Indexed more events than capacity\n");
+	} else if (!lv2_atom_sequence_index_init(&index, &buf.seq, offsets, 64)) {
+		return test_fail("Failed to index sequence\n");
+	}
+
+	// Access every event by position
+	for (uint32_t i = 0; i < 64; ++i) {
+		const LV2_Atom_Event* ev  = lv2_atom_sequence_index_get(&index, i);
+		const uint8_t* const  msg = (const uint8_t*)(ev + 1);
+		if (msg[1] != i) {
+			return test_fail("Indexed event %u is note %u\n", i, msg[1]);
+		}
+	}
+
+	if (lv2_atom_sequence_index_get(&index, 64) !=
+	    lv2_atom_sequence_end(&buf.seq.body, buf.seq.atom.size)) {
+		return test_fail("Index end is not sequence end\n");
+	}
+
+	// Find events by time, which returns the first of any with equal times
+	for (int t = -1; t <= 65; ++t) {
+		const uint32_t expected = (t < 0)    ? 0
+		                          : (t > 62) ? 64
+		                                     : (uint32_t)(t + t % 2);
+
+		const uint32_t i = lv2_atom_sequence_index_find(&index, t);
+		if (i != expected) {
+			return test_fail("Found %u at time %d, not %u\n", i, t, expected);
+		}
+	}
+
+	// Copy a range of events between positions
+	SequenceBuffer out;
+	lv2_atom_sequence_clear(&out.seq);
+	const uint32_t begin = lv2_atom_sequence_index_find(&index, 10);
+	if (!lv2_atom_sequence_append_range(
+		    &out.seq,
+		    sizeof(out) - sizeof(LV2_Atom),
+		    lv2_atom_sequence_index_get(&index, begin),
+		    lv2_atom_sequence_index_get(&index, begin + N_NOTES))) {
+		return test_fail("Failed to copy indexed range\n");
+	}
+
+	uint8_t key = 10;
+	LV2_ATOM_SEQUENCE_FOREACH(&out.seq, ev) {
+		const uint8_t* const msg = (const uint8_t*)(ev + 1);
+		if (msg[1] != key++) {
+			return test_fail("Copied note %u, not %u\n", msg[1], key - 1);
+		}
+	}
+
+	return (key == 10 + N_NOTES) ? 0 : test_fail("Copied wrong range\n");
+}
+
+/** Write an object with a tuple of a vector and a sequence to `buf`. */
+static LV2_Atom*
+forge_tree(LV2_Atom_Forge* forge, uint8_t* buf, uint32_t size)
+{
+	static const int32_t elems[] = { 1, 2, 3 };
+
+	LV2_Atom_Forge_Frame obj_frame;
+	LV2_Atom_Forge_Frame tup_frame;
+	LV2_Atom_Forge_Frame seq_frame;
+	lv2_atom_forge_set_buffer(forge, buf, size);
+	LV2_Atom* const atom = (LV2_Atom*)lv2_atom_forge_object(
+		forge, &obj_frame, 0, 1);
+
+	lv2_atom_forge_key(forge, 2);
+	lv2_atom_forge_float(forge, 1.0f);
+	lv2_atom_forge_key(forge, 3);
+	lv2_atom_forge_tuple(forge, &tup_frame);
+	lv2_atom_forge_vector(forge, sizeof(int32_t), forge->Int, 3, elems);
+	lv2_atom_forge_sequence_head(forge, &seq_frame, 0);
+	for (int64_t t = 0; t < 3; ++t) {
+		lv2_atom_forge_frame_time(forge, t);
+		lv2_atom_forge_int(forge, (int32_t)t);
+	}
+	lv2_atom_forge_pop(forge, &seq_frame);
+	lv2_atom_forge_tuple(forge, &seq_frame);  // Empty tuple
+	lv2_atom_forge_pop(forge, &seq_frame);
+	lv2_atom_forge_pop(forge, &tup_frame);
+	lv2_atom_forge_key(forge, 4);
+	lv2_atom_forge_int(forge, 4);
+	lv2_atom_forge_pop(forge, &obj_frame);
+
+	return atom;
+}
+
+/** Return the first atom of type `type` found by a byte search of `buf`. */
+static LV2_Atom*
+find_atom(uint8_t* buf, uint32_t size, LV2_URID type)
+{
+	for (uint32_t i = 0; i + sizeof(LV2_Atom) <= size; i += 8) {
+		LV2_Atom* const atom = (LV2_Atom*)(buf + i);
+		if (atom->type == type) {
+			return atom;
+		}
+	}
+
+	return NULL;
+}
+
+static int
+test_validate(void)
+{
+	static const uint32_t size = 512;
+
+	LV2_URID_Map       map = { NULL, urid_map };
+	LV2_Atom_Forge     forge;
+	LV2_Atom_Validator validator;
+	lv2_atom_forge_init(&forge, &map);
+	lv2_atom_validator_init(&validator, &map);
+
+	uint64_t        mem[64];
+	uint8_t* const  buf  = (uint8_t*)mem;
+	LV2_Atom* const atom = forge_tree(&forge, buf, size);
+	const uint32_t  used = lv2_atom_total_size(atom);
+	if (!lv2_atom_validate(&validator, atom, size)) {
+		return test_fail("Failed to validate valid tree\n");
+	} else if (!lv2_atom_validate(&validator, atom, used)) {
+		return test_fail("Failed to validate tree in exact buffer\n");
+	} else if (lv2_atom_validate(&validator, atom, used - 1)) {
+		return test_fail("Validated tree larger than buffer\n");
+	} else if (lv2_atom_validate(&validator, (LV2_Atom*)(buf + 4), size - 4)) {
+		return test_fail("Validated misaligned atom\n");
+	}
+
+	// Child too large for its container
+	LV2_Atom_Vector* const vector =
+		(LV2_Atom_Vector*)find_atom(buf, used, forge.Vector);
+	vector->atom.size += 1024;
+	if (lv2_atom_validate(&validator, atom, size)) {
+		return test_fail("Validated child larger than container\n");
+	}
+	vector->atom.size -= 1024;
+
+	// Vector with a partial element
+	vector->body.child_size = 8;
+	if (lv2_atom_validate(&validator, atom, size)) {
+		return test_fail("Validated vector with partial element\n");
+	}
+	vector->body.child_size = sizeof(int32_t);
+
+	// Events out of order
+	LV2_Atom_Sequence* const seq =
+		(LV2_Atom_Sequence*)find_atom(buf, used, forge.Sequence);
+	LV2_Atom_Event* const ev = lv2_atom_sequence_begin(&seq->body);
+	ev->time.frames = 2;
+	if (lv2_atom_validate(&validator, atom, size)) {
+		return test_fail("Validated out of order events\n");
+	}
+
+	// Events in beats are not checked
+	seq->body.unit = urid_map(NULL, LV2_ATOM__beatTime);
+	if (!lv2_atom_validate(&validator, atom, size)) {
+		return test_fail("Failed to validate sequence in beats\n");
+	}
+	ev->time.frames = 0;
+	seq->body.unit  = 0;
+
+	// Sequence too small for its header
+	const uint32_t seq_size = seq->atom.size;
+	seq->atom.size = 4;
+	if (lv2_atom_validate(&validator, atom, size)) {
+		return test_fail("Validated truncated sequence header\n");
+	}
+	seq->atom.size = seq_size;
+
+	// Nesting too deep
+	LV2_Atom_Forge_Frame frames[LV2_ATOM_VALIDATE_MAX_DEPTH + 1];
+	lv2_atom_forge_set_buffer(&forge, buf, size);
+	for (uint32_t i = 0; i <= LV2_ATOM_VALIDATE_MAX_DEPTH; ++i) {
+		lv2_atom_forge_tuple(&forge, &frames[i]);
+	}
+	for (uint32_t i = LV2_ATOM_VALIDATE_MAX_DEPTH + 1; i-- > 0;) {
+		lv2_atom_forge_pop(&forge, &frames[i]);
+	}
+	if (lv2_atom_validate(&validator, (LV2_Atom*)buf, size)) {
+		return test_fail("Validated tree nested too deeply\n");
+	} else if (!lv2_atom_validate(&validator, (LV2_Atom*)(buf + 8), size - 8)) {
+		return test_fail("Failed to validate tree at maximum depth\n");
+	}
+
+	return lv2_atom_validate(&validator, atom, size)
+		? test_fail("Validated overwritten tree\n")
+		: 0;
+}
+
+/** Write an object with the 3 property keys given, in order. */
+static LV2_Atom*
+forge_object(LV2_Atom_Forge* forge,
+             uint8_t*        buf,
+             const LV2_URID* keys,
+             int32_t         value)
+{
+	LV2_Atom_Forge_Frame frame;
+	lv2_atom_forge_set_buffer(forge, buf, 128);
+	LV2_Atom* const atom = (LV2_Atom*)lv2_atom_forge_object(
+		forge, &frame, 0, 1);
+	for (uint32_t i = 0; i < 3; ++i) {
+		lv2_atom_forge_key(forge, keys[i]);
+		lv2_atom_forge_int(forge, keys[i] == 4 ? value : (int32_t)keys[i]);
+	}
+	lv2_atom_forge_pop(forge, &frame);
+	return atom;
+}
+
+static int
+test_hash(void)
+{
+	static const LV2_URID forward[] = { 2, 3, 4 };
+	static const LV2_URID reverse[] = { 4, 3, 2 };
+
+	LV2_URID_Map   map = { NULL, urid_map };
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, &map);
+
+	uint64_t        mem[3][16];
+	LV2_Atom* const a = forge_object(&forge, (uint8_t*)mem[0], forward, 4);
+	LV2_Atom* const b = forge_object(&forge, (uint8_t*)mem[1], reverse, 4);
+	LV2_Atom* const c = forge_object(&forge, (uint8_t*)mem[2], forward, 5);
+
+	const LV2_Atom_Object* const obj_a = (const LV2_Atom_Object*)a;
+	const LV2_Atom_Object* const obj_b = (const LV2_Atom_Object*)b;
+	const LV2_Atom_Object* const obj_c = (const LV2_Atom_Object*)c;
+	if (lv2_atom_hash(a) == lv2_atom_hash(b) ||
+	    lv2_atom_hash(a) == lv2_atom_hash(c)) {
+		return test_fail("Different atoms have equal hashes\n");
+	} else if (lv2_atom_object_hash(obj_a) != lv2_atom_object_hash(obj_b)) {
+		return test_fail("Reordered objects have different hashes\n");
+	} else if (lv2_atom_object_hash(obj_a) == lv2_atom_object_hash(obj_c)) {
+		return test_fail("Different objects have equal hashes\n");
+	}
+
+	// Hashing in pieces is the same as hashing all at once
+	const uint64_t whole = lv2_atom_hash_update(
+		LV2_ATOM_HASH_SEED, a, lv2_atom_total_size(a));
+	const uint64_t split = lv2_atom_hash_update(
+		lv2_atom_hash_update(LV2_ATOM_HASH_SEED, a, 16),
+		(const uint8_t*)a + 16,
+		lv2_atom_total_size(a) - 16);
+	if (lv2_atom_hash_finish(whole) != lv2_atom_hash(a) || split != whole) {
+		return test_fail("Streaming hash differs from atom hash\n");
+	}
+
+	// A tail of zeros is not the same as no tail
+	const uint8_t  zeros[8] = { 0 };
+	const uint64_t seven    = lv2_atom_hash_update(0, zeros, 7);
+	if (seven == lv2_atom_hash_update(0, zeros, 6)) {
+		return test_fail("Tails of different length have equal hashes\n");
+	}
+
+	return 0;
+}
+
+static int
+test_store(void)
+{
+	static const LV2_URID keys[] = { 2, 3, 4 };
+
+	LV2_URID_Map   map = { NULL, urid_map };
+	LV2_Atom_Forge forge;
+	lv2_atom_forge_init(&forge, &map);
+
+	uint64_t            obj_buf[16];
+	uint64_t            store_buf[54];
+	LV2_Atom_Store_Slot slots[8];
+	LV2_Atom_Store      store;
+	lv2_atom_store_init(&store, store_buf, sizeof(store_buf), slots, 8);
+
+	// Insert 4 distinct objects twice each, leaving store buffer nearly full
+	const LV2_Atom* copies[4];
+	for (int32_t i = 0; i < 8; ++i) {
+		const LV2_Atom* const atom =
+			forge_object(&forge, (uint8_t*)obj_buf, keys, i % 4);
+		const LV2_Atom* const copy = lv2_atom_store_insert(&store, atom);
+		if (!copy || !lv2_atom_equals(copy, atom) ||
+		    lv2_atom_store_find(&store, atom) != copy) {
+			return test_fail("Failed to insert atom %d\n", i);
+		} else if (i < 4) {
+			copies[i] = copy;
+		} else if (copy != copies[i % 4]) {
+			return test_fail("Duplicate atom %d was copied\n", i);
+		}
+	}
+
+	if (store.n_atoms != 4 || store.size != 4 * 88) {
+		return test_fail("Store has %u atoms in %u bytes\n",
+		                 store.n_atoms,
+		                 (unsigned)store.size);
+	}
+
+	// Buffer is too full for another object
+	const LV2_Atom* const atom =
+		forge_object(&forge, (uint8_t*)obj_buf, keys, 4);
+	if (lv2_atom_store_find(&store, atom) ||
+	    lv2_atom_store_insert(&store, atom)) {
+		return test_fail("Inserted atom into full buffer\n");
+	}
+
+	// Table is too full for another atom after 6
+	const LV2_Atom_Int ints[] = { { { sizeof(int32_t), 100 }, 1 },
+	                              { { sizeof(int32_t), 100 }, 2 },
+	                              { { sizeof(int32_t), 100 }, 3 } };
+	if (!lv2_atom_store_insert(&store, &ints[0].atom) ||
+	    !lv2_atom_store_insert(&store, &ints[1].atom) ||
+	    lv2_atom_store_insert(&store, &ints[2].atom)) {
+		return test_fail("Inserted too many atoms into table\n");
+	}
+
+	lv2_atom_store_clear(&store);
+	if (store.n_atoms || store.size || lv2_atom_store_find(&store, atom)) {
+		return test_fail("Failed to clear store\n");
+	}
+
+	// Reordered objects are only stored once if objects are unordered
+	static const LV2_URID reverse[] = { 4, 3, 2 };
+
+	uint64_t        rev_buf[16];
+	const LV2_Atom* forward_obj =
+		forge_object(&forge, (uint8_t*)obj_buf, keys, 4);
+	const LV2_Atom* reverse_obj =
+		forge_object(&forge, (uint8_t*)rev_buf, reverse, 4);
+	if (lv2_atom_store_insert(&store, forward_obj) ==
+	    lv2_atom_store_insert(&store, reverse_obj)) {
+		return test_fail("Reordered objects stored once by default\n");
+	}
+
+	lv2_atom_store_clear(&store);
+	store.object_type = forge.Object;
+
+	const LV2_Atom* const copy = lv2_atom_store_insert(&store, forward_obj);
+	if (!copy || lv2_atom_store_insert(&store, reverse_obj) != copy ||
+	    lv2_atom_store_find(&store, reverse_obj) != copy ||
+	    store.n_atoms != 1) {
+		return test_fail("Reordered objects stored separately\n");
+	} else if (!lv2_atom_object_equals((const LV2_Atom_Object*)forward_obj,
+	                                   (const LV2_Atom_Object*)reverse_obj)) {
+		return test_fail("Reordered objects are not equal\n");
+	}
+
+	const LV2_Atom* const other =
+		forge_object(&forge, (uint8_t*)rev_buf, reverse, 5);
+	if (lv2_atom_object_equals((const LV2_Atom_Object*)forward_obj,
+	                           (const LV2_Atom_Object*)other) ||
+	    lv2_atom_store_insert(&store, other) == copy) {
+		return test_fail("Different objects are equal\n");
+	}
+
+	// Duplicate properties are counted, so {2, 2, 3} differs from {2, 3, 3}
+	static const LV2_URID twice_2[] = { 2, 2, 3 };
+	static const LV2_URID twice_3[] = { 2, 3, 3 };
+
+	const LV2_Atom* const dup_2 =
+		forge_object(&forge, (uint8_t*)obj_buf, twice_2, 4);
+	const LV2_Atom* const dup_3 =
+		forge_object(&forge, (uint8_t*)rev_buf, twice_3, 4);
+	if (lv2_atom_object_equals((const LV2_Atom_Object*)dup_2,
+	                           (const LV2_Atom_Object*)dup_3) ||
+	    lv2_atom_store_insert(&store, dup_2) ==
+	        lv2_atom_store_insert(&store, dup_3)) {
+		return test_fail("Objects with different duplicates are equal\n");
+	}
+
+	return 0;
+}
+
+int
+main(void)
+{
+	if (test_append_events() || test_append_range() || test_reserve() ||
+	    test_merge() || test_slicer() || test_index() || test_validate() ||
+	    test_hash() || test_store()) {
+		return 1;
+	}
+
+	return 0;
+}
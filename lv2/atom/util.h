@@ -32,9 +32,11 @@
 #define LV2_ATOM_UTIL_H
 
 #include "lv2/atom/atom.h"
+#include "lv2/urid/urid.h"
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -178,6 +180,594 @@ lv2_atom_sequence_append_event(LV2_Atom_Sequence*    seq,
 	return e;
 }
 
+/**
+   Reserve space for `n_events` events at the end of `sequence`.
+
+   This is useful for writing many events of the same size, such as short
+   MIDI messages, in place.  The space is checked once, and the sequence size
+   is increased to include all the new events.  The caller must then write
+   every event, each of which takes `sizeof(LV2_Atom_Event)` plus `body_size`
+   padded to 64 bits, in order, and in time order after any existing events.
+
+   @param seq Sequence to append to.
+   @param capacity Total capacity of the sequence atom
+   (e.g. as set by the host for sequence output ports).
+   @param n_events Number of events to reserve space for.
+   @param body_size Size of the body of every event.
+
+   @return A pointer to the first reserved event in `seq`,
+   or NULL on failure (insufficient space).
+*/
+static inline LV2_Atom_Event*
+lv2_atom_sequence_reserve(LV2_Atom_Sequence* seq,
+                          uint32_t           capacity,
+                          uint32_t           n_events,
+                          uint32_t           body_size)
+{
+	const uint32_t offset = lv2_atom_pad_size(seq->atom.size);
+	const uint32_t stride = (uint32_t)sizeof(LV2_Atom_Event) +
+	                        lv2_atom_pad_size(body_size);
+	if (offset > capacity || (capacity - offset) / stride < n_events) {
+		return NULL;
+	}
+
+	LV2_Atom_Event* e = lv2_atom_sequence_end(&seq->body, seq->atom.size);
+
+	seq->atom.size = offset + n_events * stride;
+
+	return e;
+}
+
+/**
+   Append several events at the end of `sequence`.
+
+   The events must be stored contiguously, in time order, as in a sequence
+   body, where each is padded to 64 bits.  This is the layout of an array of
+   structs which contain an LV2_Atom_Event followed by a fixed-size body, as
+   long as the size of the struct is a multiple of 8, which is the case with
+   most compilers since LV2_Atom_Event contains a 64-bit field.  The space is
+   checked once, and all events are copied at once.
+
+   @param seq Sequence to append to.
+   @param capacity Total capacity of the sequence atom
+   (e.g. as set by the host for sequence output ports).
+   @param events First event to write.
+   @param size Total size of all events to write, in bytes.
+
+   @return A pointer to the first newly written event in `seq`,
+   or NULL on failure (insufficient space).
+*/
+static inline LV2_Atom_Event*
+lv2_atom_sequence_append_events(LV2_Atom_Sequence*    seq,
+                                uint32_t              capacity,
+                                const LV2_Atom_Event* events,
+                                uint32_t              size)
+{
+	const uint32_t offset = lv2_atom_pad_size(seq->atom.size);
+	if (offset > capacity || capacity - offset < size) {
+		return NULL;
+	}
+
+	LV2_Atom_Event* e = lv2_atom_sequence_end(&seq->body, seq->atom.size);
+	memcpy(e, events, size);
+
+	seq->atom.size = offset + lv2_atom_pad_size(size);
+
+	return e;
+}
+
+/**
+   Append a run of events from another sequence at the end of `sequence`.
+
+   This copies every event from `begin` up to (but not including) `end`, which
+   are iterators in the same sequence, for example to forward all events in
+   some time range from an input to an output.
+
+   @param seq Sequence to append to.
+   @param capacity Total capacity of the sequence atom
+   (e.g. as set by the host for sequence output ports).
+   @param begin First event to write.
+   @param end Iterator to the end of the run of events to write.
+
+   @return A pointer to the first newly written event in `seq`,
+   or NULL on failure (insufficient space).
+*/
+static inline LV2_Atom_Event*
+lv2_atom_sequence_append_range(LV2_Atom_Sequence*    seq,
+                               uint32_t              capacity,
+                               const LV2_Atom_Event* begin,
+                               const LV2_Atom_Event* end)
+{
+	return lv2_atom_sequence_append_events(
+		seq,
+		capacity,
+		begin,
+		(uint32_t)((const uint8_t*)end - (const uint8_t*)begin));
+}
+
+/**
+   @}
+   @name Sequence Merging
+   @{
+*/
+
+/** Maximum number of sequences that can be merged at once. */
+#ifndef LV2_ATOM_MERGE_MAX_INPUTS
+#    define LV2_ATOM_MERGE_MAX_INPUTS 32
+#endif
+
+/**
+   An iterator over the events of several sequences in time order.
+
+   The iterator is a heap of input sequences, ordered by the time of their
+   next event, so the next event from any number of inputs is found in
+   logarithmic time.  Events with equal times are returned in input order, so
+   the merge is stable.  Only times in frames are supported.
+
+   The iterator is typically allocated on the stack and requires no
+   additional memory, so it can be used in the audio thread.
+*/
+typedef struct {
+	const LV2_Atom_Sequence* inputs[LV2_ATOM_MERGE_MAX_INPUTS];  /**< Inputs */
+	const LV2_Atom_Event*    iters[LV2_ATOM_MERGE_MAX_INPUTS];   /**< Heads */
+	int64_t                  times[LV2_ATOM_MERGE_MAX_INPUTS];   /**< Times */
+	uint32_t                 heap[LV2_ATOM_MERGE_MAX_INPUTS];    /**< Order */
+	uint32_t                 n_heap;  /**< Number of unfinished inputs */
+} LV2_Atom_Sequence_Merge;
+
+/** @cond */
+static inline bool
+lv2_atom_sequence_merge_before(const LV2_Atom_Sequence_Merge* merge,
+                               int64_t                        time,
+                               uint32_t                       a,
+                               uint32_t                       b)
+{
+	const int64_t t = merge->times[b];
+	return time < t || (time == t && a < b);
+}
+
+static inline void
+lv2_atom_sequence_merge_sift_down(LV2_Atom_Sequence_Merge* merge)
+{
+	uint32_t* const heap  = merge->heap;
+	const uint32_t  input = heap[0];
+	uint32_t        i     = 0;
+	for (uint32_t c = 1; c < merge->n_heap; c = 2 * i + 1) {
+		if (c + 1 < merge->n_heap &&
+		    lv2_atom_sequence_merge_before(
+			    merge, merge->times[heap[c + 1]], heap[c + 1], heap[c])) {
+			++c;
+		}
+
+		if (!lv2_atom_sequence_merge_before(
+			    merge, merge->times[heap[c]], heap[c], input)) {
+			break;
+		}
+
+		heap[i] = heap[c];
+		i       = c;
+	}
+	heap[i] = input;
+}
+
+static inline void
+lv2_atom_sequence_merge_advance(LV2_Atom_Sequence_Merge* merge,
+                                const LV2_Atom_Event*    next)
+{
+	const uint32_t                 input = merge->heap[0];
+	const LV2_Atom_Sequence* const seq   = merge->inputs[input];
+
+	merge->iters[input] = next;
+	if (lv2_atom_sequence_is_end(&seq->body, seq->atom.size, next)) {
+		merge->heap[0] = merge->heap[--merge->n_heap];
+	} else {
+		merge->times[input] = next->time.frames;
+	}
+
+	if (merge->n_heap) {
+		lv2_atom_sequence_merge_sift_down(merge);
+	}
+}
+/** @endcond */
+
+/**
+   Initialise a merge iterator.
+
+   @param merge The iterator to initialise.
+   @param inputs Sequences to merge, which must remain valid while iterating.
+   @param n_inputs Number of elements in `inputs`.
+
+   @return False if there are more than LV2_ATOM_MERGE_MAX_INPUTS inputs.
+*/
+static inline bool
+lv2_atom_sequence_merge_init(LV2_Atom_Sequence_Merge*        merge,
+                             const LV2_Atom_Sequence* const* inputs,
+                             uint32_t                        n_inputs)
+{
+	merge->n_heap = 0;
+	if (n_inputs > LV2_ATOM_MERGE_MAX_INPUTS) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < n_inputs; ++i) {
+		const LV2_Atom_Sequence* const seq = inputs[i];
+		const LV2_Atom_Event* const    ev = lv2_atom_sequence_begin(&seq->body);
+
+		merge->inputs[i] = seq;
+		merge->iters[i]  = ev;
+		if (lv2_atom_sequence_is_end(&seq->body, seq->atom.size, ev)) {
+			continue;
+		}
+
+		merge->times[i] = ev->time.frames;
+
+		// Sift the new input up to its place in the heap
+		uint32_t h = merge->n_heap++;
+		while (h > 0) {
+			const uint32_t parent = (h - 1) / 2;
+			if (!lv2_atom_sequence_merge_before(
+				    merge, ev->time.frames, i, merge->heap[parent])) {
+				break;
+			}
+			merge->heap[h] = merge->heap[parent];
+			h              = parent;
+		}
+		merge->heap[h] = i;
+	}
+
+	return true;
+}
+
+/**
+   Return the next event in time order and advance the iterator.
+
+   @param merge The iterator.
+   @param input If not NULL, set to the index of the input the event is from.
+
+   @return The next event, or NULL if all inputs are finished.
+*/
+static inline const LV2_Atom_Event*
+lv2_atom_sequence_merge_next(LV2_Atom_Sequence_Merge* merge, uint32_t* input)
+{
+	if (!merge->n_heap) {
+		return NULL;
+	}
+
+	const uint32_t              i  = merge->heap[0];
+	const LV2_Atom_Event* const ev = merge->iters[i];
+	if (input) {
+		*input = i;
+	}
+
+	lv2_atom_sequence_merge_advance(merge, lv2_atom_sequence_next(ev));
+	return ev;
+}
+
+/**
+   Merge several sequences into one in time order.
+
+   The events from all inputs are appended to `seq`, which must already have
+   a header, for example written with lv2_atom_sequence_clear().  Events with
+   equal times are written in input order.  Consecutive events from the same
+   input are copied at once, so this is efficient when events from different
+   inputs are not interleaved too finely.
+
+   @param seq Sequence to append to.
+   @param capacity Total capacity of the sequence atom
+   (e.g. as set by the host for sequence output ports).
+   @param inputs Sequences to merge.
+   @param n_inputs Number of elements in `inputs`, at most
+   LV2_ATOM_MERGE_MAX_INPUTS.
+
+   @return True on success, or false if there are too many inputs, or the
+   events did not fit in `seq` (in which case it contains only the first of
+   the merged events).
+*/
+static inline bool
+lv2_atom_sequence_merge(LV2_Atom_Sequence*              seq,
+                        uint32_t                        capacity,
+                        const LV2_Atom_Sequence* const* inputs,
+                        uint32_t                        n_inputs)
+{
+	LV2_Atom_Sequence_Merge merge;
+	if (!lv2_atom_sequence_merge_init(&merge, inputs, n_inputs)) {
+		return false;
+	}
+
+	while (merge.n_heap) {
+		const uint32_t                 i     = merge.heap[0];
+		const LV2_Atom_Sequence* const in    = merge.inputs[i];
+		const LV2_Atom_Event* const    begin = merge.iters[i];
+
+		// Find the input with the next event after this one, if any
+		uint32_t next = i;
+		if (merge.n_heap > 1) {
+			next = merge.heap[1];
+			if (merge.n_heap > 2 &&
+			    lv2_atom_sequence_merge_before(
+				    &merge, merge.times[merge.heap[2]], merge.heap[2], next)) {
+				next = merge.heap[2];
+			}
+		}
+
+		// Find the end of the run of events from this input before that
+		const LV2_Atom_Event* end = begin;
+		do {
+			end = lv2_atom_sequence_next(end);
+		} while (!lv2_atom_sequence_is_end(&in->body, in->atom.size, end) &&
+		         (next == i ||
+		          lv2_atom_sequence_merge_before(
+			          &merge, end->time.frames, i, next)));
+
+		// Copy the run and move past it
+		if (!lv2_atom_sequence_append_range(seq, capacity, begin, end)) {
+			return false;
+		}
+
+		lv2_atom_sequence_merge_advance(&merge, end);
+	}
+
+	return true;
+}
+
+/**
+   @}
+   @name Sequence Index
+   @{
+*/
+
+/**
+   An index of the events in a sequence, for random access.
+
+   Finding an event in a sequence normally requires iterating from the start,
+   since events have variable sizes.  The index is an array of the offsets of
+   every event from the start of the sequence body, which allows the events
+   to be accessed by number, and searched by time, in logarithmic time.  The
+   offsets are stored in memory provided by the caller, 4 bytes per event.
+
+   Since all the events between two indices are stored contiguously, an index
+   can also be used to split a long sequence into ranges to be processed
+   separately, for example in parallel.  The index is only valid while the
+   sequence is not modified.
+*/
+typedef struct {
+	const LV2_Atom_Sequence* seq;       /**< Indexed sequence */
+	uint32_t*                offsets;   /**< Offsets of events from body */
+	uint32_t                 n_events;  /**< Number of events in sequence */
+} LV2_Atom_Sequence_Index;
+
+/** Return the number of events in `seq`. */
+static inline uint32_t
+lv2_atom_sequence_count(const LV2_Atom_Sequence* seq)
+{
+	uint32_t n = 0;
+	LV2_ATOM_SEQUENCE_FOREACH(seq, ev) {
+		++n;
+	}
+
+	return n;
+}
+
+/**
+   Build an index of a sequence.
+
+   @param index The index to initialise.
+   @param seq The sequence to index.
+   @param offsets Storage for event offsets.
+   @param capacity Number of elements in `offsets`, which must be at least the
+   number of events in the sequence, as returned by lv2_atom_sequence_count().
+
+   @return False if there are more than `capacity` events, in which case the
+   index contains only the first `capacity` events.
+*/
+static inline bool
+lv2_atom_sequence_index_init(LV2_Atom_Sequence_Index* index,
+                             const LV2_Atom_Sequence* seq,
+                             uint32_t*                offsets,
+                             uint32_t                 capacity)
+{
+	const uint8_t* const body = (const uint8_t*)&seq->body;
+
+	index->seq      = seq;
+	index->offsets  = offsets;
+	index->n_events = 0;
+	LV2_ATOM_SEQUENCE_FOREACH(seq, ev) {
+		if (index->n_events == capacity) {
+			return false;
+		}
+
+		offsets[index->n_events++] = (uint32_t)((const uint8_t*)ev - body);
+	}
+
+	return true;
+}
+
+/**
+   Return the event at position `i` in an indexed sequence.
+
+   If `i` is the number of events, an iterator to the end of the sequence is
+   returned, so any range of events can be described by two positions.
+*/
+static inline LV2_Atom_Event*
+lv2_atom_sequence_index_get(const LV2_Atom_Sequence_Index* index, uint32_t i)
+{
+	const LV2_Atom_Sequence_Body* const body = &index->seq->body;
+	if (i >= index->n_events) {
+		return lv2_atom_sequence_end(body, index->seq->atom.size);
+	}
+
+	return (LV2_Atom_Event*)((const uint8_t*)body + index->offsets[i]);
+}
+
+/**
+   Return the position of the first event at or after `frames`.
+
+   The events must be in time order with times in frames, as in any valid
+   sequence.  If every event is before `frames`, the number of events is
+   returned.
+*/
+static inline uint32_t
+lv2_atom_sequence_index_find(const LV2_Atom_Sequence_Index* index,
+                             int64_t                        frames)
+{
+	uint32_t first = 0;
+	uint32_t count = index->n_events;
+	while (count > 0) {
+		const uint32_t half = count / 2;
+		const uint32_t mid  = first + half;
+		if (lv2_atom_sequence_index_get(index, mid)->time.frames < frames) {
+			first = mid + 1;
+			count -= half + 1;
+		} else {
+			count = half;
+		}
+	}
+
+	return first;
+}
+
+/**
+   @}
+   @name Sequence Slicing
+   @{
+*/
+
+/**
+   A slice of a block, which is processed before the events at its end.
+
+   Plugins that process audio with sample accuracy render the block in slices
+   between events.  A slice is the range of frames [start, end), followed by
+   the events from `begin` up to (but not including) `events_end`, which
+   should all be handled at time `end`.
+*/
+typedef struct {
+	uint32_t        start;       /**< First frame of slice */
+	uint32_t        end;         /**< End of slice, and time of events */
+	LV2_Atom_Event* begin;       /**< First event at end of slice */
+	LV2_Atom_Event* events_end;  /**< Iterator past last event */
+} LV2_Atom_Sequence_Slice;
+
+/**
+   An iterator that splits a block into slices between events.
+
+   Events less than `min_span` frames after an event are handled together
+   with it, at the time of the first, so no slice between events is shorter
+   than `min_span` (only the first and last, which start and end at the block
+   boundaries, may be).  This keeps processing efficient under dense
+   automation, at the cost of handling some events slightly early.  With a
+   `min_span` of 0 or 1, only events with equal times are coalesced.
+*/
+typedef struct {
+	const LV2_Atom_Sequence* seq;       /**< Sequence of events */
+	LV2_Atom_Event*          iter;      /**< Next event to be handled */
+	uint32_t                 n_frames;  /**< Length of block */
+	uint32_t                 min_span;  /**< Minimum distance between slices */
+	uint32_t                 start;     /**< Start of next slice */
+	bool                     done;      /**< True after the last slice */
+} LV2_Atom_Sequence_Slicer;
+
+/** @cond */
+static inline uint32_t
+lv2_atom_sequence_slicer_time(const LV2_Atom_Sequence_Slicer* slicer,
+                              const LV2_Atom_Event*           ev)
+{
+	// Clamp times to the block, in case they are out of order or bounds
+	if (ev->time.frames < (int64_t)slicer->start) {
+		return slicer->start;
+	} else if (ev->time.frames > (int64_t)slicer->n_frames) {
+		return slicer->n_frames;
+	}
+
+	return (uint32_t)ev->time.frames;
+}
+/** @endcond */
+
+/**
+   Initialise a slicer to iterate over a block.
+
+   @param slicer The iterator to initialise.
+   @param seq Events in the block, with times in frames.
+   @param n_frames Length of block in frames.
+   @param min_span Minimum length in frames of slices between events.
+*/
+static inline void
+lv2_atom_sequence_slicer_init(LV2_Atom_Sequence_Slicer* slicer,
+                              const LV2_Atom_Sequence*  seq,
+                              uint32_t                  n_frames,
+                              uint32_t                  min_span)
+{
+	slicer->seq      = seq;
+	slicer->iter     = lv2_atom_sequence_begin(&seq->body);
+	slicer->n_frames = n_frames;
+	slicer->min_span = min_span;
+	slicer->start    = 0;
+	slicer->done     = false;
+}
+
+/**
+   Get the next slice of the block.
+
+   Every frame of the block is in exactly one slice, and the last slice,
+   which ends at the end of the block, has no events.
+
+   @return True if a slice was written to `slice`, or false if the whole
+   block has been sliced.
+*/
+static inline bool
+lv2_atom_sequence_slicer_next(LV2_Atom_Sequence_Slicer* slicer,
+                              LV2_Atom_Sequence_Slice*  slice)
+{
+	const LV2_Atom_Sequence* const seq = slicer->seq;
+	if (slicer->done) {
+		return false;
+	}
+
+	slice->start = slicer->start;
+	slice->begin = slicer->iter;
+	if (lv2_atom_sequence_is_end(&seq->body, seq->atom.size, slicer->iter)) {
+		// No events left, final slice to the end of the block
+		slice->end        = slicer->n_frames;
+		slice->events_end = slicer->iter;
+		slicer->done      = true;
+		return true;
+	}
+
+	// End slice at the first event, and take any others within the span
+	const uint32_t time = lv2_atom_sequence_slicer_time(slicer, slicer->iter);
+	const uint32_t span = slicer->min_span ? slicer->min_span : 1;
+	const uint64_t end  = (uint64_t)time + span;
+	do {
+		slicer->iter = lv2_atom_sequence_next(slicer->iter);
+	} while (
+		!lv2_atom_sequence_is_end(&seq->body, seq->atom.size, slicer->iter) &&
+		lv2_atom_sequence_slicer_time(slicer, slicer->iter) < end);
+
+	slice->end        = time;
+	slice->events_end = slicer->iter;
+	slicer->start     = time;
+	return true;
+}
+
+/**
+   A macro for iterating over the events at the end of a slice.
+
+   @code
+   LV2_Atom_Sequence_Slicer slicer;
+   LV2_Atom_Sequence_Slice  slice;
+   lv2_atom_sequence_slicer_init(&slicer, sequence, n_frames, 16);
+   while (lv2_atom_sequence_slicer_next(&slicer, &slice)) {
+       // Process frames from slice.start to slice.end here...
+       LV2_ATOM_SLICE_FOREACH(&slice, ev) {
+           // Do something with ev (an LV2_Atom_Event*) here...
+       }
+   }
+   @endcode
+*/
+#define LV2_ATOM_SLICE_FOREACH(slice, iter) \
+	for (LV2_Atom_Event* (iter) = (slice)->begin; \
+	     (iter) != (slice)->events_end; \
+	     (iter) = lv2_atom_sequence_next(iter))
+
 /**
    @}
    @name Tuple Iterator
@@ -497,6 +1087,519 @@ lv2_atom_object_get_typed(const LV2_Atom_Object* object, ...)
 	return matches;
 }
 
+/**
+   @}
+   @name Validation
+   @{
+*/
+
+/** Maximum nesting depth of containers accepted by lv2_atom_validate(). */
+#ifndef LV2_ATOM_VALIDATE_MAX_DEPTH
+#    define LV2_ATOM_VALIDATE_MAX_DEPTH 32
+#endif
+
+/**
+   URIDs of the types checked by lv2_atom_validate().
+*/
+typedef struct {
+	LV2_URID atom_Blank;
+	LV2_URID atom_Object;
+	LV2_URID atom_Resource;
+	LV2_URID atom_Sequence;
+	LV2_URID atom_Tuple;
+	LV2_URID atom_Vector;
+	LV2_URID atom_frameTime;
+} LV2_Atom_Validator;
+
+/** Initialise a validator, mapping the URIs of the types it checks. */
+static inline void
+lv2_atom_validator_init(LV2_Atom_Validator* validator, LV2_URID_Map* map)
+{
+	validator->atom_Blank     = map->map(map->handle, LV2_ATOM__Blank);
+	validator->atom_Object    = map->map(map->handle, LV2_ATOM__Object);
+	validator->atom_Resource  = map->map(map->handle, LV2_ATOM__Resource);
+	validator->atom_Sequence  = map->map(map->handle, LV2_ATOM__Sequence);
+	validator->atom_Tuple     = map->map(map->handle, LV2_ATOM__Tuple);
+	validator->atom_Vector    = map->map(map->handle, LV2_ATOM__Vector);
+	validator->atom_frameTime = map->map(map->handle, LV2_ATOM__frameTime);
+}
+
+/** @cond */
+typedef enum {
+	LV2_ATOM_VALIDATE_TUPLE,
+	LV2_ATOM_VALIDATE_OBJECT,
+	LV2_ATOM_VALIDATE_SEQUENCE,
+	LV2_ATOM_VALIDATE_FRAMES
+} LV2_Atom_Validate_Kind;
+
+typedef struct {
+	const uint8_t*         end;   // End of container body
+	const uint8_t*         next;  // Start of next atom after container
+	LV2_Atom_Validate_Kind kind;  // Kind of children
+	int64_t                last;  // Time of previous event in frames
+} LV2_Atom_Validate_Frame;
+/** @endcond */
+
+/**
+   Check that an atom and everything inside it is well-formed.
+
+   This checks the structure of the atom, so that it can be safely read with
+   the iterators in this header, for example LV2_ATOM_OBJECT_FOREACH(),
+   without any further checks.  The atom must be 64-bit aligned, and every
+   atom it contains, recursively through objects, tuples, and sequences, must
+   fit within its container, which must fit within `size`.  Object and
+   sequence bodies must be large enough for their headers, vector bodies must
+   be a whole number of elements, and events in sequences with times in frames
+   must be in time order.  The contents of other types, like strings, are not
+   checked.
+
+   The atom is checked in a single linear pass, without recursion, so the
+   time taken is proportional to its size, and the stack used is constant.
+   Containers may be nested at most LV2_ATOM_VALIDATE_MAX_DEPTH deep.
+
+   @param validator Validator with mapped type URIDs.
+   @param atom Atom to check.
+   @param size Size of the buffer that contains `atom`, in bytes.
+
+   @return True iff the atom is well-formed.
+*/
+static inline bool
+lv2_atom_validate(const LV2_Atom_Validator* validator,
+                  const LV2_Atom*           atom,
+                  size_t                    size)
+{
+	LV2_Atom_Validate_Frame stack[LV2_ATOM_VALIDATE_MAX_DEPTH];
+	uint32_t                depth = 0;
+
+	if ((uintptr_t)atom % 8 || size < sizeof(LV2_Atom) ||
+	    atom->size > size - sizeof(LV2_Atom)) {
+		return false;
+	}
+
+	// Innermost container, kept in locals since it is accessed for every atom
+	const uint8_t*         end   = NULL;
+	const uint8_t*         after = NULL;
+	LV2_Atom_Validate_Kind kind  = LV2_ATOM_VALIDATE_TUPLE;
+	int64_t                last  = INT64_MIN;
+
+	const uint8_t* p = NULL;
+	for (;;) {
+		// Check this atom, which is known to fit in its container
+		const uint32_t       type   = atom->type;
+		const size_t         padded = ((size_t)atom->size + 7U) & ~(size_t)7U;
+		const uint8_t* const body   = (const uint8_t*)(atom + 1);
+		const uint8_t* const next   = body + padded;
+		if (type == validator->atom_Tuple ||
+		    type == validator->atom_Object ||
+		    type == validator->atom_Blank ||
+		    type == validator->atom_Resource ||
+		    type == validator->atom_Sequence) {
+			if (depth == LV2_ATOM_VALIDATE_MAX_DEPTH) {
+				return false;
+			}
+
+			// Enter container, children start after any body header
+			LV2_Atom_Validate_Frame* const parent = &stack[depth++];
+			parent->end  = end;
+			parent->next = after;
+			parent->kind = kind;
+			parent->last = last;
+
+			end   = body + atom->size;
+			after = next;
+			last  = INT64_MIN;
+			if (type == validator->atom_Tuple) {
+				kind = LV2_ATOM_VALIDATE_TUPLE;
+				p    = body;
+			} else if (type == validator->atom_Sequence) {
+				const LV2_Atom_Sequence_Body* const seq =
+					(const LV2_Atom_Sequence_Body*)body;
+				if (atom->size < sizeof(LV2_Atom_Sequence_Body)) {
+					return false;
+				}
+
+				kind = (seq->unit == 0 ||
+				        seq->unit == validator->atom_frameTime)
+					? LV2_ATOM_VALIDATE_FRAMES
+					: LV2_ATOM_VALIDATE_SEQUENCE;
+				p = body + sizeof(LV2_Atom_Sequence_Body);
+			} else {
+				if (atom->size < sizeof(LV2_Atom_Object_Body)) {
+					return false;
+				}
+
+				kind = LV2_ATOM_VALIDATE_OBJECT;
+				p    = body + sizeof(LV2_Atom_Object_Body);
+			}
+		} else {
+			if (type == validator->atom_Vector) {
+				const LV2_Atom_Vector_Body* const vec =
+					(const LV2_Atom_Vector_Body*)body;
+				const uint32_t n_bytes = atom->size - (uint32_t)sizeof(*vec);
+				if (atom->size < sizeof(LV2_Atom_Vector_Body) ||
+				    (vec->child_size ? n_bytes % vec->child_size : n_bytes)) {
+					return false;
+				}
+			}
+
+			// Move to the next atom after this one
+			p = next;
+		}
+
+		// Leave any containers that have ended
+		while (p >= end) {
+			if (depth <= 1) {
+				return true;
+			}
+
+			const LV2_Atom_Validate_Frame* const parent = &stack[--depth];
+			p     = after;
+			end   = parent->end;
+			after = parent->next;
+			kind  = parent->kind;
+			last  = parent->last;
+		}
+
+		// Find the next atom in the current container, checking it fits
+		const size_t space  = (size_t)(end - p);
+		const size_t offset = (kind == LV2_ATOM_VALIDATE_TUPLE) ? 0U : 8U;
+		atom                = (const LV2_Atom*)(p + offset);
+		if (space < offset + sizeof(LV2_Atom) ||
+		    atom->size > space - offset - sizeof(LV2_Atom)) {
+			return false;
+		}
+
+		if (kind == LV2_ATOM_VALIDATE_FRAMES) {
+			const int64_t time = ((const LV2_Atom_Event*)p)->time.frames;
+			if (time < last) {
+				return false;
+			}
+			last = time;
+		}
+	}
+}
+
+/**
+   @}
+   @name Hashing
+   @{
+*/
+
+/** Initial state for lv2_atom_hash_update(). */
+#define LV2_ATOM_HASH_SEED 0x6C76322D61746F6DULL
+
+/** @cond */
+static inline uint64_t
+lv2_atom_hash_rotl(uint64_t x, unsigned n)
+{
+	return (x << n) | (x >> (64U - n));
+}
+
+static inline uint64_t
+lv2_atom_hash_mix(uint64_t hash, uint64_t word)
+{
+	word *= 0x87C37B91114253D5ULL;
+	word = lv2_atom_hash_rotl(word, 31);
+	word *= 0x4CF5AD432745937FULL;
+	hash ^= word;
+	return lv2_atom_hash_rotl(hash, 27) * 5U + 0x52DCE729U;
+}
+/** @endcond */
+
+/**
+   Add `size` bytes of `data` to a hash.
+
+   This mixes 64-bit words, so a hash can be built up over several calls, but
+   the result is only the same as hashing all the data at once if every call
+   but the last has a multiple of 8 bytes.  This is always the case for atoms
+   and their padded bodies.  The state should start with LV2_ATOM_HASH_SEED,
+   and be finished with lv2_atom_hash_finish().
+
+   Hashes depend on the byte order of the platform, so they should only be
+   used in memory, not stored or sent elsewhere.
+*/
+static inline uint64_t
+lv2_atom_hash_update(uint64_t hash, const void* data, size_t size)
+{
+	const uint8_t* p = (const uint8_t*)data;
+	for (; size >= 8; size -= 8, p += 8) {
+		uint64_t word = 0;
+		memcpy(&word, p, 8);
+		hash = lv2_atom_hash_mix(hash, word);
+	}
+
+	if (size > 0) {
+		// Put the length of the tail in the top byte, which it never reaches
+		uint64_t word = (uint64_t)size << 56U;
+		for (size_t i = 0; i < size; ++i) {
+			word |= (uint64_t)p[i] << (8U * i);
+		}
+		hash = lv2_atom_hash_mix(hash, word);
+	}
+
+	return hash;
+}
+
+/** Finish a hash built with lv2_atom_hash_update(), mixing all its bits. */
+static inline uint64_t
+lv2_atom_hash_finish(uint64_t hash)
+{
+	hash ^= hash >> 33U;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33U;
+	hash *= 0xC4CEB9FE1A85EC53ULL;
+	hash ^= hash >> 33U;
+	return hash;
+}
+
+/**
+   Return a hash of the type, size, and body of `atom`.
+
+   Atoms that are equal according to lv2_atom_equals() have equal hashes.
+*/
+static inline uint64_t
+lv2_atom_hash(const LV2_Atom* atom)
+{
+	return lv2_atom_hash_finish(
+		lv2_atom_hash_update(
+			LV2_ATOM_HASH_SEED, atom, sizeof(LV2_Atom) + atom->size));
+}
+
+/**
+   Return a hash of `object` which does not depend on the order of properties.
+
+   Objects with the same type, id, and properties have equal hashes, even if
+   the properties were written in a different order, which lv2_atom_hash()
+   does not allow for.  Property values are hashed with lv2_atom_hash(), so
+   the order of properties in nested objects does matter.
+*/
+static inline uint64_t
+lv2_atom_object_hash(const LV2_Atom_Object* object)
+{
+	// Properties are combined by addition, which is commutative
+	uint64_t sum = 0;
+	LV2_ATOM_OBJECT_FOREACH(object, prop) {
+		const uint64_t value = lv2_atom_hash(&prop->value);
+		sum += lv2_atom_hash_finish(
+			lv2_atom_hash_update(value, prop, sizeof(uint32_t) * 2));
+	}
+
+	const uint64_t head = lv2_atom_hash_update(
+		LV2_ATOM_HASH_SEED,
+		object,
+		sizeof(LV2_Atom) + sizeof(LV2_Atom_Object_Body));
+
+	return lv2_atom_hash_finish(lv2_atom_hash_mix(head, sum));
+}
+
+/** @cond */
+static inline uint32_t
+lv2_atom_object_count_property(const LV2_Atom_Object*       object,
+                               const LV2_Atom_Property_Body* prop)
+{
+	uint32_t n = 0;
+	LV2_ATOM_OBJECT_FOREACH(object, p) {
+		if (p->key == prop->key && p->context == prop->context &&
+		    lv2_atom_equals(&p->value, &prop->value)) {
+			++n;
+		}
+	}
+
+	return n;
+}
+/** @endcond */
+
+/**
+   Return true iff `a` and `b` have the same type, id, and properties.
+
+   Properties are compared as a multiset, so a property that appears several
+   times must appear the same number of times in both.
+
+   Unlike lv2_atom_equals(), this does not depend on the order of properties,
+   so objects that are equal have equal lv2_atom_object_hash() values.  Like
+   that hash, property values are compared byte-wise, so the order of
+   properties in nested objects does matter.  This takes time quadratic in
+   the number of properties, so is best suited to small objects.
+*/
+static inline bool
+lv2_atom_object_equals(const LV2_Atom_Object* a, const LV2_Atom_Object* b)
+{
+	if (a == b) {
+		return true;
+	} else if (a->atom.type != b->atom.type || a->atom.size != b->atom.size ||
+	           a->body.id != b->body.id || a->body.otype != b->body.otype) {
+		return false;
+	}
+
+	/* Every property of `a` occurs as often in `b`, and since both are the
+	   same size, `b` can not have any other properties. */
+	LV2_ATOM_OBJECT_FOREACH(a, p) {
+		if (lv2_atom_object_count_property(a, p) !=
+		    lv2_atom_object_count_property(b, p)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+   @}
+   @name Atom Store
+   @{
+*/
+
+/** @cond */
+typedef struct {
+	uint64_t        hash;
+	const LV2_Atom* atom;
+} LV2_Atom_Store_Slot;
+/** @endcond */
+
+/**
+   A store of atoms without duplicates.
+
+   Every atom inserted into the store is copied into a buffer, unless an equal
+   atom is already there, in which case the existing copy is used instead.
+   This can be used to share atoms that are often repeated, like the same
+   patch:Set message or preset value, so that they can be compared by pointer
+   and used as keys.  Atoms are found with a hash table of lv2_atom_hash()
+   values.  Both the buffer and the table are provided by the caller, so
+   inserting into a store never allocates.
+
+   By default, atoms are compared byte-wise with lv2_atom_equals(), so objects
+   with the same properties in a different order are stored separately.  To
+   store them once, set `object_type` to the URID of atom:Object after the
+   store is initialised, and objects of that type are hashed with
+   lv2_atom_object_hash() and compared with lv2_atom_object_equals().
+*/
+typedef struct {
+	uint8_t*             buf;          /**< Storage for atoms, 64-bit aligned */
+	size_t               capacity;     /**< Size of `buf` in bytes */
+	size_t               size;         /**< Number of bytes used in `buf` */
+	LV2_Atom_Store_Slot* slots;        /**< Hash table */
+	uint32_t             n_slots;      /**< Size of table, a power of two */
+	uint32_t             n_atoms;      /**< Number of atoms in store */
+	LV2_URID             object_type;  /**< Type of unordered objects, or 0 */
+} LV2_Atom_Store;
+
+/** Remove all atoms from a store. */
+static inline void
+lv2_atom_store_clear(LV2_Atom_Store* store)
+{
+	memset(store->slots, 0, store->n_slots * sizeof(LV2_Atom_Store_Slot));
+	store->size    = 0;
+	store->n_atoms = 0;
+}
+
+/**
+   Initialise an empty store.
+
+   @param store The store to initialise.
+   @param buf Storage for atoms, which must be 64-bit aligned.
+   @param capacity Size of `buf` in bytes.
+   @param slots Storage for the hash table.
+   @param n_slots Number of elements in `slots`, which must be a power of two.
+   At most three quarters of this many atoms can be stored.
+*/
+static inline void
+lv2_atom_store_init(LV2_Atom_Store*      store,
+                    void*                buf,
+                    size_t               capacity,
+                    LV2_Atom_Store_Slot* slots,
+                    uint32_t             n_slots)
+{
+	store->buf         = (uint8_t*)buf;
+	store->capacity    = capacity;
+	store->slots       = slots;
+	store->n_slots     = n_slots;
+	store->object_type = 0;
+	lv2_atom_store_clear(store);
+}
+
+/** @cond */
+static inline bool
+lv2_atom_store_is_unordered(const LV2_Atom_Store* store, const LV2_Atom* atom)
+{
+	return store->object_type && atom->type == store->object_type;
+}
+
+static inline uint64_t
+lv2_atom_store_hash(const LV2_Atom_Store* store, const LV2_Atom* atom)
+{
+	return lv2_atom_store_is_unordered(store, atom)
+		? lv2_atom_object_hash((const LV2_Atom_Object*)atom)
+		: lv2_atom_hash(atom);
+}
+
+static inline bool
+lv2_atom_store_equals(const LV2_Atom_Store* store,
+                      const LV2_Atom*       a,
+                      const LV2_Atom*       b)
+{
+	return lv2_atom_store_is_unordered(store, a)
+		? lv2_atom_object_equals((const LV2_Atom_Object*)a,
+		                         (const LV2_Atom_Object*)b)
+		: lv2_atom_equals(a, b);
+}
+
+static inline LV2_Atom_Store_Slot*
+lv2_atom_store_slot(const LV2_Atom_Store* store,
+                    const LV2_Atom*       atom,
+                    uint64_t              hash)
+{
+	const uint32_t mask = store->n_slots - 1U;
+	for (uint32_t i = (uint32_t)hash & mask;; i = (i + 1U) & mask) {
+		LV2_Atom_Store_Slot* const slot = &store->slots[i];
+		if (!slot->atom || (slot->hash == hash &&
+		                    lv2_atom_store_equals(store, slot->atom, atom))) {
+			return slot;
+		}
+	}
+}
+/** @endcond */
+
+/** Return the copy of `atom` in `store`, or NULL if there is none. */
+static inline const LV2_Atom*
+lv2_atom_store_find(const LV2_Atom_Store* store, const LV2_Atom* atom)
+{
+	return lv2_atom_store_slot(
+		store, atom, lv2_atom_store_hash(store, atom))->atom;
+}
+
+/**
+   Insert `atom` into `store` if it is not already there.
+
+   @return The copy of `atom` in the store, which is the same for any equal
+   atom, or NULL if the store is full.
+*/
+static inline const LV2_Atom*
+lv2_atom_store_insert(LV2_Atom_Store* store, const LV2_Atom* atom)
+{
+	const uint64_t             hash = lv2_atom_store_hash(store, atom);
+	LV2_Atom_Store_Slot* const slot = lv2_atom_store_slot(store, atom, hash);
+	if (slot->atom) {
+		return slot->atom;
+	}
+
+	// Keep at least a quarter of the table empty so probes stay short
+	const uint32_t max_atoms = store->n_slots - (store->n_slots + 3U) / 4U;
+	const size_t   total     = lv2_atom_pad_size(lv2_atom_total_size(atom));
+	if (store->n_atoms >= max_atoms ||
+	    total > store->capacity - store->size) {
+		return NULL;
+	}
+
+	LV2_Atom* const copy = (LV2_Atom*)(store->buf + store->size);
+	memcpy(copy, atom, lv2_atom_total_size(atom));
+	store->size += total;
+	++store->n_atoms;
+
+	slot->hash = hash;
+	slot->atom = copy;
+	return copy;
+}
+
 /**
    @}
    @}
@@ -0,0 +1,235 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark for validating atoms.
+
+   Builds a large sequence of events, each an object with a few properties
+   including a tuple and a vector, like a stream of patch messages.  The whole
+   sequence is then checked with lv2_atom_validate(), and by a recursive walk
+   which checks sizes at every step of iteration, as code which does not trust
+   its input must, but with stack use that depends on the input.  An unchecked
+   walk with the FOREACH macros, as is safe after validation, is included for
+   reference.  Results are printed as tab-separated lines of name, size in
+   bytes, and MB/s.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/forge.h"
+#include "lv2/atom/util.h"
+#include "lv2/urid/urid.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define N_EVENTS  65536
+#define N_REPEATS 20
+#define CAPACITY  (N_EVENTS * 160)
+
+static const char* const uris[] = {
+	LV2_ATOM__Blank, LV2_ATOM__Float,    LV2_ATOM__Int,      LV2_ATOM__Object,
+	LV2_ATOM__Resource, LV2_ATOM__Sequence, LV2_ATOM__Tuple, LV2_ATOM__Vector,
+	LV2_ATOM__frameTime };
+
+static LV2_URID
+urid_map(LV2_URID_Map_Handle handle, const char* uri)
+{
+	(void)handle;
+	for (uint32_t i = 0; i < sizeof(uris) / sizeof(uris[0]); ++i) {
+		if (!strcmp(uri, uris[i])) {
+			return 1 + i;
+		}
+	}
+
+	return 100;
+}
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/** Write a sequence of objects to `buf`. */
+static LV2_Atom*
+make_sequence(LV2_Atom_Forge* forge, uint8_t* buf)
+{
+	const float elems[] = { 0.0f, 0.25f, 0.5f, 0.75f };
+
+	LV2_Atom_Forge_Frame seq_frame;
+	lv2_atom_forge_set_buffer(forge, buf, CAPACITY);
+	lv2_atom_forge_sequence_head(forge, &seq_frame, 0);
+	for (uint32_t i = 0; i < N_EVENTS; ++i) {
+		LV2_Atom_Forge_Frame obj_frame;
+		LV2_Atom_Forge_Frame tup_frame;
+		lv2_atom_forge_frame_time(forge, i / 8);
+		lv2_atom_forge_object(forge, &obj_frame, 0, 200);
+		lv2_atom_forge_key(forge, 201);
+		lv2_atom_forge_float(forge, (float)i);
+		lv2_atom_forge_key(forge, 202);
+		lv2_atom_forge_tuple(forge, &tup_frame);
+		lv2_atom_forge_int(forge, (int32_t)i);
+		lv2_atom_forge_float(forge, 1.0f);
+		lv2_atom_forge_pop(forge, &tup_frame);
+		lv2_atom_forge_key(forge, 203);
+		lv2_atom_forge_vector(forge, sizeof(float), forge->Float, 4, elems);
+		lv2_atom_forge_pop(forge, &obj_frame);
+	}
+	lv2_atom_forge_pop(forge, &seq_frame);
+
+	return (LV2_Atom*)buf;
+}
+
+/** Check `atom` by iterating over it, checking every size along the way. */
+static bool
+walk_checked(const LV2_Atom_Validator* v, const LV2_Atom* atom, uint32_t size)
+{
+	if (size < sizeof(LV2_Atom) || atom->size > size - sizeof(LV2_Atom)) {
+		return false;
+	}
+
+	const uint8_t* const body = (const uint8_t*)(atom + 1);
+	const uint8_t* const end  = body + atom->size;
+	if (atom->type == v->atom_Sequence) {
+		if (atom->size < sizeof(LV2_Atom_Sequence_Body)) {
+			return false;
+		}
+
+		int64_t last = INT64_MIN;
+		for (const uint8_t* p = body + sizeof(LV2_Atom_Sequence_Body);
+		     p < end;) {
+			const LV2_Atom_Event* ev = (const LV2_Atom_Event*)p;
+			if ((size_t)(end - p) < sizeof(LV2_Atom_Event) ||
+			    ev->time.frames < last ||
+			    !walk_checked(v, &ev->body, (uint32_t)(end - p - 8))) {
+				return false;
+			}
+			last = ev->time.frames;
+			p += sizeof(int64_t) + lv2_atom_pad_size(
+				sizeof(LV2_Atom) + ev->body.size);
+		}
+	} else if (atom->type == v->atom_Tuple) {
+		for (const uint8_t* p = body; p < end;) {
+			const LV2_Atom* child = (const LV2_Atom*)p;
+			if (!walk_checked(v, child, (uint32_t)(end - p))) {
+				return false;
+			}
+			p += lv2_atom_pad_size(sizeof(LV2_Atom) + child->size);
+		}
+	} else if (atom->type == v->atom_Object) {
+		if (atom->size < sizeof(LV2_Atom_Object_Body)) {
+			return false;
+		}
+
+		for (const uint8_t* p = body + sizeof(LV2_Atom_Object_Body);
+		     p < end;) {
+			const LV2_Atom_Property_Body* prop =
+				(const LV2_Atom_Property_Body*)p;
+			if ((size_t)(end - p) < sizeof(LV2_Atom_Property_Body) ||
+			    !walk_checked(v, &prop->value, (uint32_t)(end - p - 8))) {
+				return false;
+			}
+			p += 8 + lv2_atom_pad_size(sizeof(LV2_Atom) + prop->value.size);
+		}
+	} else if (atom->type == v->atom_Vector) {
+		const LV2_Atom_Vector_Body* vec = (const LV2_Atom_Vector_Body*)body;
+		if (atom->size < sizeof(LV2_Atom_Vector_Body) ||
+		    (vec->child_size &&
+		     (atom->size - sizeof(LV2_Atom_Vector_Body)) % vec->child_size)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** Walk `atom` with the FOREACH macros, checking nothing. */
+static uint32_t
+walk_unchecked(const LV2_Atom_Validator* v, const LV2_Atom* atom)
+{
+	uint32_t count = 1;
+	if (atom->type == v->atom_Sequence) {
+		LV2_ATOM_SEQUENCE_FOREACH((const LV2_Atom_Sequence*)atom, ev) {
+			count += walk_unchecked(v, &ev->body);
+		}
+	} else if (atom->type == v->atom_Tuple) {
+		LV2_ATOM_TUPLE_FOREACH((const LV2_Atom_Tuple*)atom, child) {
+			count += walk_unchecked(v, child);
+		}
+	} else if (atom->type == v->atom_Object) {
+		LV2_ATOM_OBJECT_FOREACH((const LV2_Atom_Object*)atom, prop) {
+			count += walk_unchecked(v, &prop->value);
+		}
+	}
+
+	return count;
+}
+
+int
+main(void)
+{
+	LV2_URID_Map       map = { NULL, urid_map };
+	LV2_Atom_Forge     forge;
+	LV2_Atom_Validator validator;
+	lv2_atom_forge_init(&forge, &map);
+	lv2_atom_validator_init(&validator, &map);
+
+	uint8_t* const        buf  = (uint8_t*)calloc(1, CAPACITY);
+	const LV2_Atom* const seq  = make_sequence(&forge, buf);
+	const uint32_t        size = lv2_atom_total_size(seq);
+	const double          mb   = (double)size * N_REPEATS / 1e6;
+
+	bool     valid = true;
+	uint32_t count = 0;
+
+	double start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		valid = valid && lv2_atom_validate(&validator, seq, size);
+	}
+	const double validate_ns = now() - start;
+
+	start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		valid = valid && walk_checked(&validator, seq, size);
+	}
+	const double checked_ns = now() - start;
+
+	start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		count += walk_unchecked(&validator, seq);
+	}
+	const double unchecked_ns = now() - start;
+
+	if (!valid || count != N_REPEATS * (1 + N_EVENTS * 6)) {
+		fprintf(stderr, "error: Failed to validate sequence\n");
+		return 1;
+	}
+
+	printf("validate\t%u\t%.1f\n", size, mb / (validate_ns / 1e9));
+	printf("checked_walk\t%u\t%.1f\n", size, mb / (checked_ns / 1e9));
+	printf("unchecked_walk\t%u\t%.1f\n", size, mb / (unchecked_ns / 1e9));
+
+	free(buf);
+	return 0;
+}
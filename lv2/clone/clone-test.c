@@ -0,0 +1,61 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/clone/clone.h"
+#include "lv2/core/lv2.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static int
+test_fail(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	fprintf(stderr, "error: ");
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	return 1;
+}
+
+int
+main(void)
+{
+	static const LV2_Descriptor mine  = { "urn:test:mine", NULL, NULL, NULL,
+	                                      NULL, NULL, NULL, NULL };
+	static const LV2_Descriptor other = { "urn:test:other", NULL, NULL, NULL,
+	                                      NULL, NULL, NULL, NULL };
+
+	int                 instance = 0;
+	LV2_Clone_Prototype proto    = { &mine, &instance };
+	LV2_Feature         map      = { "urn:test:map", NULL };
+	LV2_Feature         clone    = { LV2_CLONE__prototype, &proto };
+
+	const LV2_Feature* none[]     = { &map, NULL };
+	const LV2_Feature* features[] = { &map, &clone, NULL };
+
+	if (lv2_clone_prototype(NULL, &mine)) {
+		return test_fail("Prototype found in NULL features\n");
+	} else if (lv2_clone_prototype(none, &mine)) {
+		return test_fail("Prototype found without feature\n");
+	} else if (lv2_clone_prototype(features, &mine) != &instance) {
+		return test_fail("Prototype not found\n");
+	} else if (lv2_clone_prototype(features, &other)) {
+		return test_fail("Prototype of another plugin returned\n");
+	}
+
+	return 0;
+}
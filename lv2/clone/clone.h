@@ -0,0 +1,95 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @defgroup clone Clone
+
+   Instantiation of plugins by copying from an existing instance; see
+   <http://lv2plug.in/ns/ext/clone> for details.
+
+   @{
+*/
+
+#ifndef LV2_CLONE_H
+#define LV2_CLONE_H
+
+#include "lv2/core/lv2.h"
+
+#include <string.h>
+
+#define LV2_CLONE_URI    "http://lv2plug.in/ns/ext/clone"  ///< http://lv2plug.in/ns/ext/clone
+#define LV2_CLONE_PREFIX LV2_CLONE_URI "#"                 ///< http://lv2plug.in/ns/ext/clone#
+
+#define LV2_CLONE__prototype LV2_CLONE_PREFIX "prototype"  ///< http://lv2plug.in/ns/ext/clone#prototype
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Prototype feature (LV2_CLONE__prototype)
+*/
+typedef struct _LV2_Clone_Prototype {
+	/**
+	   The descriptor that `instance` was instantiated from.
+
+	   Plugins compare this to their own descriptor, since the instance may
+	   only be interpreted by the plugin that created it.
+	*/
+	const LV2_Descriptor* descriptor;
+
+	/**
+	   The prototype instance.
+
+	   This is only valid during the call to instantiate(), and may be running
+	   concurrently, so only data that never changes may be read from it.
+	*/
+	LV2_Handle instance;
+} LV2_Clone_Prototype;
+
+/**
+   Return the prototype instance in `features`, or NULL.
+
+   This returns NULL if there is no clone:prototype feature, or if the
+   prototype was not instantiated from `descriptor`, so the result can be
+   safely cast to the plugin's instance type.
+*/
+static inline LV2_Handle
+lv2_clone_prototype(const LV2_Feature* const* features,
+                    const LV2_Descriptor*     descriptor)
+{
+	for (const LV2_Feature* const* f = features; f && *f; ++f) {
+		if (!strcmp((*f)->URI, LV2_CLONE__prototype)) {
+			const LV2_Clone_Prototype* const proto =
+				(const LV2_Clone_Prototype*)(*f)->data;
+
+			return (proto && proto->descriptor == descriptor)
+				? proto->instance : NULL;
+		}
+	}
+
+	return NULL;
+}
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif  /* LV2_CLONE_H */
+
+/**
+   @}
+*/
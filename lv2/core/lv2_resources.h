@@ -0,0 +1,402 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @defgroup resources Resources
+   @ingroup lv2core
+
+   Read-only data shared by all instances in a plugin library.
+
+   Many plugins build the same data for every instance, such as wavetables,
+   tables of mapped URIDs, or decoded samples.  A resource store, created by
+   lv2_lib_descriptor(), holds one copy of each for the whole library, and
+   frees it when the last instance that uses it is cleaned up.
+
+   A library uses the store by implementing lv2_lib_descriptor() with
+   lv2_resource_lib_new().  The descriptors it returns are copies of those
+   returned by lv2_descriptor(), which is still provided for hosts that do not
+   support lv2_lib_descriptor().  In instantiate(), the plugin gets the store
+   with lv2_resource_store(), which returns NULL if the plugin was loaded
+   with lv2_descriptor().  All other functions accept a NULL store, in which
+   case every resource is simply created for, and freed with, the instance.
+
+   Since instantiate() and cleanup() may be called concurrently for different
+   instances, the store is protected by a spin lock.  The lock is never held
+   while a resource is created or freed, so it is only held briefly.
+
+   @{
+*/
+
+#ifndef LV2_RESOURCES_H
+#define LV2_RESOURCES_H
+
+#include "lv2/core/lv2.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#    include <intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Create a resource.
+
+   @param arg The argument passed to lv2_resource_acquire().
+   @param size Set to the size of the resource in bytes, for accounting.
+   @return The new resource, or NULL on failure.
+*/
+typedef void* (*LV2_Resource_Create)(void* arg, size_t* size);
+
+/**
+   Free a resource made by an LV2_Resource_Create function.
+*/
+typedef void (*LV2_Resource_Free)(void* data);
+
+/** @cond */
+typedef struct {
+	char*       key;
+	const void* scope;
+	void*       data;
+	size_t      size;
+	uint32_t    refs;
+} LV2_Resource;
+/** @endcond */
+
+/**
+   A store of resources shared by every instance in a library.
+*/
+typedef struct {
+	volatile long lock;         ///< Spin lock, held while modifying
+	LV2_Resource* resources;    ///< Resources, in no particular order
+	uint32_t      n_resources;  ///< Number of resources
+	size_t        size;         ///< Total size of all resources in bytes
+} LV2_Resource_Store;
+
+/**
+   A plugin descriptor in a library with a resource store.
+*/
+typedef struct {
+	LV2_Descriptor      descriptor;  ///< Copy of the plugin descriptor
+	LV2_Resource_Store* store;       ///< Resource store of the library
+} LV2_Resource_Descriptor;
+
+/**
+   A library descriptor with a resource store.
+*/
+typedef struct {
+	LV2_Lib_Descriptor       lib;        ///< Library descriptor
+	LV2_Resource_Store       store;      ///< Resources of every plugin
+	LV2_Resource_Descriptor* plugins;    ///< Plugin descriptors
+	uint32_t                 n_plugins;  ///< Number of plugins
+} LV2_Resource_Lib;
+
+/** @cond */
+
+static inline void
+lv2_resource_store_lock(LV2_Resource_Store* store)
+{
+#ifdef _MSC_VER
+	while (_InterlockedExchange(&store->lock, 1)) {}
+#else
+	while (__atomic_exchange_n(&store->lock, 1, __ATOMIC_ACQUIRE)) {}
+#endif
+}
+
+static inline void
+lv2_resource_store_unlock(LV2_Resource_Store* store)
+{
+#ifdef _MSC_VER
+	_InterlockedExchange(&store->lock, 0);
+#else
+	__atomic_store_n(&store->lock, 0, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline LV2_Resource*
+lv2_resource_find(LV2_Resource_Store* store,
+                  const char*         key,
+                  const void*         scope)
+{
+	for (uint32_t i = 0; i < store->n_resources; ++i) {
+		LV2_Resource* const r = &store->resources[i];
+		if (r->scope == scope && !strcmp(r->key, key)) {
+			return r;
+		}
+	}
+
+	return NULL;
+}
+
+/** @endcond */
+
+/**
+   Initialise an empty resource store.
+*/
+static inline void
+lv2_resource_store_init(LV2_Resource_Store* store)
+{
+	memset(store, 0, sizeof(LV2_Resource_Store));
+}
+
+/**
+   Free a resource store.
+
+   Every resource should have been released by now, since a library must not
+   be cleaned up while any of its instances exist.  Any that remain are not
+   freed, since the store does not know how.
+*/
+static inline void
+lv2_resource_store_cleanup(LV2_Resource_Store* store)
+{
+	for (uint32_t i = 0; i < store->n_resources; ++i) {
+		free(store->resources[i].key);
+	}
+
+	free(store->resources);
+	lv2_resource_store_init(store);
+}
+
+/**
+   Return the resource store for a descriptor passed to instantiate().
+
+   @param descriptor The descriptor passed to instantiate().
+   @param plain The plugin's own descriptor returned by lv2_descriptor().
+   @return The store of the library, or NULL if the plugin was loaded with
+   lv2_descriptor() and there is no store.
+*/
+static inline LV2_Resource_Store*
+lv2_resource_store(const LV2_Descriptor* descriptor,
+                   const LV2_Descriptor* plain)
+{
+	return descriptor == plain
+		? NULL
+		: ((const LV2_Resource_Descriptor*)descriptor)->store;
+}
+
+/**
+   Get a resource, creating it if necessary.
+
+   If the store already has a resource with the same key and scope, its
+   reference count is incremented and it is returned.  Otherwise, `create` is
+   called with `arg` to create it.  If several threads create the same
+   resource at once, only one is kept, and the others are freed with
+   `free_data`.
+
+   If `store` is NULL, the resource is simply created and returned.
+
+   @param store The store of the library, or NULL.
+   @param key A string that identifies the resource, like "wave".
+   @param scope A pointer that the resource depends on, or NULL.  For
+   example, a table of URIDs depends on the URID map that made it.
+   @param create Function to create the resource.
+   @param free_data Function to free the resource.
+   @param arg Argument passed to `create`.
+   @return The resource, or NULL if it could not be created.
+*/
+static inline void*
+lv2_resource_acquire(LV2_Resource_Store* store,
+                     const char*         key,
+                     const void*         scope,
+                     LV2_Resource_Create create,
+                     LV2_Resource_Free   free_data,
+                     void*               arg)
+{
+	size_t size = 0;
+	if (!store) {
+		return create(arg, &size);
+	}
+
+	// Return the existing resource if there is one
+	lv2_resource_store_lock(store);
+	LV2_Resource* r = lv2_resource_find(store, key, scope);
+	if (r) {
+		void* const existing = r->data;
+		++r->refs;
+		lv2_resource_store_unlock(store);
+		return existing;
+	}
+	lv2_resource_store_unlock(store);
+
+	// Create a new resource without holding the lock
+	void* const  data    = create(arg, &size);
+	const size_t key_len = strlen(key);
+	char* const  key_buf = (char*)malloc(key_len + 1);
+	if (!data || !key_buf) {
+		free(key_buf);
+		if (data) {
+			free_data(data);
+		}
+		return NULL;
+	}
+
+	memcpy(key_buf, key, key_len + 1);
+
+	lv2_resource_store_lock(store);
+	if ((r = lv2_resource_find(store, key, scope))) {
+		// Another thread created it meanwhile, use that one instead
+		++r->refs;
+		void* const existing = r->data;
+		lv2_resource_store_unlock(store);
+		free(key_buf);
+		free_data(data);
+		return existing;
+	}
+
+	LV2_Resource* const resources = (LV2_Resource*)realloc(
+		store->resources, (store->n_resources + 1) * sizeof(LV2_Resource));
+	if (!resources) {
+		// Return the resource untracked, it is freed when released
+		lv2_resource_store_unlock(store);
+		free(key_buf);
+		return data;
+	}
+
+	const LV2_Resource resource = { key_buf, scope, data, size, 1 };
+
+	store->resources                       = resources;
+	store->resources[store->n_resources++] = resource;
+	store->size += size;
+	lv2_resource_store_unlock(store);
+	return data;
+}
+
+/**
+   Release a resource returned by lv2_resource_acquire().
+
+   The reference count of the resource is decremented, and if it reaches
+   zero, the resource is removed from the store and freed with `free_data`.
+   If `store` is NULL, the resource is freed immediately.
+*/
+static inline void
+lv2_resource_release(LV2_Resource_Store* store,
+                     void*               data,
+                     LV2_Resource_Free   free_data)
+{
+	if (!data) {
+		return;
+	}
+
+	char* key = NULL;
+	if (store) {
+		lv2_resource_store_lock(store);
+		for (uint32_t i = 0; i < store->n_resources; ++i) {
+			LV2_Resource* const r = &store->resources[i];
+			if (r->data == data) {
+				if (--r->refs) {
+					lv2_resource_store_unlock(store);
+					return;
+				}
+
+				// Last reference, remove by moving the last resource here
+				key = r->key;
+				store->size -= r->size;
+				*r = store->resources[--store->n_resources];
+				break;
+			}
+		}
+		lv2_resource_store_unlock(store);
+	}
+
+	free(key);
+	free_data(data);
+}
+
+/** @cond */
+
+static inline const LV2_Descriptor*
+lv2_resource_lib_get_plugin(LV2_Lib_Handle handle, uint32_t index)
+{
+	const LV2_Resource_Lib* const lib = (const LV2_Resource_Lib*)handle;
+	return index < lib->n_plugins ? &lib->plugins[index].descriptor : NULL;
+}
+
+static inline void
+lv2_resource_lib_free(LV2_Lib_Handle handle)
+{
+	LV2_Resource_Lib* const lib = (LV2_Resource_Lib*)handle;
+	lv2_resource_store_cleanup(&lib->store);
+	free(lib->plugins);
+	free(lib);
+}
+
+/** @endcond */
+
+/**
+   Create a library descriptor with a resource store.
+
+   This is intended to implement lv2_lib_descriptor(), with the plugin's own
+   lv2_descriptor() function, for example:
+
+   @code
+   LV2_SYMBOL_EXPORT
+   const LV2_Lib_Descriptor*
+   lv2_lib_descriptor(const char*               bundle_path,
+                      const LV2_Feature* const* features)
+   {
+       return lv2_resource_lib_new(lv2_descriptor);
+   }
+   @endcode
+
+   Every descriptor returned by `descriptor` is copied.  The result is freed
+   when the host calls its cleanup() method.
+
+   @return A new library descriptor, or NULL on allocation failure.
+*/
+static inline const LV2_Lib_Descriptor*
+lv2_resource_lib_new(LV2_Descriptor_Function descriptor)
+{
+	uint32_t n_plugins = 0;
+	while (descriptor(n_plugins)) {
+		++n_plugins;
+	}
+
+	LV2_Resource_Lib* const lib =
+		(LV2_Resource_Lib*)calloc(1, sizeof(LV2_Resource_Lib));
+	if (!lib || !(lib->plugins = (LV2_Resource_Descriptor*)calloc(
+		              n_plugins + 1, sizeof(LV2_Resource_Descriptor)))) {
+		free(lib);
+		return NULL;
+	}
+
+	lib->lib.handle     = lib;
+	lib->lib.size       = sizeof(LV2_Lib_Descriptor);
+	lib->lib.cleanup    = lv2_resource_lib_free;
+	lib->lib.get_plugin = lv2_resource_lib_get_plugin;
+	lib->n_plugins      = n_plugins;
+	lv2_resource_store_init(&lib->store);
+	for (uint32_t i = 0; i < n_plugins; ++i) {
+		lib->plugins[i].descriptor = *descriptor(i);
+		lib->plugins[i].store      = &lib->store;
+	}
+
+	return &lib->lib;
+}
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif  /* LV2_RESOURCES_H */
+
+/**
+   @}
+*/
@@ -0,0 +1,147 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/core/lv2.h"
+#include "lv2/core/lv2_resources.h"
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned n_created = 0;
+static unsigned n_freed   = 0;
+
+static int
+test_fail(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	fprintf(stderr, "error: ");
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	return 1;
+}
+
+static void*
+create_table(void* arg, size_t* size)
+{
+	int32_t* const table = (int32_t*)malloc(4 * sizeof(int32_t));
+	if (table) {
+		for (int32_t i = 0; i < 4; ++i) {
+			table[i] = *(const int32_t*)arg + i;
+		}
+		*size = 4 * sizeof(int32_t);
+		++n_created;
+	}
+	return table;
+}
+
+static void
+free_table(void* data)
+{
+	++n_freed;
+	free(data);
+}
+
+static const LV2_Descriptor descriptors[] = {
+	{ "urn:test:a", NULL, NULL, NULL, NULL, NULL, NULL, NULL },
+	{ "urn:test:b", NULL, NULL, NULL, NULL, NULL, NULL, NULL } };
+
+static const LV2_Descriptor*
+test_descriptor(uint32_t index)
+{
+	return index < 2 ? &descriptors[index] : NULL;
+}
+
+static int
+test_store(void)
+{
+	LV2_Resource_Store store;
+	lv2_resource_store_init(&store);
+
+	int32_t  base  = 10;
+	int      scope = 0;
+	int32_t* a     = (int32_t*)lv2_resource_acquire(
+		&store, "table", NULL, create_table, free_table, &base);
+	int32_t* b     = (int32_t*)lv2_resource_acquire(
+		&store, "table", NULL, create_table, free_table, &base);
+	int32_t* c     = (int32_t*)lv2_resource_acquire(
+		&store, "table", &scope, create_table, free_table, &base);
+	int32_t* d     = (int32_t*)lv2_resource_acquire(
+		NULL, "table", NULL, create_table, free_table, &base);
+	if (!a || a != b || a[3] != 13) {
+		return test_fail("Resource not shared\n");
+	} else if (!c || c == a) {
+		return test_fail("Resource shared between scopes\n");
+	} else if (!d || d == a) {
+		return test_fail("Resource shared without store\n");
+	} else if (n_created != 3 || store.n_resources != 2 ||
+	           store.size != 8 * sizeof(int32_t)) {
+		return test_fail("Created %u resources, store has %u of %zu bytes\n",
+		                 n_created,
+		                 store.n_resources,
+		                 store.size);
+	}
+
+	lv2_resource_release(NULL, d, free_table);
+	lv2_resource_release(&store, a, free_table);
+	if (n_freed != 1 || store.n_resources != 2) {
+		return test_fail("Resource freed while still in use\n");
+	}
+
+	lv2_resource_release(&store, b, free_table);
+	lv2_resource_release(&store, c, free_table);
+	if (n_freed != 3 || store.n_resources || store.size) {
+		return test_fail("Unused resources not freed\n");
+	}
+
+	lv2_resource_store_cleanup(&store);
+	return 0;
+}
+
+static int
+test_lib(void)
+{
+	const LV2_Lib_Descriptor* const lib = lv2_resource_lib_new(test_descriptor);
+	if (!lib || lib->size != sizeof(LV2_Lib_Descriptor)) {
+		return test_fail("Failed to create library descriptor\n");
+	}
+
+	const LV2_Descriptor* const a = lib->get_plugin(lib->handle, 0);
+	const LV2_Descriptor* const b = lib->get_plugin(lib->handle, 1);
+	if (!a || !b || strcmp(a->URI, "urn:test:a") ||
+	    strcmp(b->URI, "urn:test:b") || lib->get_plugin(lib->handle, 2)) {
+		return test_fail("Incorrect plugins in library\n");
+	}
+
+	LV2_Resource_Store* const store = lv2_resource_store(a, &descriptors[0]);
+	if (!store || lv2_resource_store(b, &descriptors[1]) != store) {
+		return test_fail("Plugins do not share a store\n");
+	} else if (lv2_resource_store(&descriptors[0], &descriptors[0])) {
+		return test_fail("Store returned for plain descriptor\n");
+	}
+
+	lib->cleanup(lib->handle);
+	return 0;
+}
+
+int
+main(void)
+{
+	return test_store() || test_lib();
+}
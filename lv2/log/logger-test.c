@@ -0,0 +1,373 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/log/log.h"
+#include "lv2/log/logger.h"
+#include "lv2/urid/urid.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_LINES 64
+
+enum { ERROR = 1, NOTE = 2, TRACE = 3, WARNING = 4 };
+
+/** A log which records every message it receives. */
+typedef struct {
+	LV2_Log_Log log;
+	unsigned    n_lines;
+	LV2_URID    types[MAX_LINES];
+	char        lines[MAX_LINES][256];
+} Sink;
+
+static int
+test_fail(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	fprintf(stderr, "error: ");
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	return 1;
+}
+
+LV2_LOG_FUNC(3, 0)
+static int
+sink_vprintf(LV2_Log_Handle handle,
+             LV2_URID       type,
+             const char*    fmt,
+             va_list        args)
+{
+	Sink* const sink = (Sink*)handle;
+	if (sink->n_lines == MAX_LINES) {
+		return 0;
+	}
+
+	sink->types[sink->n_lines] = type;
+	return vsnprintf(sink->lines[sink->n_lines++], 256, fmt, args);
+}
+
+LV2_LOG_FUNC(3, 4)
+static int
+sink_printf(LV2_Log_Handle handle, LV2_URID type, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const int ret = sink_vprintf(handle, type, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+static void
+sink_init(Sink* sink, LV2_Log_Logger* logger)
+{
+	memset(sink, 0, sizeof(Sink));
+	sink->log.handle  = sink;
+	sink->log.printf  = sink_printf;
+	sink->log.vprintf = sink_vprintf;
+
+	logger->log     = &sink->log;
+	logger->Error   = ERROR;
+	logger->Note    = NOTE;
+	logger->Trace   = TRACE;
+	logger->Warning = WARNING;
+}
+
+static int
+test_deferred_format(void)
+{
+	Sink             sink;
+	LV2_Log_Logger   logger;
+	LV2_Log_Deferred deferred;
+	sink_init(&sink, &logger);
+	lv2_log_deferred_init(&deferred, &logger);
+
+	if (lv2_log_deferred_is_pending(&deferred)) {
+		return test_fail("New deferred log is pending\n");
+	}
+
+	char str[] = "str";
+	lv2_log_deferred_error(&deferred, "%d %u %ld %s%%\n", -1, 2u, 3l, str);
+	lv2_log_deferred_note(&deferred, "%5.2f|%-4s|%*d|%zu\n", 1.5, "a", 3, 7,
+	                      (size_t)42);
+	lv2_log_deferred_trace(&deferred, "%c%x %p\n", 'c', 255u, NULL);
+	str[0] = 'S';  // Strings are copied, so this has no effect
+
+	if (!lv2_log_deferred_is_pending(&deferred)) {
+		return test_fail("Deferred log with messages is not pending\n");
+	} else if (sink.n_lines) {
+		return test_fail("Deferred message logged before drain\n");
+	}
+
+	char expected_pointer[32];
+	snprintf(expected_pointer, sizeof(expected_pointer), "cff %p\n", NULL);
+
+	const uint32_t n_drained = lv2_log_deferred_drain(&deferred);
+	if (n_drained != 3 || sink.n_lines != 3) {
+		return test_fail("Drained %u messages, logged %u lines\n",
+		                 n_drained, sink.n_lines);
+	} else if (strcmp(sink.lines[0], "-1 2 3 str%\n") ||
+	           sink.types[0] != ERROR) {
+		return test_fail("Bad first message \"%s\"\n", sink.lines[0]);
+	} else if (strcmp(sink.lines[1], " 1.50|a   |  7|42\n") ||
+	           sink.types[1] != NOTE) {
+		return test_fail("Bad second message \"%s\"\n", sink.lines[1]);
+	} else if (strcmp(sink.lines[2], expected_pointer) ||
+	           sink.types[2] != TRACE) {
+		return test_fail("Bad third message \"%s\"\n", sink.lines[2]);
+	} else if (lv2_log_deferred_is_pending(&deferred)) {
+		return test_fail("Deferred log is pending after drain\n");
+	}
+
+	return 0;
+}
+
+static int
+test_deferred_overflow(void)
+{
+	Sink             sink;
+	LV2_Log_Logger   logger;
+	LV2_Log_Deferred deferred;
+	sink_init(&sink, &logger);
+	lv2_log_deferred_init(&deferred, &logger);
+
+	// Fill the buffer, and drop a few more messages
+	unsigned n_recorded = 0;
+	for (unsigned i = 0; i < LV2_LOG_DEFERRED_CAPACITY + 3; ++i) {
+		n_recorded += lv2_log_deferred_warning(&deferred, "Message %u\n", i);
+	}
+
+	lv2_log_deferred_drain(&deferred);
+	if (n_recorded != LV2_LOG_DEFERRED_CAPACITY) {
+		return test_fail("Recorded %u messages\n", n_recorded);
+	} else if (sink.n_lines != LV2_LOG_DEFERRED_CAPACITY + 1) {
+		return test_fail("Logged %u lines\n", sink.n_lines);
+	} else if (strcmp(sink.lines[0], "Dropped 3 deferred log messages\n") ||
+	           sink.types[0] != WARNING) {
+		return test_fail("Bad drop report \"%s\"\n", sink.lines[0]);
+	} else if (strcmp(sink.lines[1], "Message 0\n") ||
+	           strcmp(sink.lines[LV2_LOG_DEFERRED_CAPACITY], "Message 31\n")) {
+		return test_fail("Bad messages \"%s\" ... \"%s\"\n",
+		                 sink.lines[1],
+		                 sink.lines[LV2_LOG_DEFERRED_CAPACITY]);
+	}
+
+	/* The buffer is usable again, and only new drops are reported, here of a
+	   message with an unsupported conversion. */
+	int n = 0;
+	sink.n_lines = 0;
+	if (!lv2_log_deferred_note(&deferred, "Again\n") ||
+	    lv2_log_deferred_note(&deferred, "%n", &n) ||
+	    lv2_log_deferred_drain(&deferred) != 1) {
+		return test_fail("Failed to reuse deferred log\n");
+	} else if (sink.n_lines != 2 ||
+	           strcmp(sink.lines[0], "Dropped 1 deferred log messages\n") ||
+	           strcmp(sink.lines[1], "Again\n")) {
+		return test_fail("Bad messages after reuse\n");
+	}
+
+	return 0;
+}
+
+static int
+test_deferred_truncation(void)
+{
+	Sink             sink;
+	LV2_Log_Logger   logger;
+	LV2_Log_Deferred deferred;
+	sink_init(&sink, &logger);
+	lv2_log_deferred_init(&deferred, &logger);
+
+	// Strings that do not fit are truncated, leaving room for a terminator
+	char long_str[200];
+	memset(long_str, 'x', sizeof(long_str) - 1);
+	long_str[sizeof(long_str) - 1] = '\0';
+	lv2_log_deferred_error(&deferred, "%s|%s\n", long_str, "tail");
+	lv2_log_deferred_error(&deferred, "%s|%s\n", "head", "tail");
+	lv2_log_deferred_drain(&deferred);
+
+	char expected[256];
+	memset(expected, 'x', LV2_LOG_DEFERRED_STRINGS_SIZE - 1);
+	snprintf(expected + LV2_LOG_DEFERRED_STRINGS_SIZE - 1,
+	         sizeof(expected) - LV2_LOG_DEFERRED_STRINGS_SIZE + 1,
+	         "|\n");
+
+	if (sink.n_lines != 2) {
+		return test_fail("Logged %u lines\n", sink.n_lines);
+	} else if (strcmp(sink.lines[0], expected)) {
+		return test_fail("Bad truncated message \"%s\"\n", sink.lines[0]);
+	} else if (strcmp(sink.lines[1], "head|tail\n")) {
+		return test_fail("Bad message \"%s\"\n", sink.lines[1]);
+	}
+
+	return 0;
+}
+
+static int
+check_lines(const Sink* sink, unsigned n_lines, const char* const* lines)
+{
+	if (sink->n_lines != n_lines) {
+		return test_fail("Logged %u lines, expected %u\n",
+		                 sink->n_lines, n_lines);
+	}
+
+	for (unsigned i = 0; i < n_lines; ++i) {
+		if (strcmp(sink->lines[i], lines[i])) {
+			return test_fail("Line %u is \"%s\", expected \"%s\"\n",
+			                 i, sink->lines[i], lines[i]);
+		}
+	}
+
+	return 0;
+}
+
+/** Log an error, always with the same format string. */
+static void
+log_error(LV2_Log_Limiter* limiter, int i)
+{
+	lv2_log_limiter_printf(limiter, ERROR, "Error %d\n", i);
+}
+
+static int
+test_limiter_window(void)
+{
+	Sink            sink;
+	LV2_Log_Logger  logger;
+	LV2_Log_Limiter limiter;
+	sink_init(&sink, &logger);
+	lv2_log_limiter_init(&limiter, &sink.log, 1.0);
+
+	// Repeats are suppressed, but other messages are not
+	for (int i = 0; i < 3; ++i) {
+		log_error(&limiter, i);
+	}
+	lv2_log_limiter_printf(&limiter, NOTE, "Other\n");
+
+	// The summary is logged once the window has expired
+	lv2_log_limiter_update(&limiter, 0.5);
+	if (sink.n_lines != 2) {
+		return test_fail("Summary logged before end of window\n");
+	}
+
+	lv2_log_limiter_update(&limiter, 1.0);
+	if (sink.types[2] != ERROR) {
+		return test_fail("Summary has the wrong type\n");
+	}
+
+	// After the window the message is logged again, with no summary later
+	log_error(&limiter, 3);
+	lv2_log_limiter_update(&limiter, 2.0);
+
+	static const char* const lines[] = {
+		"Error 0\n",
+		"Other\n",
+		"Message \"Error %d\" repeated 2 times\n",
+		"Error 3\n" };
+
+	return check_lines(&sink, 4, lines);
+}
+
+static int
+test_limiter_rate(void)
+{
+	Sink            sink;
+	LV2_Log_Logger  logger;
+	LV2_Log_Limiter limiter;
+	sink_init(&sink, &logger);
+	lv2_log_limiter_init(&limiter, &sink.log, 0.0);
+	if (!lv2_log_limiter_set_limit(&limiter, ERROR, 1.0, 2.0) ||
+	    !lv2_log_limiter_set_limit(&limiter, 0, 1.0, 1.0)) {
+		return test_fail("Failed to set limits\n");
+	}
+
+	// A burst of errors, then messages that use the default limit
+	for (int i = 0; i < 5; ++i) {
+		log_error(&limiter, i);
+	}
+	lv2_log_limiter_printf(&limiter, NOTE, "Note 0\n");
+	lv2_log_limiter_printf(&limiter, WARNING, "Warning 0\n");
+
+	// The summaries are logged once tokens are available
+	lv2_log_limiter_update(&limiter, 0.5);
+	if (sink.n_lines != 3) {
+		return test_fail("Summary logged without tokens\n");
+	}
+
+	lv2_log_limiter_update(&limiter, 1.0);
+	if (sink.types[3] != ERROR || sink.types[4] != WARNING) {
+		return test_fail("Summaries have the wrong types\n");
+	}
+
+	// Summaries take tokens, so the next error is dropped and reported
+	log_error(&limiter, 5);
+	lv2_log_limiter_update(&limiter, 2.0);
+	lv2_log_limiter_update(&limiter, 3.0);
+	log_error(&limiter, 6);
+
+	static const char* const lines[] = {
+		"Error 0\n",
+		"Error 1\n",
+		"Note 0\n",
+		"Rate limit dropped 3 messages\n",
+		"Rate limit dropped 1 messages\n",
+		"Rate limit dropped 1 messages\n",
+		"Error 6\n" };
+
+	return check_lines(&sink, 7, lines);
+}
+
+static int
+test_limiter_dropped_repeats(void)
+{
+	Sink            sink;
+	LV2_Log_Logger  logger;
+	LV2_Log_Limiter limiter;
+	sink_init(&sink, &logger);
+	lv2_log_limiter_init(&limiter, &sink.log, 1.0);
+	lv2_log_limiter_set_limit(&limiter, ERROR, 1.0, 1.0);
+
+	// Messages dropped by the rate limit are not counted as repeats
+	lv2_log_limiter_printf(&limiter, ERROR, "First\n");
+	log_error(&limiter, 0);
+	log_error(&limiter, 1);
+	lv2_log_limiter_update(&limiter, 1.0);
+
+	// So the next one is logged once there is a token, and starts a window
+	lv2_log_limiter_update(&limiter, 2.0);
+	log_error(&limiter, 2);
+	lv2_log_limiter_update(&limiter, 2.5);
+	log_error(&limiter, 3);
+	lv2_log_limiter_update(&limiter, 3.0);
+
+	static const char* const lines[] = {
+		"First\n",
+		"Rate limit dropped 2 messages\n",
+		"Error 2\n",
+		"Message \"Error %d\" repeated 1 times\n" };
+
+	return check_lines(&sink, 4, lines);
+}
+
+int
+main(void)
+{
+	return test_deferred_format() || test_deferred_overflow() ||
+	       test_deferred_truncation() || test_limiter_window() ||
+	       test_limiter_rate() || test_limiter_dropped_repeats();
+}
@@ -30,6 +30,9 @@
 
 #include "lv2/log/log.h"
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -147,6 +150,794 @@ lv2_log_warning(LV2_Log_Logger* logger, const char* fmt, ...)
 	return ret;
 }
 
+/**
+   @name Deferred Logging
+   @{
+
+   A deferred logger allows realtime code to log without formatting or
+   calling into the host.  Messages are recorded into a lock-free ring buffer
+   as a format string pointer and raw arguments, and later formatted and
+   forwarded to a logger by a non-realtime thread (for example, in a plugin's
+   worker) with lv2_log_deferred_drain().
+
+   There must be at most one thread writing messages, and one thread draining
+   them, at any time.  Since the format string is not copied, it must remain
+   valid until the message is drained, which is the case for string literals.
+   String arguments for `%s` are copied, up to a limited total length per
+   message.  If the buffer is full, messages are dropped and counted, and the
+   number of dropped messages is reported when the buffer is next drained.
+*/
+
+/** Maximum number of arguments (including `*` width/precision) per message. */
+#ifndef LV2_LOG_DEFERRED_MAX_ARGS
+#    define LV2_LOG_DEFERRED_MAX_ARGS 12
+#endif
+
+/** Size of storage for copied string arguments per message. */
+#ifndef LV2_LOG_DEFERRED_STRINGS_SIZE
+#    define LV2_LOG_DEFERRED_STRINGS_SIZE 128
+#endif
+
+/** Number of messages in a deferred log buffer, which must be a power of 2. */
+#ifndef LV2_LOG_DEFERRED_CAPACITY
+#    define LV2_LOG_DEFERRED_CAPACITY 32
+#endif
+
+/** @cond */
+#ifdef __GNUC__
+#    define LV2_LOG_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#    define LV2_LOG_STORE_RELEASE(ptr, val) \
+	__atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#else
+#    define LV2_LOG_LOAD_ACQUIRE(ptr) (*(volatile const uint32_t*)(ptr))
+#    define LV2_LOG_STORE_RELEASE(ptr, val) \
+	(*(volatile uint32_t*)(ptr) = (val))
+#endif
+/** @endcond */
+
+/** A raw argument of a deferred message. */
+typedef union {
+	int64_t     i;  /**< Signed integer (of any size) */
+	uint64_t    u;  /**< Unsigned integer (of any size) */
+	double      d;  /**< Floating point number */
+	const void* p;  /**< Pointer */
+} LV2_Log_Deferred_Arg;
+
+/** A message recorded by a deferred logger. */
+typedef struct {
+	LV2_URID             type;    /**< Message type */
+	const char*          fmt;     /**< Format string */
+	LV2_Log_Deferred_Arg args[LV2_LOG_DEFERRED_MAX_ARGS];  /**< Arguments */
+	char strings[LV2_LOG_DEFERRED_STRINGS_SIZE];  /**< String argument data */
+} LV2_Log_Deferred_Entry;
+
+/**
+   Deferred logger state.
+
+   This is large, and should be allocated as part of the plugin instance.
+*/
+typedef struct {
+	LV2_Log_Logger*        logger;      /**< Logger to forward messages to */
+	uint32_t               write_head;  /**< Next entry to write (writer) */
+	uint32_t               read_head;   /**< Next entry to read (drainer) */
+	uint32_t               n_dropped;   /**< Total dropped (writer) */
+	uint32_t               n_reported;  /**< Total dropped reported (drainer) */
+	LV2_Log_Deferred_Entry entries[LV2_LOG_DEFERRED_CAPACITY];
+} LV2_Log_Deferred;
+
+/** Kind of argument taken by a printf conversion. */
+typedef enum {
+	LV2_LOG_ARG_NONE,      /**< No argument (for example, "%%") */
+	LV2_LOG_ARG_INT,       /**< int, or smaller signed integer */
+	LV2_LOG_ARG_LONG,      /**< long */
+	LV2_LOG_ARG_LLONG,     /**< long long */
+	LV2_LOG_ARG_UINT,      /**< unsigned int, or smaller unsigned integer */
+	LV2_LOG_ARG_ULONG,     /**< unsigned long */
+	LV2_LOG_ARG_ULLONG,    /**< unsigned long long */
+	LV2_LOG_ARG_SIZE,      /**< size_t or ptrdiff_t */
+	LV2_LOG_ARG_DOUBLE,    /**< double (or float) */
+	LV2_LOG_ARG_LDOUBLE,   /**< long double */
+	LV2_LOG_ARG_STRING,    /**< Null-terminated string */
+	LV2_LOG_ARG_POINTER,   /**< Pointer */
+	LV2_LOG_ARG_INVALID    /**< Unsupported conversion */
+} LV2_Log_Arg_Kind;
+
+/** A parsed printf conversion specification. */
+typedef struct {
+	const char*      start;      /**< Start of specification, at '%' */
+	const char*      end;        /**< End of specification, after conversion */
+	unsigned         n_stars;    /**< Number of '*' width/precision arguments */
+	LV2_Log_Arg_Kind kind;       /**< Kind of argument */
+} LV2_Log_Conversion;
+
+/**
+   Parse the printf conversion specification starting at `spec` (a '%').
+
+   This is only a scan of the specification, no formatting is done, so it is
+   realtime safe.
+*/
+static inline LV2_Log_Conversion
+lv2_log_parse_conversion(const char* spec)
+{
+	LV2_Log_Conversion conv = { spec, spec + 1, 0, LV2_LOG_ARG_INVALID };
+	const char*        c    = spec + 1;
+
+	// Flags, width, and precision
+	while (*c && strchr("-+ #0", *c)) {
+		++c;
+	}
+	for (; (*c >= '0' && *c <= '9') || *c == '*' || *c == '.'; ++c) {
+		conv.n_stars += (*c == '*');
+	}
+
+	// Length modifier
+	unsigned longs = 0;
+	bool     size  = false;
+	bool     ldbl  = false;
+	for (; *c && strchr("hljztL", *c); ++c) {
+		longs += (*c == 'l');
+		size  |= (*c == 'j' || *c == 'z' || *c == 't');
+		ldbl  |= (*c == 'L');
+	}
+
+	switch (*c) {
+	case '%':
+		conv.kind = LV2_LOG_ARG_NONE;
+		break;
+	case 'd': case 'i':
+		conv.kind = (size ? LV2_LOG_ARG_SIZE :
+		             longs == 0 ? LV2_LOG_ARG_INT :
+		             longs == 1 ? LV2_LOG_ARG_LONG : LV2_LOG_ARG_LLONG);
+		break;
+	case 'u': case 'o': case 'x': case 'X': case 'c':
+		conv.kind = (size ? LV2_LOG_ARG_SIZE :
+		             longs == 0 ? LV2_LOG_ARG_UINT :
+		             longs == 1 ? LV2_LOG_ARG_ULONG : LV2_LOG_ARG_ULLONG);
+		break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		conv.kind = ldbl ? LV2_LOG_ARG_LDOUBLE : LV2_LOG_ARG_DOUBLE;
+		break;
+	case 's':
+		conv.kind = LV2_LOG_ARG_STRING;
+		break;
+	case 'p':
+		conv.kind = LV2_LOG_ARG_POINTER;
+		break;
+	default:
+		return conv;  // Unsupported (including %n), stop here
+	}
+
+	conv.end = c + 1;
+	return conv;
+}
+
+/**
+   Initialise a deferred logger which forwards messages to `logger`.
+
+   The logger must remain valid for as long as `deferred` is used.
+*/
+static inline void
+lv2_log_deferred_init(LV2_Log_Deferred* deferred, LV2_Log_Logger* logger)
+{
+	memset(deferred, 0, sizeof(LV2_Log_Deferred));
+	deferred->logger = logger;
+}
+
+/**
+   Record a message to be logged later.
+
+   This function is realtime safe.  It returns true if the message was
+   recorded, or false if the buffer is full or the message has unsupported
+   conversions or too many arguments, in which case it is dropped.
+*/
+LV2_LOG_FUNC(3, 0)
+static inline bool
+lv2_log_deferred_vprintf(LV2_Log_Deferred* deferred,
+                         LV2_URID          type,
+                         const char*       fmt,
+                         va_list           args)
+{
+	const uint32_t write_head = deferred->write_head;
+	const uint32_t read_head  = LV2_LOG_LOAD_ACQUIRE(&deferred->read_head);
+	if (write_head - read_head >= LV2_LOG_DEFERRED_CAPACITY) {
+		LV2_LOG_STORE_RELEASE(&deferred->n_dropped, deferred->n_dropped + 1);
+		return false;
+	}
+
+	LV2_Log_Deferred_Entry* const entry =
+		&deferred->entries[write_head & (LV2_LOG_DEFERRED_CAPACITY - 1)];
+
+	entry->type = type;
+	entry->fmt  = fmt;
+
+	// Copy raw arguments according to the conversions in the format string
+	unsigned n_args   = 0;
+	size_t   str_used = 0;
+	for (const char* c = fmt; *c; ++c) {
+		if (*c != '%') {
+			continue;
+		}
+
+		const LV2_Log_Conversion conv = lv2_log_parse_conversion(c);
+		const unsigned n_new = conv.n_stars + (conv.kind != LV2_LOG_ARG_NONE);
+		if (conv.kind == LV2_LOG_ARG_INVALID ||
+		    n_args + n_new > LV2_LOG_DEFERRED_MAX_ARGS) {
+			LV2_LOG_STORE_RELEASE(&deferred->n_dropped, deferred->n_dropped + 1);
+			return false;
+		}
+
+		for (unsigned i = 0; i < conv.n_stars; ++i) {
+			entry->args[n_args++].i = va_arg(args, int);
+		}
+
+		LV2_Log_Deferred_Arg* const arg = &entry->args[n_args];
+		switch (conv.kind) {
+		case LV2_LOG_ARG_NONE:
+		case LV2_LOG_ARG_INVALID:
+			break;
+		case LV2_LOG_ARG_INT:     arg->i = va_arg(args, int); break;
+		case LV2_LOG_ARG_LONG:    arg->i = va_arg(args, long); break;
+		case LV2_LOG_ARG_LLONG:   arg->i = va_arg(args, long long); break;
+		case LV2_LOG_ARG_UINT:    arg->u = va_arg(args, unsigned); break;
+		case LV2_LOG_ARG_ULONG:   arg->u = va_arg(args, unsigned long); break;
+		case LV2_LOG_ARG_ULLONG:  arg->u = va_arg(args, unsigned long long); break;
+		case LV2_LOG_ARG_SIZE:    arg->u = va_arg(args, size_t); break;
+		case LV2_LOG_ARG_DOUBLE:  arg->d = va_arg(args, double); break;
+		case LV2_LOG_ARG_LDOUBLE: arg->d = (double)va_arg(args, long double); break;
+		case LV2_LOG_ARG_POINTER: arg->p = va_arg(args, const void*); break;
+		case LV2_LOG_ARG_STRING: {
+			// Copy string, truncating if there is not enough space left
+			const char* str = va_arg(args, const char*);
+			size_t      len = str ? strlen(str) : 0;
+			if (str_used + len + 1 > LV2_LOG_DEFERRED_STRINGS_SIZE) {
+				len = LV2_LOG_DEFERRED_STRINGS_SIZE - 1 - str_used;
+			}
+			if (len) {
+				memcpy(entry->strings + str_used, str, len);
+			}
+			entry->strings[str_used + len] = '\0';
+			arg->u                         = str_used;
+
+			// Move to next string, leaving the last byte as a terminator
+			str_used += len + 1;
+			if (str_used >= LV2_LOG_DEFERRED_STRINGS_SIZE) {
+				str_used = LV2_LOG_DEFERRED_STRINGS_SIZE - 1;
+			}
+			break;
+		}
+		}
+
+		n_args += (conv.kind != LV2_LOG_ARG_NONE);
+		c = conv.end - 1;
+	}
+
+	LV2_LOG_STORE_RELEASE(&deferred->write_head, write_head + 1);
+	return true;
+}
+
+/** Record a message via lv2_log_deferred_vprintf(). */
+LV2_LOG_FUNC(3, 4)
+static inline bool
+lv2_log_deferred_printf(LV2_Log_Deferred* deferred,
+                        LV2_URID          type,
+                        const char*       fmt,
+                        ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const bool ret = lv2_log_deferred_vprintf(deferred, type, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/** Record an error via lv2_log_deferred_vprintf(). */
+LV2_LOG_FUNC(2, 3)
+static inline bool
+lv2_log_deferred_error(LV2_Log_Deferred* deferred, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const bool ret = lv2_log_deferred_vprintf(
+		deferred, deferred->logger->Error, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/** Record a note via lv2_log_deferred_vprintf(). */
+LV2_LOG_FUNC(2, 3)
+static inline bool
+lv2_log_deferred_note(LV2_Log_Deferred* deferred, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const bool ret = lv2_log_deferred_vprintf(
+		deferred, deferred->logger->Note, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/** Record a trace via lv2_log_deferred_vprintf(). */
+LV2_LOG_FUNC(2, 3)
+static inline bool
+lv2_log_deferred_trace(LV2_Log_Deferred* deferred, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const bool ret = lv2_log_deferred_vprintf(
+		deferred, deferred->logger->Trace, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/** Record a warning via lv2_log_deferred_vprintf(). */
+LV2_LOG_FUNC(2, 3)
+static inline bool
+lv2_log_deferred_warning(LV2_Log_Deferred* deferred, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const bool ret = lv2_log_deferred_vprintf(
+		deferred, deferred->logger->Warning, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/** Return true iff there are messages waiting to be drained. */
+static inline bool
+lv2_log_deferred_is_pending(const LV2_Log_Deferred* deferred)
+{
+	return (LV2_LOG_LOAD_ACQUIRE(&deferred->write_head) != deferred->read_head ||
+	        LV2_LOG_LOAD_ACQUIRE(&deferred->n_dropped) != deferred->n_reported);
+}
+
+/** @cond */
+LV2_LOG_FUNC(3, 4)
+static inline int
+lv2_log_deferred_forward(LV2_Log_Logger* logger,
+                         LV2_URID        type,
+                         const char*     fmt,
+                         ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const int ret = lv2_log_vprintf(logger, type, fmt, args);
+	va_end(args);
+	return ret;
+}
+/** @endcond */
+
+/**
+   Format a recorded message into `buf`, like snprintf().
+
+   Each conversion is formatted individually with snprintf(), using the raw
+   argument recorded for it.  The output is truncated if it does not fit.
+*/
+static inline int
+lv2_log_deferred_format(const LV2_Log_Deferred_Entry* entry,
+                        char*                         buf,
+                        size_t                        size)
+{
+	size_t   len    = 0;
+	unsigned n_args = 0;
+	for (const char* c = entry->fmt; *c && len + 1 < size; ++c) {
+		if (*c != '%') {
+			buf[len++] = *c;
+			continue;
+		}
+
+		const LV2_Log_Conversion conv = lv2_log_parse_conversion(c);
+		if (conv.kind == LV2_LOG_ARG_NONE) {
+			buf[len++] = '%';
+			c          = conv.end - 1;
+			continue;
+		}
+
+		// Copy conversion specification to make a single-conversion format
+		char         spec[32];
+		const size_t spec_len = (size_t)(conv.end - conv.start);
+		if (spec_len >= sizeof(spec)) {
+			break;
+		}
+		memcpy(spec, conv.start, spec_len);
+		spec[spec_len] = '\0';
+
+		// Get '*' arguments and the value
+		int stars[2] = { 0, 0 };
+		for (unsigned i = 0; i < conv.n_stars && i < 2; ++i) {
+			stars[i] = (int)entry->args[n_args++].i;
+		}
+		const LV2_Log_Deferred_Arg* a = &entry->args[n_args++];
+
+		// Format conversion into buffer
+		char* const  out   = buf + len;
+		const size_t space = size - len;
+		int          n     = 0;
+#define LV2_LOG_FORMAT_ARG(value) \
+		n = (conv.n_stars == 0 ? snprintf(out, space, spec, value) : \
+		     conv.n_stars == 1 ? snprintf(out, space, spec, stars[0], value) : \
+		     snprintf(out, space, spec, stars[0], stars[1], value))
+
+		switch (conv.kind) {
+		case LV2_LOG_ARG_NONE:
+		case LV2_LOG_ARG_INVALID:
+			break;
+		case LV2_LOG_ARG_INT:     LV2_LOG_FORMAT_ARG((int)a->i); break;
+		case LV2_LOG_ARG_LONG:    LV2_LOG_FORMAT_ARG((long)a->i); break;
+		case LV2_LOG_ARG_LLONG:   LV2_LOG_FORMAT_ARG((long long)a->i); break;
+		case LV2_LOG_ARG_UINT:    LV2_LOG_FORMAT_ARG((unsigned)a->u); break;
+		case LV2_LOG_ARG_ULONG:   LV2_LOG_FORMAT_ARG((unsigned long)a->u); break;
+		case LV2_LOG_ARG_ULLONG:  LV2_LOG_FORMAT_ARG((unsigned long long)a->u); break;
+		case LV2_LOG_ARG_SIZE:    LV2_LOG_FORMAT_ARG((size_t)a->u); break;
+		case LV2_LOG_ARG_DOUBLE:  LV2_LOG_FORMAT_ARG(a->d); break;
+		case LV2_LOG_ARG_LDOUBLE: LV2_LOG_FORMAT_ARG((long double)a->d); break;
+		case LV2_LOG_ARG_STRING:  LV2_LOG_FORMAT_ARG(entry->strings + a->u); break;
+		case LV2_LOG_ARG_POINTER: LV2_LOG_FORMAT_ARG(a->p); break;
+		}
+#undef LV2_LOG_FORMAT_ARG
+
+		if (n < 0) {
+			break;
+		}
+
+		len += ((size_t)n < space) ? (size_t)n : space - 1;
+		c = conv.end - 1;
+	}
+
+	buf[len] = '\0';
+	return (int)len;
+}
+
+/**
+   Format and forward all recorded messages to the logger.
+
+   This is not realtime safe, and should be called from a non-realtime thread,
+   such as a worker, or by the host after run().  If any messages have been
+   dropped since the last drain, a warning with the number of dropped messages
+   is logged first.
+
+   @return The number of messages forwarded.
+*/
+static inline uint32_t
+lv2_log_deferred_drain(LV2_Log_Deferred* deferred)
+{
+	LV2_Log_Logger* const logger = deferred->logger;
+
+	const uint32_t n_dropped = LV2_LOG_LOAD_ACQUIRE(&deferred->n_dropped);
+	if (n_dropped != deferred->n_reported) {
+		lv2_log_deferred_forward(logger, logger->Warning,
+		                         "Dropped %u deferred log messages\n",
+		                         n_dropped - deferred->n_reported);
+		deferred->n_reported = n_dropped;
+	}
+
+	const uint32_t write_head = LV2_LOG_LOAD_ACQUIRE(&deferred->write_head);
+	uint32_t       read_head  = deferred->read_head;
+	uint32_t       n_drained  = 0;
+	for (; read_head != write_head; ++read_head, ++n_drained) {
+		const LV2_Log_Deferred_Entry* entry =
+			&deferred->entries[read_head & (LV2_LOG_DEFERRED_CAPACITY - 1)];
+
+		char line[512];
+		lv2_log_deferred_format(entry, line, sizeof(line));
+		lv2_log_deferred_forward(logger, entry->type, "%s", line);
+		LV2_LOG_STORE_RELEASE(&deferred->read_head, read_head + 1);
+	}
+
+	return n_drained;
+}
+
+/**
+   @}
+*/
+
+/**
+   @name Rate Limiting
+   @{
+
+   A log limiter is a log sink which protects another log from floods of
+   messages, for example when a plugin receives a malformed event stream and
+   logs the same error for every event in every cycle.
+
+   The limiter provides an LV2_Log_Log interface, so it can be used anywhere a
+   log is, either by a host to wrap the log it passes to plugins, or by a
+   plugin to wrap the log provided by the host.  It applies two kinds of
+   limiting before forwarding messages:
+
+   Deduplication: After a message is forwarded, further messages with the same
+   type and format string are suppressed until the end of the deduplication
+   window, at which point a summary with the number of repeats is logged.
+   Format strings are compared by pointer, not contents, which is cheap and
+   works well for the usual case of string literals.  Arguments are not
+   compared, so messages with different arguments but the same format are
+   considered repeats.
+
+   Rate limits: Each message type can be given a token bucket, with a rate in
+   messages per second and a maximum burst.  Messages that arrive when the
+   bucket is empty are dropped and counted, and a summary is logged once
+   tokens are available again.  Dropped messages are not deduplicated, so the
+   next message that is forwarded starts a new window.
+
+   The limiter has no clock of its own.  Time is advanced by calling
+   lv2_log_limiter_update(), which is also when summaries are logged, so this
+   should be called regularly, for example once per cycle.  A limiter is not
+   thread safe, so all calls must be made from one thread at a time.
+*/
+
+/** Number of distinct messages that can be deduplicated at once. */
+#ifndef LV2_LOG_LIMITER_SLOTS
+#    define LV2_LOG_LIMITER_SLOTS 16
+#endif
+
+/** Maximum number of message types with rate limits (including default). */
+#ifndef LV2_LOG_LIMITER_MAX_LIMITS
+#    define LV2_LOG_LIMITER_MAX_LIMITS 8
+#endif
+
+/** A recently logged message. */
+typedef struct {
+	LV2_URID    type;       /**< Message type */
+	const char* fmt;        /**< Format string, or NULL if slot is free */
+	double      start;      /**< Time the message was first logged */
+	uint32_t    n_repeats;  /**< Number of repeats suppressed since start */
+} LV2_Log_Limiter_Slot;
+
+/** A token bucket for messages of a particular type. */
+typedef struct {
+	LV2_URID type;       /**< Message type, or zero for any other type */
+	double   rate;       /**< Tokens added per second */
+	double   burst;      /**< Maximum number of tokens */
+	double   tokens;     /**< Number of tokens currently available */
+	uint32_t n_dropped;  /**< Messages dropped since last summary */
+	LV2_URID last_type;  /**< Type of last dropped message */
+} LV2_Log_Limiter_Bucket;
+
+/**
+   Log limiter state.
+*/
+typedef struct {
+	LV2_Log_Log            log;        /**< Interface for logging messages */
+	LV2_Log_Log*           sink;       /**< Log to forward messages to */
+	double                 window;     /**< Deduplication window in seconds */
+	double                 now;        /**< Current time in seconds */
+	uint32_t               n_buckets;  /**< Number of rate limits */
+	LV2_Log_Limiter_Slot   slots[LV2_LOG_LIMITER_SLOTS];
+	LV2_Log_Limiter_Bucket buckets[LV2_LOG_LIMITER_MAX_LIMITS];
+} LV2_Log_Limiter;
+
+/** @cond */
+LV2_LOG_FUNC(3, 4)
+static inline int
+lv2_log_limiter_emit(LV2_Log_Limiter* limiter,
+                     LV2_URID         type,
+                     const char*      fmt,
+                     ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const int ret = (limiter->sink
+	                 ? limiter->sink->vprintf(limiter->sink->handle,
+	                                          type, fmt, args)
+	                 : vfprintf(stderr, fmt, args));
+	va_end(args);
+	return ret;
+}
+
+static inline void
+lv2_log_limiter_flush_slot(LV2_Log_Limiter* limiter, LV2_Log_Limiter_Slot* slot)
+{
+	if (slot->n_repeats) {
+		// Print format string without trailing newline as a message "name"
+		size_t len = strlen(slot->fmt);
+		if (len > 0 && slot->fmt[len - 1] == '\n') {
+			--len;
+		}
+
+		lv2_log_limiter_emit(limiter, slot->type,
+		                     "Message \"%.*s\" repeated %u times\n",
+		                     (int)len, slot->fmt, slot->n_repeats);
+	}
+
+	slot->type      = 0;
+	slot->fmt       = NULL;
+	slot->n_repeats = 0;
+}
+
+static inline LV2_Log_Limiter_Bucket*
+lv2_log_limiter_bucket(LV2_Log_Limiter* limiter, LV2_URID type)
+{
+	LV2_Log_Limiter_Bucket* fallback = NULL;
+	for (uint32_t i = 0; i < limiter->n_buckets; ++i) {
+		if (limiter->buckets[i].type == type) {
+			return &limiter->buckets[i];
+		} else if (!limiter->buckets[i].type) {
+			fallback = &limiter->buckets[i];
+		}
+	}
+
+	return fallback;
+}
+/** @endcond */
+
+/**
+   Log a message through the limiter.
+
+   This is the vprintf() method of the limiter's log interface, and can also
+   be called directly.  If the message is suppressed, it returns zero.
+*/
+LV2_LOG_FUNC(3, 0)
+static inline int
+lv2_log_limiter_vprintf(LV2_Log_Handle handle,
+                        LV2_URID       type,
+                        const char*    fmt,
+                        va_list        args)
+{
+	LV2_Log_Limiter* const limiter = (LV2_Log_Limiter*)handle;
+
+	// Find this message, or the free or oldest slot to replace
+	LV2_Log_Limiter_Slot* slot   = NULL;
+	LV2_Log_Limiter_Slot* oldest = &limiter->slots[0];
+	for (uint32_t i = 0; i < LV2_LOG_LIMITER_SLOTS; ++i) {
+		LV2_Log_Limiter_Slot* const s = &limiter->slots[i];
+		if (s->fmt == fmt && s->type == type) {
+			slot = s;
+			break;
+		} else if (!s->fmt) {
+			oldest = s;
+		} else if (oldest->fmt && s->start < oldest->start) {
+			oldest = s;
+		}
+	}
+
+	if (slot && limiter->now - slot->start < limiter->window) {
+		++slot->n_repeats;  // Repeat within window, suppress
+		return 0;
+	}
+
+	// Take a token from the bucket for this type, if there is one
+	LV2_Log_Limiter_Bucket* const bucket = lv2_log_limiter_bucket(limiter, type);
+	if (bucket) {
+		if (bucket->tokens < 1.0) {
+			// Drop without starting a window, since the message is not logged
+			++bucket->n_dropped;
+			bucket->last_type = type;
+			return 0;
+		}
+		bucket->tokens -= 1.0;
+	}
+
+	// Start a new window for this message
+	if (!slot) {
+		slot = oldest;
+	}
+	lv2_log_limiter_flush_slot(limiter, slot);
+	slot->type  = type;
+	slot->fmt   = fmt;
+	slot->start = limiter->now;
+
+	return (limiter->sink
+	        ? limiter->sink->vprintf(limiter->sink->handle, type, fmt, args)
+	        : vfprintf(stderr, fmt, args));
+}
+
+/**
+   Log a message through the limiter.
+
+   This is the printf() method of the limiter's log interface.
+*/
+LV2_LOG_FUNC(3, 4)
+static inline int
+lv2_log_limiter_printf(LV2_Log_Handle handle,
+                       LV2_URID       type,
+                       const char*    fmt,
+                       ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const int ret = lv2_log_limiter_vprintf(handle, type, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+/**
+   Initialise a log limiter which forwards messages to `sink`.
+
+   The sink may be NULL, in which case messages are printed to stderr.
+   Initially, there are no rate limits, and repeated messages are suppressed
+   for `window` seconds.  A window of zero disables deduplication.
+*/
+static inline void
+lv2_log_limiter_init(LV2_Log_Limiter* limiter, LV2_Log_Log* sink, double window)
+{
+	memset(limiter, 0, sizeof(LV2_Log_Limiter));
+	limiter->log.handle  = limiter;
+	limiter->log.printf  = lv2_log_limiter_printf;
+	limiter->log.vprintf = lv2_log_limiter_vprintf;
+	limiter->sink        = sink;
+	limiter->window      = window;
+}
+
+/**
+   Limit messages of `type` to `rate` per second, with bursts up to `burst`.
+
+   If `type` is zero, the limit applies to all types without a limit of
+   their own.  Setting the limit for a type again replaces it.
+
+   @return True on success, or false if there are too many limits.
+*/
+static inline bool
+lv2_log_limiter_set_limit(LV2_Log_Limiter* limiter,
+                          LV2_URID         type,
+                          double           rate,
+                          double           burst)
+{
+	LV2_Log_Limiter_Bucket* bucket = NULL;
+	for (uint32_t i = 0; i < limiter->n_buckets; ++i) {
+		if (limiter->buckets[i].type == type) {
+			bucket = &limiter->buckets[i];
+			break;
+		}
+	}
+
+	if (!bucket) {
+		if (limiter->n_buckets == LV2_LOG_LIMITER_MAX_LIMITS) {
+			return false;
+		}
+		bucket = &limiter->buckets[limiter->n_buckets++];
+		bucket->n_dropped = 0;
+	}
+
+	bucket->type   = type;
+	bucket->rate   = rate;
+	bucket->burst  = burst;
+	bucket->tokens = burst;
+	return true;
+}
+
+/**
+   Advance the limiter's clock to `now` seconds, and log any summaries.
+
+   This refills the token buckets, and ends deduplication windows that have
+   expired.  A summary is logged for every message that was repeated within
+   its window, and for every type with messages dropped due to rate limits,
+   once a token is available to log it.
+*/
+static inline void
+lv2_log_limiter_update(LV2_Log_Limiter* limiter, double now)
+{
+	const double elapsed = now > limiter->now ? now - limiter->now : 0.0;
+	limiter->now = now;
+
+	// Refill buckets, and report dropped messages if possible
+	for (uint32_t i = 0; i < limiter->n_buckets; ++i) {
+		LV2_Log_Limiter_Bucket* const bucket = &limiter->buckets[i];
+
+		bucket->tokens += bucket->rate * elapsed;
+		if (bucket->tokens > bucket->burst) {
+			bucket->tokens = bucket->burst;
+		}
+
+		if (bucket->n_dropped && bucket->tokens >= 1.0) {
+			lv2_log_limiter_emit(limiter, bucket->last_type,
+			                     "Rate limit dropped %u messages\n",
+			                     bucket->n_dropped);
+			bucket->tokens   -= 1.0;
+			bucket->n_dropped = 0;
+		}
+	}
+
+	// End expired deduplication windows
+	for (uint32_t i = 0; i < LV2_LOG_LIMITER_SLOTS; ++i) {
+		LV2_Log_Limiter_Slot* const slot = &limiter->slots[i];
+		if (slot->fmt && now - slot->start >= limiter->window) {
+			lv2_log_limiter_flush_slot(limiter, slot);
+		}
+	}
+}
+
+/**
+   @}
+*/
+
 #ifdef __cplusplus
 }  /* extern "C" */
 #endif
@@ -37,6 +37,7 @@
 #define LV2_STATE_PREFIX LV2_STATE_URI "#"                 ///< http://lv2plug.in/ns/ext/state#
 
 #define LV2_STATE__State             LV2_STATE_PREFIX "State"              ///< http://lv2plug.in/ns/ext/state#State
+#define LV2_STATE__incremental       LV2_STATE_PREFIX "incremental"        ///< http://lv2plug.in/ns/ext/state#incremental
 #define LV2_STATE__interface         LV2_STATE_PREFIX "interface"          ///< http://lv2plug.in/ns/ext/state#interface
 #define LV2_STATE__loadDefaultState  LV2_STATE_PREFIX "loadDefaultState"   ///< http://lv2plug.in/ns/ext/state#loadDefaultState
 #define LV2_STATE__makePath          LV2_STATE_PREFIX "makePath"           ///< http://lv2plug.in/ns/ext/state#makePath
@@ -351,6 +352,32 @@ typedef struct {
 	              const char*                path);
 } LV2_State_Make_Path;
 
+/**
+   Feature data for state:incremental (@ref LV2_STATE__incremental).
+*/
+typedef struct {
+	/**
+	   The generation returned by a previous save, or zero.
+
+	   This is set by the host before calling LV2_State_Interface.save().  If
+	   it is non-zero, the plugin may store only the properties that have
+	   changed since the save which returned this generation.  If it is zero,
+	   the plugin MUST store its complete state.
+	*/
+	uint32_t since;
+
+	/**
+	   The generation of this save.
+
+	   This is set by the plugin before LV2_State_Interface.save() returns, to
+	   a non-zero value which is greater than the generation of any previous
+	   save of the same instance.  The host MUST set this to zero before
+	   calling save(), so if it is still zero afterwards, the plugin does not
+	   support this feature and has stored its complete state.
+	*/
+	uint32_t generation;
+} LV2_State_Incremental;
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,276 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @defgroup recorder Recorder
+   @ingroup trace
+
+   A simple implementation of the tracer feature for hosts.
+
+   A recorder records complete regions (with a start and end time) into a
+   lock-free ring buffer, which can be written as JSON in the Trace Event
+   Format by another thread, for viewing in Chrome (chrome://tracing) or
+   Perfetto.  Each recorder appears in the trace as a separate track.
+
+   There must be at most one thread recording into a recorder at any time.
+   The usual way to ensure this is to give every plugin instance its own
+   recorder, since run() is never called concurrently for an instance.  The
+   host can record its own regions, for example around each call to run(),
+   using the same recorder with lv2_trace_begin() and lv2_trace_end().
+
+   @{
+*/
+
+#ifndef LV2_TRACE_RECORDER_H
+#define LV2_TRACE_RECORDER_H
+
+#include "lv2/trace/trace.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum nesting depth of recorded regions. */
+#ifndef LV2_TRACE_RECORDER_MAX_DEPTH
+#    define LV2_TRACE_RECORDER_MAX_DEPTH 16
+#endif
+
+/** @cond */
+#ifdef __GNUC__
+#    define LV2_TRACE_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#    define LV2_TRACE_STORE_RELEASE(ptr, val) \
+	__atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#else
+#    define LV2_TRACE_LOAD_ACQUIRE(ptr) (*(volatile const uint32_t*)(ptr))
+#    define LV2_TRACE_STORE_RELEASE(ptr, val) \
+	(*(volatile uint32_t*)(ptr) = (val))
+#endif
+/** @endcond */
+
+/**
+   A clock which returns the current time in nanoseconds.
+
+   This is called in the audio thread, so must be realtime safe, for example
+   by calling clock_gettime() with CLOCK_MONOTONIC.
+*/
+typedef uint64_t (*LV2_Trace_Clock)(void* handle);
+
+/** A recorded region. */
+typedef struct {
+	const char* name;   /**< Region name */
+	uint64_t    start;  /**< Start time in nanoseconds */
+	uint64_t    end;    /**< End time in nanoseconds */
+} LV2_Trace_Region;
+
+/**
+   Trace recorder state.
+*/
+typedef struct {
+	LV2_Trace_Tracer  tracer;        /**< Tracer interface for plugin */
+	const char*       name;          /**< Track name */
+	uint32_t          id;            /**< Track ID (tid in output) */
+	LV2_Trace_Clock   clock;         /**< Clock for timestamps */
+	void*             clock_handle;  /**< Handle passed to clock */
+	LV2_Trace_Region* regions;       /**< Ring of complete regions */
+	uint32_t          capacity;      /**< Size of ring, a power of 2 */
+	uint32_t          write_head;    /**< Next region to write (recorder) */
+	uint32_t          read_head;     /**< Next region to read (writer) */
+	uint32_t          n_dropped;     /**< Total regions dropped (recorder) */
+	uint32_t          depth;         /**< Current nesting depth (recorder) */
+	LV2_Trace_Region  stack[LV2_TRACE_RECORDER_MAX_DEPTH];  /**< Open regions */
+} LV2_Trace_Recorder;
+
+/** @cond */
+static inline void
+lv2_trace_recorder_begin(LV2_Trace_Handle handle, const char* name)
+{
+	LV2_Trace_Recorder* const recorder = (LV2_Trace_Recorder*)handle;
+	if (recorder->depth < LV2_TRACE_RECORDER_MAX_DEPTH) {
+		LV2_Trace_Region* const region = &recorder->stack[recorder->depth];
+		region->name  = name;
+		region->start = recorder->clock(recorder->clock_handle);
+	}
+
+	++recorder->depth;
+}
+
+static inline void
+lv2_trace_recorder_end(LV2_Trace_Handle handle, const char* name)
+{
+	LV2_Trace_Recorder* const recorder = (LV2_Trace_Recorder*)handle;
+	if (recorder->depth == 0) {
+		return;  // Unbalanced end, ignore
+	} else if (--recorder->depth >= LV2_TRACE_RECORDER_MAX_DEPTH) {
+		return;  // Region too deep to be recorded
+	}
+
+	(void)name;
+
+	const uint32_t write_head = recorder->write_head;
+	const uint32_t read_head  = LV2_TRACE_LOAD_ACQUIRE(&recorder->read_head);
+	if (write_head - read_head >= recorder->capacity) {
+		LV2_TRACE_STORE_RELEASE(&recorder->n_dropped, recorder->n_dropped + 1);
+		return;
+	}
+
+	LV2_Trace_Region* const region =
+		&recorder->regions[write_head & (recorder->capacity - 1)];
+
+	*region     = recorder->stack[recorder->depth];
+	region->end = recorder->clock(recorder->clock_handle);
+	LV2_TRACE_STORE_RELEASE(&recorder->write_head, write_head + 1);
+}
+
+static inline void
+lv2_trace_write_json_string(FILE* stream, const char* str)
+{
+	fputc('"', stream);
+	for (const char* c = str; *c; ++c) {
+		if (*c == '"' || *c == '\\') {
+			fprintf(stream, "\\%c", *c);
+		} else if ((unsigned char)*c < 0x20) {
+			fprintf(stream, "\\u%04x", (unsigned)*c);
+		} else {
+			fputc(*c, stream);
+		}
+	}
+	fputc('"', stream);
+}
+/** @endcond */
+
+/**
+   Initialise a recorder.
+
+   @param recorder The recorder to initialise.
+   @param id Unique ID for this recorder, used as the thread ID in the trace.
+   @param name Human readable name, used as the thread name in the trace.
+   @param regions Storage for recorded regions.
+   @param capacity Number of elements in `regions`, which must be a power of 2.
+   @param clock Clock used for timestamps.
+   @param clock_handle Opaque pointer passed to `clock`.
+
+   The recorder's tracer can then be passed to a plugin as the data for the
+   LV2_TRACE__tracer feature.
+*/
+static inline void
+lv2_trace_recorder_init(LV2_Trace_Recorder* recorder,
+                        uint32_t            id,
+                        const char*         name,
+                        LV2_Trace_Region*   regions,
+                        uint32_t            capacity,
+                        LV2_Trace_Clock     clock,
+                        void*               clock_handle)
+{
+	memset(recorder, 0, sizeof(LV2_Trace_Recorder));
+	recorder->tracer.handle = recorder;
+	recorder->tracer.begin  = lv2_trace_recorder_begin;
+	recorder->tracer.end    = lv2_trace_recorder_end;
+	recorder->name          = name;
+	recorder->id            = id;
+	recorder->clock         = clock;
+	recorder->clock_handle  = clock_handle;
+	recorder->regions       = regions;
+	recorder->capacity      = capacity;
+}
+
+/**
+   Read the next recorded region into `region`.
+
+   This may be called by one thread concurrently with recording.
+
+   @return True if a region was read, false if there are none left.
+*/
+static inline bool
+lv2_trace_recorder_read(LV2_Trace_Recorder* recorder, LV2_Trace_Region* region)
+{
+	const uint32_t read_head  = recorder->read_head;
+	const uint32_t write_head = LV2_TRACE_LOAD_ACQUIRE(&recorder->write_head);
+	if (read_head == write_head) {
+		return false;
+	}
+
+	*region = recorder->regions[read_head & (recorder->capacity - 1)];
+	LV2_TRACE_STORE_RELEASE(&recorder->read_head, read_head + 1);
+	return true;
+}
+
+/**
+   Write all recorded regions as a JSON trace.
+
+   This writes a complete JSON document in the Trace Event Format, with a
+   track for every recorder.  Regions are consumed as they are written, so
+   calling this periodically writes a series of traces with no overlap.
+   This is not realtime safe, but may be called concurrently with recording.
+
+   @param stream Stream to write to.
+   @param recorders Array of pointers to recorders.
+   @param n_recorders Number of elements in `recorders`.
+   @param pid Process ID used for all tracks in the trace.
+   @return The number of regions written.
+*/
+static inline uint32_t
+lv2_trace_write_json(FILE*                      stream,
+                     LV2_Trace_Recorder* const* recorders,
+                     uint32_t                   n_recorders,
+                     uint32_t                   pid)
+{
+	uint32_t n_written = 0;
+	fprintf(stream, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	for (uint32_t i = 0; i < n_recorders; ++i) {
+		LV2_Trace_Recorder* const recorder = recorders[i];
+
+		// Metadata event to name the track
+		fprintf(stream,
+		        "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+		        "\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",
+		        i ? "," : "", pid, recorder->id);
+		lv2_trace_write_json_string(stream, recorder->name);
+		fprintf(stream, ",\"dropped\":%u}}",
+		        LV2_TRACE_LOAD_ACQUIRE(&recorder->n_dropped));
+
+		// Complete event for every region (with times in microseconds)
+		LV2_Trace_Region region;
+		while (lv2_trace_recorder_read(recorder, &region)) {
+			fprintf(stream, ",\n{\"name\":");
+			lv2_trace_write_json_string(stream, region.name);
+			fprintf(stream,
+			        ",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,"
+			        "\"ts\":%.3f,\"dur\":%.3f}",
+			        pid, recorder->id,
+			        (double)region.start / 1000.0,
+			        (double)(region.end - region.start) / 1000.0);
+			++n_written;
+		}
+	}
+	fprintf(stream, "\n]}\n");
+
+	return n_written;
+}
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif  /* LV2_TRACE_RECORDER_H */
+
+/**
+   @}
+*/
@@ -0,0 +1,150 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#include "lv2/trace/recorder.h"
+#include "lv2/trace/trace.h"
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define N_REGIONS 4
+
+static int
+test_fail(const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	fprintf(stderr, "error: ");
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+	return 1;
+}
+
+/** Fake clock which advances by 1000ns every time it is read. */
+static uint64_t
+tick(void* handle)
+{
+	uint64_t* now = (uint64_t*)handle;
+	return (*now += 1000);
+}
+
+static int
+test_regions(void)
+{
+	LV2_Trace_Region   regions[N_REGIONS];
+	LV2_Trace_Recorder recorder;
+	uint64_t           now = 0;
+	lv2_trace_recorder_init(
+		&recorder, 1, "test", regions, N_REGIONS, tick, &now);
+
+	// Record nested regions, which are completed inner first
+	const LV2_Trace_Tracer* tracer = &recorder.tracer;
+	lv2_trace_begin(tracer, "run");
+	lv2_trace_begin(tracer, "render");
+	lv2_trace_end(tracer, "render");
+	lv2_trace_end(tracer, "run");
+
+	LV2_Trace_Region region;
+	if (!lv2_trace_recorder_read(&recorder, &region) ||
+	    strcmp(region.name, "render") ||
+	    region.start != 2000 || region.end != 3000) {
+		return test_fail("Bad inner region\n");
+	} else if (!lv2_trace_recorder_read(&recorder, &region) ||
+	           strcmp(region.name, "run") ||
+	           region.start != 1000 || region.end != 4000) {
+		return test_fail("Bad outer region\n");
+	} else if (lv2_trace_recorder_read(&recorder, &region)) {
+		return test_fail("Read past end of recorded regions\n");
+	}
+
+	// Overflow the ring, which drops the newest regions
+	for (unsigned i = 0; i < N_REGIONS + 2; ++i) {
+		lv2_trace_begin(tracer, "handle_event");
+		lv2_trace_end(tracer, "handle_event");
+	}
+	if (recorder.n_dropped != 2) {
+		return test_fail("Dropped %u regions, not 2\n", recorder.n_dropped);
+	}
+
+	// Unbalanced end is ignored
+	lv2_trace_end(tracer, "run");
+	if (recorder.depth != 0) {
+		return test_fail("Unbalanced end changed depth\n");
+	}
+
+	// NULL tracer does nothing
+	lv2_trace_begin(NULL, "run");
+	lv2_trace_end(NULL, "run");
+
+	return 0;
+}
+
+static int
+test_json(void)
+{
+	LV2_Trace_Region   regions[N_REGIONS];
+	LV2_Trace_Recorder recorder;
+	uint64_t           now = 0;
+	lv2_trace_recorder_init(
+		&recorder, 7, "eg-\"amp\"", regions, N_REGIONS, tick, &now);
+
+	lv2_trace_begin(&recorder.tracer, "render");
+	lv2_trace_end(&recorder.tracer, "render");
+
+	FILE* stream = tmpfile();
+	if (!stream) {
+		return test_fail("Failed to open temporary file\n");
+	}
+
+	LV2_Trace_Recorder* recorders[] = { &recorder };
+	if (lv2_trace_write_json(stream, recorders, 1, 42) != 1) {
+		fclose(stream);
+		return test_fail("Wrong number of regions written\n");
+	}
+
+	char   buf[1024];
+	size_t len = 0;
+	rewind(stream);
+	len      = fread(buf, 1, sizeof(buf) - 1, stream);
+	buf[len] = '\0';
+	fclose(stream);
+
+	static const char* const expected =
+		"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":42,\"tid\":7,"
+		"\"args\":{\"name\":\"eg-\\\"amp\\\"\",\"dropped\":0}},\n"
+		"{\"name\":\"render\",\"ph\":\"X\",\"pid\":42,\"tid\":7,"
+		"\"ts\":1.000,\"dur\":1.000}\n"
+		"]}\n";
+
+	if (strcmp(buf, expected)) {
+		return test_fail("Unexpected JSON:\n%s", buf);
+	}
+
+	return 0;
+}
+
+int
+main(void)
+{
+	if (test_regions() || test_json()) {
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,106 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @defgroup trace Trace
+
+   Interface for plugins to mark regions of code for timing by the host; see
+   <http://lv2plug.in/ns/ext/trace> for details.
+
+   @{
+*/
+
+#ifndef LV2_TRACE_H
+#define LV2_TRACE_H
+
+#define LV2_TRACE_URI    "http://lv2plug.in/ns/ext/trace"  ///< http://lv2plug.in/ns/ext/trace
+#define LV2_TRACE_PREFIX LV2_TRACE_URI "#"                 ///< http://lv2plug.in/ns/ext/trace#
+
+#define LV2_TRACE__tracer LV2_TRACE_PREFIX "tracer"  ///< http://lv2plug.in/ns/ext/trace#tracer
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Opaque pointer to host data for LV2_Trace_Tracer.
+*/
+typedef void* LV2_Trace_Handle;
+
+/**
+   Tracer feature (LV2_TRACE__tracer)
+*/
+typedef struct _LV2_Trace_Tracer {
+	/**
+	   Opaque pointer to host data.
+
+	   This MUST be passed to methods in this struct whenever they are called.
+	   Otherwise, it must not be interpreted in any way.
+	*/
+	LV2_Trace_Handle handle;
+
+	/**
+	   Mark the beginning of a region named `name`.
+
+	   The name is not copied, so it must remain valid for the lifetime of the
+	   plugin instance, which is the case for string literals.  This function
+	   is realtime safe, and may be called from any context where the plugin
+	   is running, but not concurrently by several threads.
+	*/
+	void (*begin)(LV2_Trace_Handle handle, const char* name);
+
+	/**
+	   Mark the end of the region most recently begun.
+
+	   Regions must be properly nested, and `name` must be the name passed to
+	   the matching call to begin().  This function is realtime safe.
+	*/
+	void (*end)(LV2_Trace_Handle handle, const char* name);
+} LV2_Trace_Tracer;
+
+/**
+   Begin a region if `tracer` is non-NULL.
+
+   This allows plugins to trace unconditionally when the feature is optional.
+*/
+static inline void
+lv2_trace_begin(const LV2_Trace_Tracer* tracer, const char* name)
+{
+	if (tracer) {
+		tracer->begin(tracer->handle, name);
+	}
+}
+
+/**
+   End a region if `tracer` is non-NULL.
+*/
+static inline void
+lv2_trace_end(const LV2_Trace_Tracer* tracer, const char* name)
+{
+	if (tracer) {
+		tracer->end(tracer->handle, name);
+	}
+}
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif  /* LV2_TRACE_H */
+
+/**
+   @}
+*/
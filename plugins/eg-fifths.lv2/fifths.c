@@ -15,11 +15,14 @@
   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
+#include "./midi_pipeline.h"
 #include "./uris.h"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
+#include "lv2/clone/clone.h"
 #include "lv2/core/lv2.h"
+#include "lv2/core/lv2_resources.h"
 #include "lv2/core/lv2_util.h"
 #include "lv2/log/log.h"
 #include "lv2/log/logger.h"
@@ -45,8 +48,13 @@ typedef struct {
 	const LV2_Atom_Sequence* in_port;
 	LV2_Atom_Sequence*       out_port;
 
-	// URIs
-	FifthsURIs uris;
+	// URIs, shared with other instances if possible
+	LV2_Resource_Store* resources;
+	const FifthsURIs*   uris;
+
+	// Transforms applied to input
+	int8_t       interval;
+	MidiPipeline pipeline;
 } Fifths;
 
 static void
@@ -67,6 +75,40 @@ connect_port(LV2_Handle instance,
 	}
 }
 
+/**
+   Arguments for creating the URIDs shared by every instance.
+*/
+typedef struct {
+	LV2_URID_Map* map;    // URID map feature
+	const Fifths* proto;  // Prototype to copy from, or NULL
+} FifthsResourceArgs;
+
+static void*
+create_uris(void* arg, size_t* size)
+{
+	const FifthsResourceArgs* const args = (const FifthsResourceArgs*)arg;
+	FifthsURIs* const uris = (FifthsURIs*)malloc(sizeof(FifthsURIs));
+	if (uris) {
+		*size = sizeof(FifthsURIs);
+		if (args->proto) {
+			*uris = *args->proto->uris;
+		} else {
+			map_fifths_uris(args->map, uris);
+		}
+	}
+
+	return uris;
+}
+
+static void
+cleanup(LV2_Handle instance)
+{
+	Fifths* const self = (Fifths*)instance;
+
+	lv2_resource_release(self->resources, (void*)self->uris, free);
+	free(self);
+}
+
 static LV2_Handle
 instantiate(const LV2_Descriptor*     descriptor,
             double                    rate,
@@ -92,29 +134,36 @@ instantiate(const LV2_Descriptor*     descriptor,
 		return NULL;
 	}
 
-	map_fifths_uris(self->map, &self->uris);
+	/* Share URIDs with other instances in the library that use the same
+	   map, otherwise copy them from a prototype instance if given, or map
+	   them. */
+	FifthsResourceArgs args = {
+		self->map, (const Fifths*)lv2_clone_prototype(features, descriptor) };
 
-	return (LV2_Handle)self;
-}
+	self->resources = lv2_resource_store(descriptor, lv2_descriptor(0));
+	self->uris      = (const FifthsURIs*)lv2_resource_acquire(
+		self->resources, "uris", self->map, create_uris, free, &args);
+	if (!self->uris) {
+		free(self);
+		return NULL;
+	}
 
-static void
-cleanup(LV2_Handle instance)
-{
-	free(instance);
+	/* Set up a pipeline with a single transform which adds a note one 5th
+	   (7 semitones) higher than every input note.  Other transforms, such as
+	   midi_transform_transpose() or midi_transform_velocity(), could be added
+	   here, and would all be applied in the same pass over the input. */
+	self->interval = 7;
+	midi_pipeline_init(&self->pipeline, self->uris->midi_Event);
+	midi_pipeline_add(&self->pipeline, midi_transform_harmonize, &self->interval);
+
+	return (LV2_Handle)self;
 }
 
 static void
 run(LV2_Handle instance,
     uint32_t   sample_count)
 {
-	Fifths*     self = (Fifths*)instance;
-	FifthsURIs* uris = &self->uris;
-
-	// Struct for a 3 byte MIDI event, used for writing notes
-	typedef struct {
-		LV2_Atom_Event event;
-		uint8_t        msg[3];
-	} MIDINoteEvent;
+	Fifths* self = (Fifths*)instance;
 
 	// Initially self->out_port contains a Chunk with size set to capacity
 
@@ -125,43 +174,11 @@ run(LV2_Handle instance,
 	lv2_atom_sequence_clear(self->out_port);
 	self->out_port->atom.type = self->in_port->atom.type;
 
-	// Read incoming events
-	LV2_ATOM_SEQUENCE_FOREACH(self->in_port, ev) {
-		if (ev->body.type == uris->midi_Event) {
-			const uint8_t* const msg = (const uint8_t*)(ev + 1);
-			switch (lv2_midi_message_type(msg)) {
-			case LV2_MIDI_MSG_NOTE_ON:
-			case LV2_MIDI_MSG_NOTE_OFF:
-				// Forward note to output
-				lv2_atom_sequence_append_event(
-					self->out_port, out_capacity, ev);
-
-				if (msg[1] <= 127 - 7) {
-					// Make a note one 5th (7 semitones) higher than input
-					MIDINoteEvent fifth;
-
-					// Could simply do fifth.event = *ev here instead...
-					fifth.event.time.frames = ev->time.frames;  // Same time
-					fifth.event.body.type   = ev->body.type;    // Same type
-					fifth.event.body.size   = ev->body.size;    // Same size
-
-					fifth.msg[0] = msg[0];      // Same status
-					fifth.msg[1] = msg[1] + 7;  // Pitch up 7 semitones
-					fifth.msg[2] = msg[2];      // Same velocity
-
-					// Write 5th event
-					lv2_atom_sequence_append_event(
-						self->out_port, out_capacity, &fifth.event);
-				}
-				break;
-			default:
-				// Forward all other MIDI events directly
-				lv2_atom_sequence_append_event(
-					self->out_port, out_capacity, ev);
-				break;
-			}
-		}
-	}
+	/* Rewrite incoming MIDI events to the output.  Each note is forwarded,
+	   followed by its fifth, and all other MIDI events are forwarded
+	   directly. */
+	midi_pipeline_run(
+		&self->pipeline, self->in_port, self->out_port, out_capacity);
 }
 
 static const void*
@@ -191,3 +208,10 @@ const LV2_Descriptor* lv2_descriptor(uint32_t index)
 		return NULL;
 	}
 }
+
+LV2_SYMBOL_EXPORT
+const LV2_Lib_Descriptor*
+lv2_lib_descriptor(const char* bundle_path, const LV2_Feature* const* features)
+{
+	return lv2_resource_lib_new(lv2_descriptor);
+}
@@ -0,0 +1,181 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark for the MIDI pipeline.
+
+   Processes a dense block of short MIDI messages through a chain of
+   transforms (filter, channel map, transpose, velocity curve, and harmonize),
+   first as a series of separate passes which append events one at a time
+   with lv2_atom_sequence_append_event(), as a chain of plugins would, then
+   with midi_pipeline_run().  Results are printed as tab-separated lines of
+   name, number of input events per block, and ns per input event.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "midi_pipeline.h"
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/util.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MIDI_EVENT   1
+#define N_STAGES     5
+#define N_EVENTS     10000
+#define N_REPEATS    200
+#define OUT_CAPACITY (2 * N_EVENTS * MIDI_PIPELINE_EVENT_SIZE)
+
+typedef struct {
+	LV2_Atom_Event event;
+	uint8_t        msg[3];
+} MIDINoteEvent;
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static LV2_Atom_Sequence*
+new_sequence(uint32_t capacity)
+{
+	LV2_Atom_Sequence* seq = (LV2_Atom_Sequence*)calloc(
+		1, sizeof(LV2_Atom_Sequence) + capacity);
+	lv2_atom_sequence_clear(seq);
+	return seq;
+}
+
+/** Make a dense block of notes and controllers on random channels. */
+static void
+make_input(LV2_Atom_Sequence* seq, uint32_t n_events)
+{
+	uint32_t rng = 1;
+	for (uint32_t i = 0; i < n_events; ++i) {
+		rng = rng * 1664525u + 1013904223u;
+
+		const uint8_t types[] = { 0x90, 0x80, 0xB0, 0xA0 };
+		const uint8_t type    = types[(rng >> 8) & 3];
+		MIDINoteEvent ev;
+		ev.event.time.frames = i / 16;
+		ev.event.body.type   = MIDI_EVENT;
+		ev.event.body.size   = 3;
+		ev.msg[0]            = (uint8_t)(type | ((rng >> 12) & 0xF));
+		ev.msg[1]            = (uint8_t)((rng >> 16) & 0x7F);
+		ev.msg[2]            = (uint8_t)((rng >> 24) & 0x7F);
+		lv2_atom_sequence_append_event(seq, n_events * 24, &ev.event);
+	}
+}
+
+/** Run one transform over `in` as a separate pass, appending events singly. */
+static void
+run_pass(const MidiTransform*     stage,
+         const LV2_Atom_Sequence* in,
+         LV2_Atom_Sequence*       out)
+{
+	lv2_atom_sequence_clear(out);
+	LV2_ATOM_SEQUENCE_FOREACH(in, ev) {
+		MidiPipelineEvent events[MIDI_PIPELINE_MAX_FANOUT];
+		events[0].frames = ev->time.frames;
+		events[0].size   = ev->body.size;
+		memcpy(events[0].msg, ev + 1, 3);
+
+		const uint32_t n = stage->func(stage->data, events, 1);
+		for (uint32_t i = 0; i < n; ++i) {
+			MIDINoteEvent note;
+			note.event.time.frames = events[i].frames;
+			note.event.body.type   = MIDI_EVENT;
+			note.event.body.size   = events[i].size;
+			memcpy(note.msg, events[i].msg, 3);
+			lv2_atom_sequence_append_event(out, OUT_CAPACITY, &note.event);
+		}
+	}
+}
+
+int
+main(void)
+{
+	static const uint8_t channels[16] = {
+		1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+
+	const uint8_t mask  = 0x07;  // Note off, note on, and note pressure
+	const int8_t  up    = 2;
+	const int8_t  fifth = 7;
+	uint8_t       curve[128];
+	for (unsigned i = 0; i < 128; ++i) {
+		curve[i] = (uint8_t)(i * i / 127);
+	}
+
+	MidiPipeline pipeline;
+	midi_pipeline_init(&pipeline, MIDI_EVENT);
+	midi_pipeline_add(&pipeline, midi_transform_filter, &mask);
+	midi_pipeline_add(&pipeline, midi_transform_channel, channels);
+	midi_pipeline_add(&pipeline, midi_transform_transpose, &up);
+	midi_pipeline_add(&pipeline, midi_transform_velocity, curve);
+	midi_pipeline_add(&pipeline, midi_transform_harmonize, &fifth);
+
+	LV2_Atom_Sequence* in = new_sequence(N_EVENTS * 24);
+	LV2_Atom_Sequence* a  = new_sequence(OUT_CAPACITY);
+	LV2_Atom_Sequence* b  = new_sequence(OUT_CAPACITY);
+	make_input(in, N_EVENTS);
+
+	// Separate passes, ping-ponging between two buffers
+	double start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		const LV2_Atom_Sequence* src = in;
+		LV2_Atom_Sequence*       dst = a;
+		for (unsigned s = 0; s < N_STAGES; ++s) {
+			run_pass(&pipeline.stages[s], src, dst);
+			src = dst;
+			dst = (dst == a) ? b : a;
+		}
+	}
+	const double passes_ns = (now() - start) / N_REPEATS / N_EVENTS;
+
+	// Keep the result of the passes to check the pipeline against
+	LV2_Atom_Sequence* expected = (N_STAGES % 2) ? a : b;
+
+	// Single pass pipeline
+	LV2_Atom_Sequence* out = new_sequence(OUT_CAPACITY);
+	start = now();
+	for (unsigned r = 0; r < N_REPEATS; ++r) {
+		lv2_atom_sequence_clear(out);
+		midi_pipeline_run(&pipeline, in, out, OUT_CAPACITY);
+	}
+	const double pipeline_ns = (now() - start) / N_REPEATS / N_EVENTS;
+
+	if (out->atom.size != expected->atom.size ||
+	    memcmp(out + 1, expected + 1, out->atom.size - sizeof(out->body))) {
+		fprintf(stderr, "error: Pipeline output differs from passes\n");
+		return 1;
+	}
+
+	printf("passes\t%u\t%.2f\n", N_EVENTS, passes_ns);
+	printf("pipeline\t%u\t%.2f\n", N_EVENTS, pipeline_ns);
+
+	free(out);
+	free(b);
+	free(a);
+	free(in);
+	return 0;
+}
@@ -0,0 +1,372 @@
+/*
+  LV2 MIDI Pipeline
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   This file defines a pipeline of MIDI transforms, which rewrites an input
+   sequence of MIDI events into an output sequence in a single pass.
+
+   A transform is a function which works on a small array of short MIDI
+   messages in place.  The pipeline passes each input message through every
+   transform in turn, so a transform may modify messages (like transpose),
+   remove them (like a filter), or add new ones (like harmonize), and later
+   transforms see the result.  Any number of transforms can be chained this
+   way without writing the intermediate results to a sequence in between.
+
+   Rather than appending events to the output one at a time, which checks the
+   remaining capacity for every event, output messages are collected into a
+   batch which is written with a single capacity check.  Since every short
+   MIDI message pads to the same size, a batch is simply written at a fixed
+   stride.  Longer messages, like system exclusive, are not transformed and
+   are copied to the output unchanged.
+*/
+
+#ifndef MIDI_PIPELINE_H
+#define MIDI_PIPELINE_H
+
+#include "lv2/atom/atom.h"
+#include "lv2/atom/util.h"
+#include "lv2/midi/midi.h"
+#include "lv2/urid/urid.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Maximum number of transforms in a pipeline. */
+#define MIDI_PIPELINE_MAX_STAGES 8
+
+/** Maximum number of messages transforms may make from one input message. */
+#define MIDI_PIPELINE_MAX_FANOUT 8
+
+/** Number of messages collected before writing to the output. */
+#define MIDI_PIPELINE_BATCH_SIZE 64
+
+/** Size of a short MIDI event in a sequence, including padding. */
+#define MIDI_PIPELINE_EVENT_SIZE (sizeof(LV2_Atom_Event) + sizeof(uint64_t))
+
+/** A short MIDI message with a time stamp. */
+typedef struct {
+	int64_t  frames;  ///< Time in frames relative to the start of the block
+	uint32_t size;    ///< Size of message in bytes (1 to 3)
+	uint8_t  msg[4];  ///< Message (status, data1, data2)
+} MidiPipelineEvent;
+
+/**
+   A function which transforms a set of messages in place.
+
+   Messages may be modified, removed, or added, but there must be at most
+   MIDI_PIPELINE_MAX_FANOUT messages afterwards.
+
+   @param data Transform parameters.
+   @param events Array of messages, with space for MIDI_PIPELINE_MAX_FANOUT.
+   @param n_events Number of messages in `events`.
+   @return The number of messages in `events` after the transform.
+*/
+typedef uint32_t (*MidiTransformFunc)(const void*        data,
+                                      MidiPipelineEvent* events,
+                                      uint32_t           n_events);
+
+/** A transform and its parameters, one stage in a pipeline. */
+typedef struct {
+	MidiTransformFunc func;
+	const void*       data;
+} MidiTransform;
+
+typedef struct {
+	MidiTransform stages[MIDI_PIPELINE_MAX_STAGES];
+	uint32_t      n_stages;
+	LV2_URID      midi_Event;
+} MidiPipeline;
+
+/** Return true iff `msg` is a message with a note number in the first byte. */
+static inline bool
+midi_is_key_message(const uint8_t* msg)
+{
+	switch (lv2_midi_message_type(msg)) {
+	case LV2_MIDI_MSG_NOTE_ON:
+	case LV2_MIDI_MSG_NOTE_OFF:
+	case LV2_MIDI_MSG_NOTE_PRESSURE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+   Transpose notes by an interval.
+
+   The data is a pointer to an int8_t interval in semitones.  Notes which
+   would be transposed out of range are removed.
+*/
+static inline uint32_t
+midi_transform_transpose(const void*        data,
+                         MidiPipelineEvent* events,
+                         uint32_t           n_events)
+{
+	const int8_t interval = *(const int8_t*)data;
+	uint32_t     n_out    = 0;
+	for (uint32_t i = 0; i < n_events; ++i) {
+		MidiPipelineEvent ev = events[i];
+		if (midi_is_key_message(ev.msg)) {
+			const int note = ev.msg[1] + interval;
+			if (note < 0 || note > 127) {
+				continue;
+			}
+			ev.msg[1] = (uint8_t)note;
+		}
+		events[n_out++] = ev;
+	}
+	return n_out;
+}
+
+/**
+   Map the velocity of note ons through a curve.
+
+   The data is a table of 128 output velocities, indexed by input velocity.
+   A note on with velocity 0 is a note off, so is left unchanged, and a note
+   on is never mapped to velocity 0.
+*/
+static inline uint32_t
+midi_transform_velocity(const void*        data,
+                        MidiPipelineEvent* events,
+                        uint32_t           n_events)
+{
+	const uint8_t* const curve = (const uint8_t*)data;
+	for (uint32_t i = 0; i < n_events; ++i) {
+		uint8_t* const msg = events[i].msg;
+		if (lv2_midi_message_type(msg) == LV2_MIDI_MSG_NOTE_ON && msg[2] > 0) {
+			const uint8_t velocity = curve[msg[2] & 0x7F];
+			msg[2]                 = velocity ? velocity : 1;
+		}
+	}
+	return n_events;
+}
+
+/**
+   Map channel messages to different channels.
+
+   The data is a table of 16 output channels, indexed by input channel.
+*/
+static inline uint32_t
+midi_transform_channel(const void*        data,
+                       MidiPipelineEvent* events,
+                       uint32_t           n_events)
+{
+	const uint8_t* const channels = (const uint8_t*)data;
+	for (uint32_t i = 0; i < n_events; ++i) {
+		uint8_t* const msg = events[i].msg;
+		if (msg[0] >= 0x80 && msg[0] < 0xF0) {
+			const uint8_t channel = channels[msg[0] & 0x0F] & 0x0F;
+			msg[0]                = (uint8_t)((msg[0] & 0xF0) | channel);
+		}
+	}
+	return n_events;
+}
+
+/**
+   Remove messages by type.
+
+   The data is a pointer to a uint8_t mask, where bit N is set to keep
+   messages with status (0x80 + N * 0x10), that is, bit 0 for note off up to
+   bit 7 for system messages.
+*/
+static inline uint32_t
+midi_transform_filter(const void*        data,
+                      MidiPipelineEvent* events,
+                      uint32_t           n_events)
+{
+	const uint8_t mask  = *(const uint8_t*)data;
+	uint32_t      n_out = 0;
+	for (uint32_t i = 0; i < n_events; ++i) {
+		const uint8_t status = events[i].msg[0];
+		if (status >= 0x80 && (mask & (1u << ((status >> 4) - 8)))) {
+			events[n_out++] = events[i];
+		}
+	}
+	return n_out;
+}
+
+/**
+   Add a note at an interval from every note on and off.
+
+   The data is a pointer to an int8_t interval in semitones.  The new note is
+   added immediately after the original, and only if it is in range.
+*/
+static inline uint32_t
+midi_transform_harmonize(const void*        data,
+                         MidiPipelineEvent* events,
+                         uint32_t           n_events)
+{
+	const int8_t interval = *(const int8_t*)data;
+
+	// Count the notes to add
+	uint32_t n_notes = 0;
+	for (uint32_t i = 0; i < n_events; ++i) {
+		const uint8_t type = lv2_midi_message_type(events[i].msg);
+		const int     note = events[i].msg[1] + interval;
+		if ((type == LV2_MIDI_MSG_NOTE_ON || type == LV2_MIDI_MSG_NOTE_OFF) &&
+		    note >= 0 && note <= 127) {
+			++n_notes;
+		}
+	}
+
+	if (n_notes == 0 || n_events + n_notes > MIDI_PIPELINE_MAX_FANOUT) {
+		return n_events;
+	}
+
+	// Spread messages out from the end, so every message is moved only once
+	uint32_t o = n_events + n_notes;
+	for (uint32_t i = n_events; i-- > 0;) {
+		const MidiPipelineEvent ev   = events[i];
+		const uint8_t           type = lv2_midi_message_type(ev.msg);
+		const int               note = ev.msg[1] + interval;
+		if ((type == LV2_MIDI_MSG_NOTE_ON || type == LV2_MIDI_MSG_NOTE_OFF) &&
+		    note >= 0 && note <= 127) {
+			events[--o]      = ev;
+			events[o].msg[1] = (uint8_t)note;
+		}
+		events[--o] = ev;
+	}
+
+	return n_events + n_notes;
+}
+
+/** Initialise an empty pipeline which processes events of type midi_Event. */
+static inline void
+midi_pipeline_init(MidiPipeline* pipeline, LV2_URID midi_Event)
+{
+	memset(pipeline, 0, sizeof(MidiPipeline));
+	pipeline->midi_Event = midi_Event;
+}
+
+/**
+   Add a transform to the end of a pipeline.
+
+   @return False if the pipeline is full.
+*/
+static inline bool
+midi_pipeline_add(MidiPipeline*     pipeline,
+                  MidiTransformFunc func,
+                  const void*       data)
+{
+	if (pipeline->n_stages == MIDI_PIPELINE_MAX_STAGES) {
+		return false;
+	}
+
+	pipeline->stages[pipeline->n_stages].func = func;
+	pipeline->stages[pipeline->n_stages].data = data;
+	++pipeline->n_stages;
+	return true;
+}
+
+/**
+   Write a batch of short messages to the end of `seq`.
+
+   The space required for the batch is checked once, and as many messages as
+   fit are written.
+
+   @return The number of messages which did not fit.
+*/
+static inline uint32_t
+midi_pipeline_write(LV2_Atom_Sequence*       seq,
+                    uint32_t                 capacity,
+                    LV2_URID                 midi_Event,
+                    const MidiPipelineEvent* events,
+                    uint32_t                 n_events)
+{
+	const uint32_t space = capacity - seq->atom.size;
+	uint32_t       n_fit = space / MIDI_PIPELINE_EVENT_SIZE;
+	if (n_fit > n_events) {
+		n_fit = n_events;
+	}
+
+	uint8_t* out = (uint8_t*)lv2_atom_sequence_end(&seq->body, seq->atom.size);
+	for (uint32_t i = 0; i < n_fit; ++i) {
+		LV2_Atom_Event* const ev = (LV2_Atom_Event*)out;
+		ev->time.frames = events[i].frames;
+		ev->body.size   = events[i].size;
+		ev->body.type   = midi_Event;
+		memcpy(ev + 1, events[i].msg, sizeof(events[i].msg));
+		out += MIDI_PIPELINE_EVENT_SIZE;
+	}
+
+	seq->atom.size += n_fit * (uint32_t)MIDI_PIPELINE_EVENT_SIZE;
+	return n_events - n_fit;
+}
+
+/**
+   Run every MIDI event in `in` through the pipeline, appending to `out`.
+
+   Events which are not MIDI are ignored.  The output sequence must already
+   have a header, for example written with lv2_atom_sequence_clear().
+
+   @return The number of events which did not fit in the output.
+*/
+static inline uint32_t
+midi_pipeline_run(const MidiPipeline*      pipeline,
+                  const LV2_Atom_Sequence* in,
+                  LV2_Atom_Sequence*       out,
+                  uint32_t                 out_capacity)
+{
+	MidiPipelineEvent batch[MIDI_PIPELINE_BATCH_SIZE + MIDI_PIPELINE_MAX_FANOUT];
+	uint32_t          n_batch   = 0;
+	uint32_t          n_dropped = 0;
+
+	LV2_ATOM_SEQUENCE_FOREACH(in, ev) {
+		if (ev->body.type != pipeline->midi_Event) {
+			continue;
+		}
+
+		if (ev->body.size == 0 || ev->body.size > 3) {
+			// Long message, write batch so far then copy message directly
+			n_dropped += midi_pipeline_write(
+				out, out_capacity, pipeline->midi_Event, batch, n_batch);
+			n_batch = 0;
+			if (!lv2_atom_sequence_append_event(out, out_capacity, ev)) {
+				++n_dropped;
+			}
+			continue;
+		}
+
+		// Copy short message to the end of the batch
+		MidiPipelineEvent* const events = batch + n_batch;
+		events[0].frames = ev->time.frames;
+		events[0].size   = ev->body.size;
+		memset(events[0].msg, 0, sizeof(events[0].msg));
+		memcpy(events[0].msg, ev + 1, ev->body.size);
+
+		// Transform it in place through every stage
+		uint32_t n_events = 1;
+		for (uint32_t s = 0; s < pipeline->n_stages && n_events; ++s) {
+			const MidiTransform* const stage = &pipeline->stages[s];
+			n_events = stage->func(stage->data, events, n_events);
+		}
+
+		// Write the batch if it is full
+		n_batch += n_events;
+		if (n_batch >= MIDI_PIPELINE_BATCH_SIZE) {
+			n_dropped += midi_pipeline_write(
+				out, out_capacity, pipeline->midi_Event, batch, n_batch);
+			n_batch = 0;
+		}
+	}
+
+	return n_dropped + midi_pipeline_write(
+		out, out_capacity, pipeline->midi_Event, batch, n_batch);
+}
+
+#endif  /* MIDI_PIPELINE_H */
@@ -15,9 +15,13 @@
   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
+#include "tempo_map.h"
+
 #include "lv2/atom/atom.h"
 #include "lv2/atom/util.h"
+#include "lv2/clone/clone.h"
 #include "lv2/core/lv2.h"
+#include "lv2/core/lv2_resources.h"
 #include "lv2/core/lv2_util.h"
 #include "lv2/log/log.h"
 #include "lv2/log/logger.h"
@@ -39,7 +43,9 @@
 
 typedef struct {
 	LV2_URID atom_Blank;
+	LV2_URID atom_Double;
 	LV2_URID atom_Float;
+	LV2_URID atom_Long;
 	LV2_URID atom_Object;
 	LV2_URID atom_Path;
 	LV2_URID atom_Resource;
@@ -47,12 +53,25 @@ typedef struct {
 	LV2_URID time_Position;
 	LV2_URID time_barBeat;
 	LV2_URID time_beatsPerMinute;
+	LV2_URID time_frame;
 	LV2_URID time_speed;
 } MetroURIs;
 
 static const double attack_s = 0.005;
 static const double decay_s  = 0.075;
 
+/**
+   The tone is played from a table with one cycle of a sine wave.  The table
+   has a power of 2 size, so the read position can be a 32-bit fixed point
+   phase, where the top WAVE_BITS bits are the index into the table and the
+   rest are the fraction between entries.  The table has an extra guard entry
+   at the end (a copy of the first) so interpolation never needs to wrap.
+*/
+#define WAVE_BITS      10
+#define WAVE_SIZE      (1u << WAVE_BITS)
+#define WAVE_FRAC_BITS (32u - WAVE_BITS)
+#define WAVE_FRAC_MASK ((1u << WAVE_FRAC_BITS) - 1u)
+
 enum {
 	METRO_CONTROL = 0,
 	METRO_OUT     = 1
@@ -72,14 +91,21 @@ typedef enum {
    enveloping the amplitude so there is a short attack/decay peak around a
    tick, and silence the rest of the time.
 
+   The wave is played with a phase accumulator, which advances by a fixed
+   fraction of a cycle every frame.  Since the phase has a fractional part,
+   the frequency is exact regardless of the sample rate, unlike playing the
+   table one entry per frame, where the length of a cycle must be a whole
+   number of frames.
+
    This example uses a simple AD envelope with fixed parameters.  A more
    sophisticated implementation might use a more advanced envelope and allow
    the user to modify these parameters, the frequency of the wave, and so on.
 */
 typedef struct {
-	LV2_URID_Map*  map;     // URID map feature
-	LV2_Log_Logger logger;  // Logger API
-	MetroURIs      uris;    // Cache of mapped URIDs
+	LV2_URID_Map*       map;        // URID map feature
+	LV2_Log_Logger      logger;     // Logger API
+	LV2_Resource_Store* resources;  // Resources shared with other instances
+	const MetroURIs*    uris;       // Cache of mapped URIDs
 
 	struct {
 		LV2_Atom_Sequence* control;
@@ -87,17 +113,17 @@ typedef struct {
 	} ports;
 
 	// Variables to keep track of the tempo information sent by the host
-	double rate;   // Sample rate
-	float  bpm;    // Beats per minute (tempo)
-	float  speed;  // Transport speed (usually 0=stop, 1=play)
+	double   rate;   // Sample rate
+	TempoMap tempo;  // Tempo and speed over time
+	uint64_t time;   // Frames since activation at the start of this cycle
 
 	uint32_t elapsed_len;  // Frames since the start of the last click
-	uint32_t wave_offset;  // Current play offset in the wave
+	uint32_t phase;        // Current phase in the wave (fixed point)
+	uint32_t phase_inc;    // Phase increment per frame (fixed point)
 	State    state;        // Current play state
 
-	// One cycle of a sine wave
-	float*   wave;
-	uint32_t wave_len;
+	// One cycle of a sine wave, plus a guard point for interpolation
+	const float* wave;
 
 	// Envelope parameters
 	uint32_t attack_len;
@@ -124,7 +150,7 @@ connect_port(LV2_Handle instance,
 }
 
 /**
-   The activate() method resets the state completely, so the wave offset is
+   The activate() method resets the state completely, so the wave phase is
    zero and the envelope is off.
 */
 static void
@@ -133,15 +159,95 @@ activate(LV2_Handle instance)
 	Metro* self = (Metro*)instance;
 
 	self->elapsed_len = 0;
-	self->wave_offset = 0;
+	self->phase       = 0;
 	self->state       = STATE_OFF;
+	self->time        = 0;
+	tempo_map_init(&self->tempo, self->rate, self->tempo.bpm);
+}
+
+/**
+   Arguments for creating the resources shared by every instance.
+*/
+typedef struct {
+	LV2_URID_Map* map;    // URID map feature
+	const Metro*  proto;  // Prototype to copy from, or NULL
+} MetroResourceArgs;
+
+static void*
+create_uris(void* arg, size_t* size)
+{
+	const MetroResourceArgs* const args = (const MetroResourceArgs*)arg;
+	MetroURIs* const uris = (MetroURIs*)malloc(sizeof(MetroURIs));
+	if (!uris) {
+		return NULL;
+	}
+
+	*size = sizeof(MetroURIs);
+	if (args->proto) {
+		*uris = *args->proto->uris;
+		return uris;
+	}
+
+	LV2_URID_Map* const map   = args->map;
+	uris->atom_Blank          = map->map(map->handle, LV2_ATOM__Blank);
+	uris->atom_Double         = map->map(map->handle, LV2_ATOM__Double);
+	uris->atom_Float          = map->map(map->handle, LV2_ATOM__Float);
+	uris->atom_Long           = map->map(map->handle, LV2_ATOM__Long);
+	uris->atom_Object         = map->map(map->handle, LV2_ATOM__Object);
+	uris->atom_Path           = map->map(map->handle, LV2_ATOM__Path);
+	uris->atom_Resource       = map->map(map->handle, LV2_ATOM__Resource);
+	uris->atom_Sequence       = map->map(map->handle, LV2_ATOM__Sequence);
+	uris->time_Position       = map->map(map->handle, LV2_TIME__Position);
+	uris->time_barBeat        = map->map(map->handle, LV2_TIME__barBeat);
+	uris->time_beatsPerMinute = map->map(map->handle,
+	                                     LV2_TIME__beatsPerMinute);
+	uris->time_frame          = map->map(map->handle, LV2_TIME__frame);
+	uris->time_speed          = map->map(map->handle, LV2_TIME__speed);
+	return uris;
+}
+
+static void*
+create_wave(void* arg, size_t* size)
+{
+	const MetroResourceArgs* const args = (const MetroResourceArgs*)arg;
+	float* const wave = (float*)malloc((WAVE_SIZE + 1) * sizeof(float));
+	if (!wave) {
+		return NULL;
+	}
+
+	*size = (WAVE_SIZE + 1) * sizeof(float);
+	if (args->proto) {
+		memcpy(wave, args->proto->wave, *size);
+		return wave;
+	}
+
+	// Generate one cycle of a sine wave, independent of the sample rate
+	const double amp = 0.5;
+	for (uint32_t i = 0; i <= WAVE_SIZE; ++i) {
+		wave[i] = (float)(sin(i * 2 * M_PI / WAVE_SIZE) * amp);
+	}
+	return wave;
+}
+
+static void
+cleanup(LV2_Handle instance)
+{
+	Metro* const self = (Metro*)instance;
+
+	lv2_resource_release(self->resources, (void*)self->wave, free);
+	lv2_resource_release(self->resources, (void*)self->uris, free);
+	free(self);
 }
 
 /**
    This plugin does a bit more work in instantiate() than the previous
    examples.  The tempo updates from the host contain several URIs, so those
-   are mapped, and the sine wave to be played needs to be generated based on
-   the current sample rate.
+   are mapped, and the sine wave to be played needs to be generated.  Both are
+   the same for every instance, so they are resources shared by the whole
+   library if the host loaded it with lv2_lib_descriptor().  Otherwise, each
+   instance has its own copy, which is copied from the prototype if the host
+   provides one.  The URIDs depend on the URID map, so they are only shared
+   between instances with the same map.
 */
 static LV2_Handle
 instantiate(const LV2_Descriptor*     descriptor,
@@ -167,133 +273,222 @@ instantiate(const LV2_Descriptor*     descriptor,
 		return NULL;
 	}
 
-	// Map URIS
-	MetroURIs* const    uris  = &self->uris;
-	LV2_URID_Map* const map   = self->map;
-	uris->atom_Blank          = map->map(map->handle, LV2_ATOM__Blank);
-	uris->atom_Float          = map->map(map->handle, LV2_ATOM__Float);
-	uris->atom_Object         = map->map(map->handle, LV2_ATOM__Object);
-	uris->atom_Path           = map->map(map->handle, LV2_ATOM__Path);
-	uris->atom_Resource       = map->map(map->handle, LV2_ATOM__Resource);
-	uris->atom_Sequence       = map->map(map->handle, LV2_ATOM__Sequence);
-	uris->time_Position       = map->map(map->handle, LV2_TIME__Position);
-	uris->time_barBeat        = map->map(map->handle, LV2_TIME__barBeat);
-	uris->time_beatsPerMinute = map->map(map->handle, LV2_TIME__beatsPerMinute);
-	uris->time_speed          = map->map(map->handle, LV2_TIME__speed);
-
 	// Initialise instance fields
 	self->rate       = rate;
-	self->bpm        = 120.0f;
 	self->attack_len = (uint32_t)(attack_s * rate);
 	self->decay_len  = (uint32_t)(decay_s * rate);
 	self->state      = STATE_OFF;
+	tempo_map_init(&self->tempo, rate, 120.0);
+
+	// Get the URIDs and the wave, which never change
+	MetroResourceArgs args = {
+		self->map, (const Metro*)lv2_clone_prototype(features, descriptor) };
+
+	self->resources = lv2_resource_store(descriptor, lv2_descriptor(0));
+	self->uris      = (const MetroURIs*)lv2_resource_acquire(
+		self->resources, "uris", self->map, create_uris, free, &args);
+	self->wave      = (const float*)lv2_resource_acquire(
+		self->resources, "wave", NULL, create_wave, free, &args);
+	if (!self->uris || !self->wave) {
+		cleanup(self);
+		return NULL;
+	}
 
-	// Generate one cycle of a sine wave at the desired frequency
+	// Calculate the phase increment to play the wave at the desired frequency
 	const double freq = 440.0 * 2.0;
-	const double amp  = 0.5;
-	self->wave_len = (uint32_t)(rate / freq);
-	self->wave     = (float*)malloc(self->wave_len * sizeof(float));
-	for (uint32_t i = 0; i < self->wave_len; ++i) {
-		self->wave[i] = (float)(sin(i * 2 * M_PI * freq / rate) * amp);
-	}
+	self->phase_inc   = (uint32_t)llround(freq / rate * 4294967296.0);
 
 	return (LV2_Handle)self;
 }
 
+/**
+   Write `n` frames of the tone to `out`, with the amplitude starting at `gain`
+   and changing by `step` every frame.  The loop has no branches or divisions,
+   and every frame depends only on the frame index, so the compiler is free to
+   vectorise it.
+*/
 static void
-cleanup(LV2_Handle instance)
+render_tone(Metro* self, float* out, uint32_t n, float gain, float step)
 {
-	free(instance);
+	const float*   wave  = self->wave;
+	const uint32_t phase = self->phase;
+	const uint32_t inc   = self->phase_inc;
+	const float    scale = 1.0f / (float)(1u << WAVE_FRAC_BITS);
+
+	for (uint32_t i = 0; i < n; ++i) {
+		const uint32_t p    = phase + i * inc;
+		const uint32_t idx  = p >> WAVE_FRAC_BITS;
+		const float    frac = (float)(p & WAVE_FRAC_MASK) * scale;
+		const float    tone = wave[idx] + (wave[idx + 1] - wave[idx]) * frac;
+
+		out[i] = tone * (gain + step * (float)i);
+	}
+
+	self->phase = phase + n * inc;
 }
 
 /**
    Play back audio for the range [begin..end) relative to this cycle.  This is
    called by run() in-between events to output audio up until the current time.
+
+   Rather than checking the envelope state for every frame, the range is split
+   into segments where the envelope is a single straight line: the attack, the
+   decay, or silence.  Each segment ends at the next state change, the next
+   beat, or the end of the range, whichever comes first.  The envelope
+   parameters are calculated once for each segment, and then the whole segment
+   is rendered at once.
+
+   The frame where each click starts is found with the tempo map, so clicks
+   are exactly on the beat, even if a beat is not a whole number of frames.
 */
 static void
 play(Metro* self, uint32_t begin, uint32_t end)
 {
-	float* const   output          = self->ports.output;
-	const uint32_t frames_per_beat = 60.0f / self->bpm * self->rate;
+	float* const   output     = self->ports.output;
+	const uint32_t attack_len = self->attack_len;
+	const uint32_t decay_len  = self->decay_len;
 
-	if (self->speed == 0.0f) {
-		memset(output, 0, (end - begin) * sizeof(float));
+	if (self->tempo.speed == 0.0) {
+		memset(output + begin, 0, (end - begin) * sizeof(float));
 		return;
 	}
 
-	for (uint32_t i = begin; i < end; ++i) {
+	uint64_t next_beat = tempo_map_next_beat(&self->tempo, self->time + begin);
+	for (uint32_t i = begin; i < end;) {
+		// Start a new click on every beat
+		if (self->time + i == next_beat) {
+			self->state       = STATE_ATTACK;
+			self->elapsed_len = 0;
+			next_beat = tempo_map_next_beat(&self->tempo, self->time + i + 1);
+		}
+
+		// Find the end of the current envelope segment and its shape
+		uint32_t seg_end = UINT32_MAX;
+		float    gain    = 0.0f;
+		float    step    = 0.0f;
 		switch (self->state) {
 		case STATE_ATTACK:
 			// Amplitude increases from 0..1 until attack_len
-			output[i] = self->wave[self->wave_offset] *
-				self->elapsed_len / (float)self->attack_len;
-			if (self->elapsed_len >= self->attack_len) {
-				self->state = STATE_DECAY;
-			}
+			seg_end = attack_len;
+			step    = 1.0f / (float)attack_len;
+			gain    = (float)self->elapsed_len * step;
 			break;
 		case STATE_DECAY:
 			// Amplitude decreases from 1..0 until attack_len + decay_len
-			output[i] = 0.0f;
-			output[i] = self->wave[self->wave_offset] *
-				(1 - ((self->elapsed_len - self->attack_len) /
-				      (float)self->decay_len));
-			if (self->elapsed_len >= self->attack_len + self->decay_len) {
-				self->state = STATE_OFF;
-			}
+			seg_end = attack_len + decay_len;
+			step    = -1.0f / (float)decay_len;
+			gain    = 1.0f + (float)(self->elapsed_len - attack_len) * step;
 			break;
 		case STATE_OFF:
-			output[i] = 0.0f;
+			break;
 		}
 
-		// We continuously play the sine wave regardless of envelope
-		self->wave_offset = (self->wave_offset + 1) % self->wave_len;
+		// Clip segment to the next beat and the end of the range
+		uint32_t n = end - i;
+		if (seg_end - self->elapsed_len < n) {
+			n = seg_end > self->elapsed_len ? seg_end - self->elapsed_len : 0;
+		}
+		if (next_beat - (self->time + i) < n) {
+			n = (uint32_t)(next_beat - (self->time + i));
+		}
 
-		// Update elapsed time and start attack if necessary
-		if (++self->elapsed_len == frames_per_beat) {
-			self->state       = STATE_ATTACK;
-			self->elapsed_len = 0;
+		// Render the segment (we continuously play the wave regardless)
+		if (self->state == STATE_OFF) {
+			memset(output + i, 0, n * sizeof(float));
+			self->phase += n * self->phase_inc;
+		} else {
+			render_tone(self, output + i, n, gain, step);
 		}
+
+		i += n;
+		self->elapsed_len += n;
+
+		// Move to the next envelope state if the segment is finished
+		if (self->elapsed_len >= seg_end) {
+			if (self->state == STATE_ATTACK) {
+				self->state = STATE_DECAY;
+			} else if (self->state == STATE_DECAY) {
+				self->state = STATE_OFF;
+			}
+		}
+	}
+}
+
+/**
+   Get the value of a numeric atom as a double, if it is a Float or Double.
+*/
+static bool
+get_number(const MetroURIs* uris, const LV2_Atom* atom, double* value)
+{
+	if (atom && atom->type == uris->atom_Float) {
+		*value = ((const LV2_Atom_Float*)atom)->body;
+		return true;
+	} else if (atom && atom->type == uris->atom_Double) {
+		*value = ((const LV2_Atom_Double*)atom)->body;
+		return true;
 	}
+	return false;
 }
 
 /**
    Update the current position based on a host message.  This is called by
-   run() when a time:Position is received.
+   run() when a time:Position is received, with the time of the event.
+
+   A change of tempo or speed is applied to the tempo map from the time of
+   the event, so the beat continues smoothly.  If the position includes a beat
+   or transport frame, the transport is moved there, and the click envelope is
+   synchronised to the new position.
 */
 static void
-update_position(Metro* self, const LV2_Atom_Object* obj)
+update_position(Metro* self, const LV2_Atom_Object* obj, uint64_t time)
 {
-	const MetroURIs* uris = &self->uris;
+	const MetroURIs* uris  = self->uris;
+	TempoMap* const  tempo = &self->tempo;
 
 	// Received new transport position/speed
-	LV2_Atom *beat = NULL, *bpm = NULL, *speed = NULL;
+	LV2_Atom *beat = NULL, *bpm = NULL, *frame = NULL, *speed = NULL;
 	lv2_atom_object_get(obj,
 	                    uris->time_barBeat, &beat,
 	                    uris->time_beatsPerMinute, &bpm,
+	                    uris->time_frame, &frame,
 	                    uris->time_speed, &speed,
 	                    NULL);
-	if (bpm && bpm->type == uris->atom_Float) {
-		// Tempo changed, update BPM
-		self->bpm = ((LV2_Atom_Float*)bpm)->body;
+
+	// Tempo or speed changed, e.g. 0 (stop) to 1 (play)
+	double new_bpm   = tempo->bpm;
+	double new_speed = tempo->speed;
+	get_number(uris, bpm, &new_bpm);
+	get_number(uris, speed, &new_speed);
+	if (new_bpm <= 0.0) {
+		new_bpm = tempo->bpm;
 	}
-	if (speed && speed->type == uris->atom_Float) {
-		// Speed changed, e.g. 0 (stop) to 1 (play)
-		self->speed = ((LV2_Atom_Float*)speed)->body;
+	tempo_map_set_tempo(tempo, time, new_bpm, new_speed);
+
+	// Move the transport if the host has sent a new position
+	double     bar_beats = 0.0;
+	const bool has_frame = frame && frame->type == uris->atom_Long;
+	const double frames  = (has_frame ? (double)((LV2_Atom_Long*)frame)->body
+	                        : tempo_map_frame_at(tempo, time));
+	if (get_number(uris, beat, &bar_beats)) {
+		tempo_map_locate(tempo, time, frames, bar_beats);
+	} else if (has_frame) {
+		tempo_map_locate_frame(tempo, time, frames);
+	} else {
+		return;
 	}
-	if (beat && beat->type == uris->atom_Float) {
-		// Received a beat position, synchronise
-		// This hard sync may cause clicks, a real plugin would be more graceful
-		const float frames_per_beat = 60.0f / self->bpm * self->rate;
-		const float bar_beats       = ((LV2_Atom_Float*)beat)->body;
-		const float beat_beats      = bar_beats - floorf(bar_beats);
-		self->elapsed_len           = beat_beats * frames_per_beat;
-		if (self->elapsed_len < self->attack_len) {
-			self->state = STATE_ATTACK;
-		} else if (self->elapsed_len < self->attack_len + self->decay_len) {
-			self->state = STATE_DECAY;
-		} else {
-			self->state = STATE_OFF;
-		}
+
+	// Synchronise the click to the new position
+	// This hard sync may cause clicks, a real plugin would be more graceful
+	const double beats       = tempo_map_beat_at(tempo, time);
+	const double beat_frames = ((beats - floor(beats)) *
+	                            tempo_map_frames_per_beat(tempo));
+	self->elapsed_len = (uint32_t)beat_frames;
+	if (self->elapsed_len < self->attack_len) {
+		self->state = STATE_ATTACK;
+	} else if (self->elapsed_len < self->attack_len + self->decay_len) {
+		self->state = STATE_DECAY;
+	} else {
+		self->state = STATE_OFF;
 	}
 }
 
@@ -301,35 +496,38 @@ static void
 run(LV2_Handle instance, uint32_t sample_count)
 {
 	Metro*           self = (Metro*)instance;
-	const MetroURIs* uris = &self->uris;
-
-	// Work forwards in time frame by frame, handling events as we go
-	const LV2_Atom_Sequence* in     = self->ports.control;
-	uint32_t                 last_t = 0;
-	for (const LV2_Atom_Event* ev = lv2_atom_sequence_begin(&in->body);
-	     !lv2_atom_sequence_is_end(&in->body, in->atom.size, ev);
-	     ev = lv2_atom_sequence_next(ev)) {
-
-		// Play the click for the time slice from last_t until now
-		play(self, last_t, ev->time.frames);
-
-		// Check if this event is an Object
-		// (or deprecated Blank to tolerate old hosts)
-		if (ev->body.type == uris->atom_Object ||
-		    ev->body.type == uris->atom_Blank) {
-			const LV2_Atom_Object* obj = (const LV2_Atom_Object*)&ev->body;
-			if (obj->body.otype == uris->time_Position) {
-				// Received position information, update
-				update_position(self, obj);
+	const MetroURIs* uris = self->uris;
+
+	/* Work forwards in time slice by slice, handling events as we go.  Every
+	   slice ends exactly at the time of its events, so that the tempo map is
+	   anchored at the frame the host sent the position for.  Events are not
+	   combined into longer slices, since play() renders the click in
+	   segments between envelope changes anyway. */
+	LV2_Atom_Sequence_Slicer slicer;
+	LV2_Atom_Sequence_Slice  slice;
+	lv2_atom_sequence_slicer_init(
+		&slicer, self->ports.control, sample_count, 1);
+	while (lv2_atom_sequence_slicer_next(&slicer, &slice)) {
+		// Play the click for the time slice up until the events
+		play(self, slice.start, slice.end);
+
+		LV2_ATOM_SLICE_FOREACH(&slice, ev) {
+			// Check if this event is an Object
+			// (or deprecated Blank to tolerate old hosts)
+			if (ev->body.type == uris->atom_Object ||
+			    ev->body.type == uris->atom_Blank) {
+				const LV2_Atom_Object* obj = (const LV2_Atom_Object*)&ev->body;
+				if (obj->body.otype == uris->time_Position) {
+					// Received position information, update
+					const uint64_t time = self->time + slice.end;
+					update_position(self, obj, time);
+				}
 			}
 		}
-
-		// Update time for next iteration and move to next event
-		last_t = ev->time.frames;
 	}
 
-	// Play for remainder of cycle
-	play(self, last_t, sample_count);
+	// Advance time to the start of the next cycle
+	self->time += sample_count;
 }
 
 static const LV2_Descriptor descriptor = {
@@ -353,3 +551,15 @@ lv2_descriptor(uint32_t index)
 		return NULL;
 	}
 }
+
+/**
+   Hosts that support it load the library with lv2_lib_descriptor(), which
+   returns the same descriptors as lv2_descriptor(), but with a resource store
+   that is shared by every instance in the library.
+*/
+LV2_SYMBOL_EXPORT const LV2_Lib_Descriptor*
+lv2_lib_descriptor(const char*               bundle_path,
+                   const LV2_Feature* const* features)
+{
+	return lv2_resource_lib_new(lv2_descriptor);
+}
@@ -0,0 +1,175 @@
+/*
+  LV2 Tempo Map
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   This file defines a tempo map, which converts between time in frames and
+   musical time in beats, based on the tempo and transport speed sent by the
+   host in time:Position events.
+
+   Times are absolute frame counts on the plugin's own clock, which counts
+   every frame passed to run() since the plugin was activated.  This is
+   distinct from the transport frame (time:frame) of the host, which stands
+   still when the transport is stopped, and jumps when it is moved.  The map
+   is stored as an anchor, a time with the transport frame and beat position
+   at that time, and both elapse at a constant rate after the anchor until the
+   tempo or speed changes.  A change moves the anchor to the time of the
+   change, so a tempo ramp sent as a series of Position events is followed
+   exactly.
+
+   Since every conversion is a single multiplication from the anchor in double
+   precision, rather than a sum of rounded beat lengths, beat boundaries are
+   found at the correct frame no matter how long the transport rolls.
+*/
+
+#ifndef TEMPO_MAP_H
+#define TEMPO_MAP_H
+
+#include <math.h>
+#include <stdint.h>
+
+/** Time returned when there is no next beat (the transport is stopped). */
+#define TEMPO_MAP_NEVER UINT64_MAX
+
+/** Distance in frames within which a beat is considered to be on a frame. */
+#define TEMPO_MAP_EPSILON 1.0e-6
+
+typedef struct {
+	double   rate;             ///< Sample rate in frames per second
+	double   bpm;              ///< Tempo in beats per minute
+	double   speed;            ///< Transport speed (0 = stopped, 1 = rolling)
+	double   beats_per_frame;  ///< Beats per frame at tempo and speed
+	double   frames_per_beat;  ///< Frames per beat at tempo and speed
+	uint64_t anchor_time;      ///< Time of last change in frames
+	double   anchor_frame;     ///< Transport frame at anchor_time
+	double   anchor_beat;      ///< Beat position at anchor_time
+} TempoMap;
+
+/** Update the cached beat rate after a change to the tempo or speed. */
+static inline void
+tempo_map_update_rate(TempoMap* map)
+{
+	map->beats_per_frame = map->bpm * map->speed / (60.0 * map->rate);
+	map->frames_per_beat = 60.0 * map->rate / (map->bpm * map->speed);
+}
+
+/** Initialise a stopped tempo map at beat zero. */
+static inline void
+tempo_map_init(TempoMap* map, double rate, double bpm)
+{
+	map->rate        = rate;
+	map->bpm         = bpm;
+	map->speed       = 0.0;
+	map->anchor_time  = 0;
+	map->anchor_frame = 0.0;
+	map->anchor_beat  = 0.0;
+	tempo_map_update_rate(map);
+}
+
+/** Return the beat position at `time`, which must be after the anchor. */
+static inline double
+tempo_map_beat_at(const TempoMap* map, uint64_t time)
+{
+	return (map->anchor_beat +
+	        (double)(time - map->anchor_time) * map->beats_per_frame);
+}
+
+/** Return the transport frame at `time`, which must be after the anchor. */
+static inline double
+tempo_map_frame_at(const TempoMap* map, uint64_t time)
+{
+	return map->anchor_frame + (double)(time - map->anchor_time) * map->speed;
+}
+
+/** Return the number of frames per beat at the current tempo. */
+static inline double
+tempo_map_frames_per_beat(const TempoMap* map)
+{
+	return 60.0 * map->rate / map->bpm;
+}
+
+/**
+   Set the tempo and speed from `time` onwards.
+
+   The beat position at `time` is unchanged, so the transport continues
+   smoothly from where it was at the previous tempo and speed.
+*/
+static inline void
+tempo_map_set_tempo(TempoMap* map, uint64_t time, double bpm, double speed)
+{
+	map->anchor_frame = tempo_map_frame_at(map, time);
+	map->anchor_beat  = tempo_map_beat_at(map, time);
+	map->anchor_time  = time;
+	map->bpm          = bpm;
+	map->speed        = speed;
+	tempo_map_update_rate(map);
+}
+
+/** Move the transport to `frame` and `beat` at `time`. */
+static inline void
+tempo_map_locate(TempoMap* map, uint64_t time, double frame, double beat)
+{
+	map->anchor_time  = time;
+	map->anchor_frame = frame;
+	map->anchor_beat  = beat;
+}
+
+/**
+   Move the transport to `frame` at `time`, for example after a seek.
+
+   This is used when the host sends a new frame without a beat position.  The
+   beat is calculated from the distance to the transport frame at the anchor,
+   at the current tempo.
+*/
+static inline void
+tempo_map_locate_frame(TempoMap* map, uint64_t time, double frame)
+{
+	const double beats_per_frame = map->bpm / (60.0 * map->rate);
+	const double beat            = (map->anchor_beat +
+	                                (frame - map->anchor_frame) * beats_per_frame);
+
+	tempo_map_locate(map, time, frame, beat);
+}
+
+/**
+   Return the time of the first frame on or after a beat boundary at or after
+   `time`.
+
+   If `time` is exactly on a beat, `time` is returned.  If the transport is
+   stopped, or moving backwards, TEMPO_MAP_NEVER is returned.
+*/
+static inline uint64_t
+tempo_map_next_beat(const TempoMap* map, uint64_t time)
+{
+	if (map->beats_per_frame <= 0.0) {
+		return TEMPO_MAP_NEVER;
+	}
+
+	// Find the next whole beat (allowing for rounding error if on a beat)
+	const double epsilon   = TEMPO_MAP_EPSILON * map->beats_per_frame;
+	const double next_beat = ceil(tempo_map_beat_at(map, time) - epsilon);
+
+	// Find the (fractional) time of that beat
+	const double beat_time = ((double)map->anchor_time +
+	                          (next_beat - map->anchor_beat) *
+	                          map->frames_per_beat);
+
+	// Round up to the first frame at or after the boundary
+	const double frame = ceil(beat_time - TEMPO_MAP_EPSILON);
+	return frame > (double)time ? (uint64_t)frame : time;
+}
+
+#endif  /* TEMPO_MAP_H */
@@ -31,6 +31,12 @@
 
 #define MIDIGATE_URI "http://lv2plug.in/plugins/eg-midigate"
 
+/** Length of the gain ramp when the gate opens or closes, in seconds. */
+static const double ramp_s = 0.002;
+
+/** Minimum number of frames to write between handling events. */
+static const uint32_t min_span = 16;
+
 typedef enum {
 	MIDIGATE_CONTROL = 0,
 	MIDIGATE_IN      = 1,
@@ -51,8 +57,16 @@ typedef struct {
 		LV2_URID midi_MidiEvent;
 	} uris;
 
-	unsigned n_active_notes;
-	unsigned program;  // 0 = normal, 1 = inverted
+	uint32_t notes[16][4];    // One bit for every note on every channel
+	unsigned n_active_notes;  // Number of bits set in notes
+	unsigned program;         // 0 = normal, 1 = inverted
+
+	// Gain ramp to smooth gate transitions
+	uint32_t ramp_len;        // Length of a complete ramp in frames
+	uint32_t ramp_remaining;  // Frames left in the current ramp
+	float    gain;            // Current gain
+	float    target;          // Gain at the end of the current ramp
+	float    ramp_step;       // Gain increment per frame of the current ramp
 } Midigate;
 
 static LV2_Handle
@@ -82,6 +96,11 @@ instantiate(const LV2_Descriptor*     descriptor,
 	self->uris.midi_MidiEvent = self->map->map(
 		self->map->handle, LV2_MIDI__MidiEvent);
 
+	self->ramp_len = (uint32_t)(rate * ramp_s);
+	if (self->ramp_len == 0) {
+		self->ramp_len = 1;
+	}
+
 	return (LV2_Handle)self;
 }
 
@@ -109,38 +128,128 @@ static void
 activate(LV2_Handle instance)
 {
 	Midigate* self = (Midigate*)instance;
+	memset(self->notes, 0, sizeof(self->notes));
 	self->n_active_notes = 0;
 	self->program        = 0;
+	self->ramp_remaining = 0;
+	self->gain           = 0.0f;
+	self->target         = 0.0f;
+}
+
+/**
+   Rather than simply counting note ons and offs, which goes wrong when the
+   same note is switched on twice (for example on different channels), every
+   note on every channel is tracked individually as a bit in a 16x128 bitset.
+   The count of active notes only changes when a bit actually changes.
+*/
+static void
+set_note(Midigate* self, uint8_t channel, uint8_t note, bool on)
+{
+	uint32_t* const word = &self->notes[channel & 0x0F][(note & 0x7F) >> 5];
+	const uint32_t  bit  = 1u << (note & 0x1F);
+	if (on && !(*word & bit)) {
+		*word |= bit;
+		++self->n_active_notes;
+	} else if (!on && (*word & bit)) {
+		*word &= ~bit;
+		--self->n_active_notes;
+	}
+}
+
+/** Switch off every note on a channel, for the "all notes off" controller. */
+static void
+clear_channel(Midigate* self, uint8_t channel)
+{
+	uint32_t* const words = self->notes[channel & 0x0F];
+	for (unsigned i = 0; i < 4; ++i) {
+		for (uint32_t word = words[i]; word; word &= word - 1) {
+			--self->n_active_notes;  // Count set bits (Kernighan's method)
+		}
+		words[i] = 0;
+	}
+}
+
+/**
+   Return true iff the gate is open, which depends on the program.
+*/
+static bool
+gate_is_open(const Midigate* self)
+{
+	return (self->program == 0)
+		? (self->n_active_notes > 0)
+		: (self->n_active_notes == 0);
+}
+
+/**
+   Start ramping towards the current gate state, if it has changed.  This is
+   called after every event, and starts a ramp from the current gain (which
+   may be part way through another ramp) to the new target.
+*/
+static void
+update_gate(Midigate* self)
+{
+	const float target = gate_is_open(self) ? 1.0f : 0.0f;
+	if (target != self->target) {
+		self->target         = target;
+		self->ramp_step      = (target - self->gain) / (float)self->ramp_len;
+		self->ramp_remaining = self->ramp_len;
+	}
 }
 
 /**
    A function to write a chunk of output, to be called from run().  If the gate
-   is high, then the input will be passed through for this chunk, otherwise
+   is open, then the input will be passed through for this chunk, otherwise
    silence is written.
+
+   When the gate changes, the gain ramps to the new state over a short time,
+   since switching abruptly would cause an audible click.  The ramp is
+   written with a simple loop where every frame is independent, which the
+   compiler can vectorise.  Once the ramp is finished, the steady state is
+   written with memcpy() or memset(), which is as fast as possible.
 */
 static void
 write_output(Midigate* self, uint32_t offset, uint32_t len)
 {
-	const bool active = (self->program == 0)
-		? (self->n_active_notes > 0)
-		: (self->n_active_notes == 0);
-	if (active) {
-		memcpy(self->out + offset, self->in + offset, len * sizeof(float));
+	const float* const in  = self->in + offset;
+	float* const       out = self->out + offset;
+
+	// Write the part of this chunk that is within a ramp
+	uint32_t n_ramp = 0;
+	if (self->ramp_remaining) {
+		n_ramp = len < self->ramp_remaining ? len : self->ramp_remaining;
+
+		const float gain = self->gain;
+		const float step = self->ramp_step;
+		for (uint32_t i = 0; i < n_ramp; ++i) {
+			out[i] = in[i] * (gain + step * (float)(i + 1));
+		}
+
+		self->gain = gain + step * (float)n_ramp;
+		if ((self->ramp_remaining -= n_ramp) == 0) {
+			self->gain = self->target;  // Land exactly on target
+		}
+	}
+
+	// Write the rest of the chunk in the steady state
+	if (self->gain == 1.0f) {
+		memcpy(out + n_ramp, in + n_ramp, (len - n_ramp) * sizeof(float));
 	} else {
-		memset(self->out + offset, 0, len * sizeof(float));
+		memset(out + n_ramp, 0, (len - n_ramp) * sizeof(float));
 	}
 }
 
 /**
-   This plugin works through the cycle in chunks starting at offset zero.  The
-   +offset+ represents the current time within this this cycle, so
-   the output from 0 to +offset+ has already been written.
+   This plugin works through the cycle in slices starting at offset zero, so
+   when a slice is written, the output before the start of the slice has
+   already been written.
 
-   MIDI events are read in a loop.  In each iteration, the number of active
-   notes (on note on and note off) or the program (on program change) is
-   updated, then the output is written up until the current event time.  Then
-   +offset+ is updated and the next event is processed.  After the loop the
-   final chunk from the last event to the end of the cycle is emitted.
+   MIDI events are read in a loop, using a slicer from the atom utilities,
+   which splits the cycle into slices that end at an event.  In each
+   iteration, the output is written for the slice up until the event time,
+   then the active notes (on note on and note off) or the program (on program
+   change) are updated.  Events which are very close together are handled at
+   once, so output is never written in tiny pieces.  The final slice runs from
+   the last event to the end of the cycle, and has no events.
 
    There is currently no standard way to describe MIDI programs in LV2, so the
    host has no way of knowing that these programs exist and should be presented
@@ -148,54 +257,57 @@ write_output(Midigate* self, uint32_t offset, uint32_t len)
 
    This pattern of iterating over input events and writing output along the way
    is a common idiom for writing sample accurate output based on event input.
-
-   Note that this simple example simply writes input or zero for each sample
-   based on the gate.  A serious implementation would need to envelope the
-   transition to avoid aliasing.
 */
 static void
 run(LV2_Handle instance, uint32_t sample_count)
 {
-	Midigate* self   = (Midigate*)instance;
-	uint32_t  offset = 0;
-
-	LV2_ATOM_SEQUENCE_FOREACH(self->control, ev) {
-		if (ev->body.type == self->uris.midi_MidiEvent) {
-			const uint8_t* const msg = (const uint8_t*)(ev + 1);
-			switch (lv2_midi_message_type(msg)) {
-			case LV2_MIDI_MSG_NOTE_ON:
-				++self->n_active_notes;
-				break;
-			case LV2_MIDI_MSG_NOTE_OFF:
-				if (self->n_active_notes > 0) {
-					--self->n_active_notes;
-				}
-				break;
-			case LV2_MIDI_MSG_CONTROLLER:
-				if (msg[1] == LV2_MIDI_CTL_ALL_NOTES_OFF) {
-					self->n_active_notes = 0;
-				}
-				break;
-			case LV2_MIDI_MSG_PGM_CHANGE:
-				if (msg[1] == 0 || msg[1] == 1) {
-					self->program = msg[1];
+	Midigate* self = (Midigate*)instance;
+
+	LV2_Atom_Sequence_Slicer slicer;
+	LV2_Atom_Sequence_Slice  slice;
+	lv2_atom_sequence_slicer_init(
+		&slicer, self->control, sample_count, min_span);
+	while (lv2_atom_sequence_slicer_next(&slicer, &slice)) {
+		write_output(self, slice.start, slice.end - slice.start);
+
+		LV2_ATOM_SLICE_FOREACH(&slice, ev) {
+			if (ev->body.type == self->uris.midi_MidiEvent &&
+			    ev->body.size >= 2) {
+				const uint8_t* const msg     = (const uint8_t*)(ev + 1);
+				const uint8_t        channel = msg[0] & 0x0F;
+				switch (lv2_midi_message_type(msg)) {
+				case LV2_MIDI_MSG_NOTE_ON:
+					// Note on with velocity 0 is a note off
+					if (ev->body.size >= 3) {
+						set_note(self, channel, msg[1], msg[2] > 0);
+					}
+					break;
+				case LV2_MIDI_MSG_NOTE_OFF:
+					set_note(self, channel, msg[1], false);
+					break;
+				case LV2_MIDI_MSG_CONTROLLER:
+					if (msg[1] == LV2_MIDI_CTL_ALL_NOTES_OFF) {
+						clear_channel(self, channel);
+					}
+					break;
+				case LV2_MIDI_MSG_PGM_CHANGE:
+					if (msg[1] == 0 || msg[1] == 1) {
+						self->program = msg[1];
+					}
+					break;
+				default: break;
 				}
-				break;
-			default: break;
+
+				update_gate(self);
 			}
 		}
-
-		write_output(self, offset, ev->time.frames - offset);
-		offset = (uint32_t)ev->time.frames;
 	}
-
-	write_output(self, offset, sample_count - offset);
 }
 
 /**
    We have no resources to free on deactivation.
    Note that the next call to activate will re-initialise the state, namely
-   self->n_active_notes, so there is no need to do so here.
+   the active notes, so there is no need to do so here.
 */
 static void
 deactivate(LV2_Handle instance)
@@ -16,6 +16,7 @@
 */
 
 #include "state_map.h"
+#include "state_smooth.h"
 
 #include "lv2/atom/atom.h"
 #include "lv2/atom/forge.h"
@@ -41,8 +42,11 @@
 
 #define N_PROPS 9
 
+#define N_SMOOTHED 2
+
 typedef struct {
 	LV2_URID plugin;
+	LV2_URID atom_Double;
 	LV2_URID atom_Path;
 	LV2_URID atom_Sequence;
 	LV2_URID atom_URID;
@@ -50,8 +54,10 @@ typedef struct {
 	LV2_URID eg_spring;
 	LV2_URID midi_Event;
 	LV2_URID patch_Get;
+	LV2_URID patch_Patch;
 	LV2_URID patch_Set;
 	LV2_URID patch_Put;
+	LV2_URID patch_add;
 	LV2_URID patch_body;
 	LV2_URID patch_subject;
 	LV2_URID patch_property;
@@ -77,6 +83,7 @@ map_uris(LV2_URID_Map* map, URIs* uris)
 {
 	uris->plugin             = map->map(map->handle, EG_PARAMS_URI);
 
+	uris->atom_Double        = map->map(map->handle, LV2_ATOM__Double);
 	uris->atom_Path          = map->map(map->handle, LV2_ATOM__Path);
 	uris->atom_Sequence      = map->map(map->handle, LV2_ATOM__Sequence);
 	uris->atom_URID          = map->map(map->handle, LV2_ATOM__URID);
@@ -84,8 +91,10 @@ map_uris(LV2_URID_Map* map, URIs* uris)
 	uris->eg_spring          = map->map(map->handle, EG_PARAMS_URI "#spring");
 	uris->midi_Event         = map->map(map->handle, LV2_MIDI__MidiEvent);
 	uris->patch_Get          = map->map(map->handle, LV2_PATCH__Get);
+	uris->patch_Patch        = map->map(map->handle, LV2_PATCH__Patch);
 	uris->patch_Set          = map->map(map->handle, LV2_PATCH__Set);
 	uris->patch_Put          = map->map(map->handle, LV2_PATCH__Put);
+	uris->patch_add          = map->map(map->handle, LV2_PATCH__add);
 	uris->patch_body         = map->map(map->handle, LV2_PATCH__body);
 	uris->patch_subject      = map->map(map->handle, LV2_PATCH__subject);
 	uris->patch_property     = map->map(map->handle, LV2_PATCH__property);
@@ -102,6 +111,8 @@ typedef struct {
 	LV2_URID_Map*   map;
 	LV2_URID_Unmap* unmap;
 	LV2_Log_Logger  log;
+	LV2_Log_Limiter log_limiter;  // Protects host log from floods of errors
+	double          rate;
 
 	// Forge for creating atoms
 	LV2_Atom_Forge forge;
@@ -114,8 +125,18 @@ typedef struct {
 	URIs uris;
 
 	// Plugin state
-	StateMapItem props[N_PROPS];
-	State        state;
+	StateMapItem  props[N_PROPS];
+	StateMapIndex props_index;
+	State         state;
+	StateSmoother smoothers[N_SMOOTHED];
+	uint32_t      generation;  // Generation of changes since the last save
+
+	// Cursor for sending the complete state over several cycles
+	struct {
+		bool     active;  // True iff state is being sent
+		bool     first;   // True iff nothing has been sent yet
+		uint32_t index;   // Index of next property to send
+	} dump;
 
 	// Buffer for making strings from URIDs if unmap is not provided
 	char urid_buf[12];
@@ -159,6 +180,10 @@ instantiate(const LV2_Descriptor*     descriptor,
 		LV2_URID__unmap, &self->unmap,   false,
 		NULL);
 	lv2_log_logger_set_map(&self->log, self->map);
+
+	// Log via a limiter that suppresses repeats within a second
+	lv2_log_limiter_init(&self->log_limiter, self->log.log, 1.0);
+	self->log.log = &self->log_limiter.log;
 	if (missing) {
 		lv2_log_error(&self->log, "Missing feature <%s>\n", missing);
 		free(self);
@@ -168,6 +193,7 @@ instantiate(const LV2_Descriptor*     descriptor,
 	// Map URIs and initialise forge
 	map_uris(self->map, &self->uris);
 	lv2_atom_forge_init(&self->forge, self->map);
+	self->rate = rate;
 
 	// Initialise state dictionary
 	State* state = &self->state;
@@ -184,13 +210,41 @@ instantiate(const LV2_Descriptor*     descriptor,
 		EG_PARAMS_URI "#spring", STATE_MAP_INIT(Float,  &state->spring),
 		NULL);
 
+	/* Changes are made in generation 2 until the first save, which returns
+	   the generation before that, so saves never return zero. */
+	self->generation = 2;
+
+	// Build index for fast lookup by URID in run()
+	state_map_index_init(&self->props_index, self->props, N_PROPS);
+
+	// Initialise smoothers for continuous parameters, with a 20ms ramp
+	const uint32_t ramp_len = (uint32_t)(rate * 0.02);
+	state_smooth_init(
+		&self->smoothers[0],
+		state_map_index_find(
+			&self->props_index,
+			self->map->map(self->map->handle, EG_PARAMS_URI "#float")),
+		self->uris.atom_Double,
+		STATE_SMOOTH_LINEAR,
+		ramp_len);
+	state_smooth_init(
+		&self->smoothers[1],
+		state_map_index_find(
+			&self->props_index,
+			self->map->map(self->map->handle, EG_PARAMS_URI "#lfo")),
+		self->uris.atom_Double,
+		STATE_SMOOTH_EXPONENTIAL,
+		ramp_len);
+
 	return (LV2_Handle)self;
 }
 
 static void
 cleanup(LV2_Handle instance)
 {
-	free(instance);
+	Params* self = (Params*)instance;
+	state_map_index_free(&self->props_index);
+	free(self);
 }
 
 /** Helper function to unmap a URID if possible. */
@@ -205,6 +259,18 @@ unmap(Params* self, LV2_URID urid)
 	}
 }
 
+/** Return the smoother for a state map entry, or NULL if it is not smoothed. */
+static StateSmoother*
+find_smoother(Params* self, const StateMapItem* entry)
+{
+	for (unsigned i = 0; i < N_SMOOTHED; ++i) {
+		if (self->smoothers[i].item == entry) {
+			return &self->smoothers[i];
+		}
+	}
+	return NULL;
+}
+
 static LV2_State_Status
 check_type(Params*  self,
            LV2_URID key,
@@ -231,7 +297,7 @@ set_parameter(Params*     self,
               bool        from_state)
 {
 	// Look up property in state dictionary
-	const StateMapItem* entry = state_map_find(self->props, N_PROPS, key);
+	StateMapItem* entry = state_map_index_find(&self->props_index, key);
 	if (!entry) {
 		lv2_log_trace(&self->log, "Unknown parameter <%s>\n", unmap(self, key));
 		return LV2_STATE_ERR_NO_PROPERTY;
@@ -246,13 +312,26 @@ set_parameter(Params*     self,
 	lv2_log_trace(&self->log, "Set <%s>\n", entry->uri);
 	memcpy(entry->value + 1, body, size);
 	entry->value->size = size;
+	state_map_touch(entry,
+	                __atomic_load_n(&self->generation, __ATOMIC_ACQUIRE));
+
+	// Ramp to new value from the current time, or jump there if restoring
+	StateSmoother* smoother = find_smoother(self, entry);
+	if (smoother) {
+		const float target = state_smooth_item_value(entry, self->uris.atom_Double);
+		if (from_state) {
+			smoother->current = target;
+		}
+		state_smooth_set(smoother, target);
+	}
+
 	return LV2_STATE_SUCCESS;
 }
 
 static const LV2_Atom*
 get_parameter(Params* self, LV2_URID key)
 {
-	const StateMapItem* entry = state_map_find(self->props, N_PROPS, key);
+	const StateMapItem* entry = state_map_index_find(&self->props_index, key);
 	if (entry) {
 		lv2_log_trace(&self->log, "Get <%s>\n", entry->uri);
 		return entry->value;
@@ -320,9 +399,10 @@ store_prop(Params*                  self,
 /**
    State save method.
 
-   This is used in the usual way when called by the host to save plugin state,
-   but also internally for writing messages in the audio thread by passing a
-   "store" function which actually writes the description to the forge.
+   This is called by the host to save plugin state.  If the host supports
+   state:incremental, only the properties that have changed since the given
+   save are stored.  The state sent to the UI is written separately by
+   send_state_chunk().
 */
 static LV2_State_Status
 save(LV2_Handle                instance,
@@ -331,14 +411,31 @@ save(LV2_Handle                instance,
      uint32_t                  flags,
      const LV2_Feature* const* features)
 {
-	Params*             self     = (Params*)instance;
-	LV2_State_Map_Path* map_path = (LV2_State_Map_Path*)lv2_features_data(
-		features, LV2_STATE__mapPath);
+	Params*                self     = (Params*)instance;
+	LV2_State_Map_Path*    map_path = NULL;
+	LV2_State_Incremental* inc      = NULL;
+	lv2_features_query(features,
+	                   LV2_STATE__mapPath,     &map_path, false,
+	                   LV2_STATE__incremental, &inc,      false,
+	                   NULL);
+
+	/* Start a new generation.  The run() thread may still stamp changes with
+	   the old one while the save is in progress, so return the generation
+	   before it, so those changes are stored again by the next save. */
+	const uint32_t generation =
+		__atomic_fetch_add(&self->generation, 1, __ATOMIC_ACQ_REL);
+	const uint32_t since      = inc ? inc->since : 0;
 
 	LV2_State_Status st = LV2_STATE_SUCCESS;
 	for (unsigned i = 0; i < N_PROPS; ++i) {
 		StateMapItem* prop = &self->props[i];
-		store_prop(self, map_path, &st, store, handle, prop->urid, prop->value);
+		if (state_map_is_changed(prop, since)) {
+			store_prop(self, map_path, &st, store, handle, prop->urid, prop->value);
+		}
+	}
+
+	if (inc) {
+		inc->generation = generation - 1;
 	}
 
 	return st;
@@ -385,6 +482,85 @@ restore(LV2_Handle                  instance,
 	return st;
 }
 
+/** Return the space needed to write `value` as a property in an object. */
+static inline uint32_t
+prop_size(const LV2_Atom* value)
+{
+	return (uint32_t)sizeof(LV2_Atom_Property_Body) +
+		lv2_atom_pad_size(value->size);
+}
+
+/**
+   Send as much of the complete state as fits in the output.
+
+   A patch:Get with no property requests the complete state, which may not fit
+   in the output buffer for a single cycle.  The state is sent in chunks, the
+   first as a patch:Put, and any remaining properties as patch:Patch messages
+   which add to it, one per cycle until the dump is finished.
+*/
+static void
+send_state_chunk(Params* self, int64_t frames)
+{
+	LV2_Atom_Forge* forge = &self->forge;
+	const URIs*     uris  = &self->uris;
+
+	// Space used by event header, message object, and body object
+	const uint32_t overhead = (uint32_t)(
+		sizeof(int64_t) + 2 * sizeof(LV2_Atom_Object) +
+		2 * sizeof(uint32_t));
+
+	// Count properties that fit in the space available in this cycle
+	const uint32_t space = forge->size - forge->offset;
+	uint32_t       used  = overhead;
+	uint32_t       end   = self->dump.index;
+	for (; end < N_PROPS; ++end) {
+		const uint32_t size = prop_size(self->props[end].value);
+		if (used + size > space) {
+			break;
+		}
+		used += size;
+	}
+
+	if (end == self->dump.index) {
+		const uint32_t total = (uint32_t)sizeof(LV2_Atom_Sequence) + overhead +
+			prop_size(self->props[end].value);
+		if (total > forge->size) {
+			// Property will never fit in the output, skip it
+			lv2_log_error(&self->log, "No space to send <%s>\n",
+			              self->props[end].uri);
+			++self->dump.index;
+			self->dump.active = self->dump.index < N_PROPS;
+		}
+		return;  // Try again next cycle
+	}
+
+	// Write message for this chunk
+	LV2_Atom_Forge_Frame pframe;
+	lv2_atom_forge_frame_time(forge, frames);
+	if (self->dump.first) {
+		lv2_atom_forge_object(forge, &pframe, 0, uris->patch_Put);
+		lv2_atom_forge_key(forge, uris->patch_body);
+	} else {
+		lv2_atom_forge_object(forge, &pframe, 0, uris->patch_Patch);
+		lv2_atom_forge_key(forge, uris->patch_add);
+	}
+
+	LV2_Atom_Forge_Frame bframe;
+	lv2_atom_forge_object(forge, &bframe, 0, 0);
+	for (uint32_t i = self->dump.index; i < end; ++i) {
+		const StateMapItem* prop = &self->props[i];
+		store_prop(self, NULL, NULL, write_param_to_forge, forge,
+		           prop->urid, prop->value);
+	}
+
+	lv2_atom_forge_pop(forge, &bframe);
+	lv2_atom_forge_pop(forge, &pframe);
+
+	self->dump.first  = false;
+	self->dump.index  = end;
+	self->dump.active = end < N_PROPS;
+}
+
 static inline bool
 subject_is_plugin(Params* self, const LV2_Atom_URID* subject)
 {
@@ -393,6 +569,21 @@ subject_is_plugin(Params* self, const LV2_Atom_URID* subject)
 	                     subject->body      == self->uris.plugin));
 }
 
+/**
+   Advance smoothed parameters over the frames [begin..end).
+
+   This plugin has no audio output, so the smoothed values are only tracked.
+   A plugin that uses parameters for processing would render them to a buffer
+   here with state_smooth_render() and use that as a control signal.
+*/
+static void
+advance_smoothers(Params* self, uint32_t begin, uint32_t end)
+{
+	for (unsigned i = 0; i < N_SMOOTHED; ++i) {
+		state_smooth_render(&self->smoothers[i], NULL, begin, end);
+	}
+}
+
 static void
 run(LV2_Handle instance, uint32_t sample_count)
 {
@@ -410,8 +601,18 @@ run(LV2_Handle instance, uint32_t sample_count)
 	LV2_Atom_Forge_Frame out_frame;
 	lv2_atom_forge_sequence_head(&self->forge, &out_frame, 0);
 
+	// Continue sending state requested in a previous cycle
+	if (self->dump.active) {
+		send_state_chunk(self, 0);
+	}
+
 	// Read incoming events
+	uint32_t offset = 0;
 	LV2_ATOM_SEQUENCE_FOREACH(self->in_port, ev) {
+		// Advance smoothed parameters up to the time of this event
+		advance_smoothers(self, offset, (uint32_t)ev->time.frames);
+		offset = (uint32_t)ev->time.frames;
+
 		const LV2_Atom_Object* obj = (const LV2_Atom_Object*)&ev->body;
 		if (obj->body.otype == uris->patch_Set) {
 			// Get the property and value of the set message
@@ -445,18 +646,11 @@ run(LV2_Handle instance, uint32_t sample_count)
 			if (!subject_is_plugin(self, subject)) {
 				lv2_log_error(&self->log, "Get with unknown subject\n");
 			} else if (!property) {
-				// Get with no property, emit complete state
-				lv2_atom_forge_frame_time(&self->forge, ev->time.frames);
-				LV2_Atom_Forge_Frame pframe;
-				lv2_atom_forge_object(&self->forge, &pframe, 0, uris->patch_Put);
-				lv2_atom_forge_key(&self->forge, uris->patch_body);
-
-				LV2_Atom_Forge_Frame bframe;
-				lv2_atom_forge_object(&self->forge, &bframe, 0, 0);
-				save(self, write_param_to_forge, &self->forge, 0, NULL);
-
-				lv2_atom_forge_pop(&self->forge, &bframe);
-				lv2_atom_forge_pop(&self->forge, &pframe);
+				// Get with no property, emit complete state (from the start)
+				self->dump.active = true;
+				self->dump.first  = true;
+				self->dump.index  = 0;
+				send_state_chunk(self, ev->time.frames);
 			} else if (property->atom.type != uris->atom_URID) {
 				lv2_log_error(&self->log, "Get property is not a URID\n");
 			} else {
@@ -480,9 +674,14 @@ run(LV2_Handle instance, uint32_t sample_count)
 		}
 	}
 
+	// Advance smoothed parameters for the rest of the cycle
+	advance_smoothers(self, offset, sample_count);
+
 	if (self->state.spring.body > 0.0f) {
 		const float spring = self->state.spring.body;
 		self->state.spring.body = (spring >= 0.001) ? spring - 0.001 : 0.0;
+		state_map_touch(state_map_index_find(&self->props_index, uris->eg_spring),
+		                __atomic_load_n(&self->generation, __ATOMIC_ACQUIRE));
 		lv2_atom_forge_frame_time(&self->forge, 0);
 		LV2_Atom_Forge_Frame frame;
 		lv2_atom_forge_object(&self->forge, &frame, 0, uris->patch_Set);
@@ -496,6 +695,10 @@ run(LV2_Handle instance, uint32_t sample_count)
 	}
 
 	lv2_atom_forge_pop(&self->forge, &out_frame);
+
+	// Advance log limiter time, which logs a summary of any repeated messages
+	lv2_log_limiter_update(&self->log_limiter,
+	                       self->log_limiter.now + sample_count / self->rate);
 }
 
 static const void*
@@ -0,0 +1,110 @@
+/*
+  Copyright 2019 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark for state map lookup.
+
+   Compares state_map_find() (binary search) with state_map_index_find() for
+   maps of various sizes, with both dense URIDs (as when a plugin is the first
+   to map its URIs) and sparse URIDs (interleaved with other URIs in the host).
+   Results are printed as tab-separated lines of name, size, and ns per lookup.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "state_map.h"
+
+#include "lv2/atom/atom.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define N_LOOKUPS (1u << 22)
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void
+bench(const char* name, uint32_t n_props, uint32_t stride)
+{
+	StateMapItem*  dict   = (StateMapItem*)calloc(n_props, sizeof(StateMapItem));
+	LV2_Atom_Int*  values = (LV2_Atom_Int*)calloc(n_props, sizeof(LV2_Atom_Int));
+	LV2_URID*      keys   = (LV2_URID*)malloc(N_LOOKUPS * sizeof(LV2_URID));
+	uint32_t       rng    = 1;
+
+	// Make a sorted state map with URIDs separated by up to `stride`
+	LV2_URID urid = 1;
+	for (uint32_t i = 0; i < n_props; ++i) {
+		rng  = rng * 1664525u + 1013904223u;
+		urid += 1 + (rng >> 16) % stride;
+		dict[i].urid  = urid;
+		dict[i].value = &values[i].atom;
+	}
+
+	// Look up keys in a random order
+	for (uint32_t i = 0; i < N_LOOKUPS; ++i) {
+		rng     = rng * 1664525u + 1013904223u;
+		keys[i] = dict[(rng >> 8) % n_props].urid;
+	}
+
+	StateMapIndex index;
+	state_map_index_init(&index, dict, n_props);
+
+	uintptr_t sum   = 0;
+	double    start = now();
+	for (uint32_t i = 0; i < N_LOOKUPS; ++i) {
+		sum += (uintptr_t)state_map_find(dict, n_props, keys[i]);
+	}
+	const double bsearch_ns = (now() - start) / N_LOOKUPS;
+
+	start = now();
+	for (uint32_t i = 0; i < N_LOOKUPS; ++i) {
+		sum -= (uintptr_t)state_map_index_find(&index, keys[i]);
+	}
+	const double index_ns = (now() - start) / N_LOOKUPS;
+
+	if (sum) {
+		fprintf(stderr, "error: Index and search results differ\n");
+	}
+
+	printf("state_map_find/%s\t%u\t%.2f\n", name, n_props, bsearch_ns);
+	printf("state_map_index_find/%s\t%u\t%.2f\n", name, n_props, index_ns);
+
+	state_map_index_free(&index);
+	free(keys);
+	free(values);
+	free(dict);
+}
+
+int
+main(void)
+{
+	static const uint32_t sizes[] = { 10, 100, 1000 };
+
+	for (unsigned i = 0; i < sizeof(sizes) / sizeof(uint32_t); ++i) {
+		bench("dense", sizes[i], 1);
+		bench("sparse", sizes[i], 64);
+	}
+
+	return 0;
+}
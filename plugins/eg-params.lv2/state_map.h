@@ -15,17 +15,24 @@
   OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 
+#ifndef STATE_MAP_H
+#define STATE_MAP_H
+
 #include "lv2/atom/atom.h"
 #include "lv2/urid/urid.h"
 
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /** Entry in an array that serves as a dictionary of properties. */
 typedef struct {
 	const char* uri;
 	LV2_URID    urid;
 	LV2_Atom*   value;
+	uint32_t    generation;  ///< Generation of last change (for state:incremental)
 } StateMapItem;
 
 /** Comparator for StateMapItems sorted by URID. */
@@ -71,7 +78,7 @@ state_map_cmp(const void* a, const void* b)
        PLUG_URI "#file",   STATE_MAP_INIT(Path,   &state->file),
        NULL);
 */
-static void
+static inline void
 state_map_init(StateMapItem        dict[],
                LV2_URID_Map*       map,
                LV2_URID_Map_Handle handle,
@@ -90,6 +97,7 @@ state_map_init(StateMapItem        dict[],
 		dict[i].value       = value;
 		dict[i].value->size = size;
 		dict[i].value->type = map->map(map->handle, type);
+		dict[i].generation  = 0;
 	}
 	va_end(args);
 
@@ -97,6 +105,30 @@ state_map_init(StateMapItem        dict[],
 	qsort(dict, i, sizeof(StateMapItem), state_map_cmp);
 }
 
+/**
+   Mark an item as changed in the given state generation.
+
+   This should be called whenever the value of an item is changed, so that
+   state_map_is_changed() can determine which properties need to be stored
+   for an incremental save.
+*/
+static inline void
+state_map_touch(StateMapItem* item, uint32_t generation)
+{
+	item->generation = generation;
+}
+
+/**
+   Return true iff `item` has changed since the save of generation `since`.
+
+   A `since` of zero refers to no save at all, so every item is changed.
+*/
+static inline bool
+state_map_is_changed(const StateMapItem* item, uint32_t since)
+{
+	return !since || item->generation > since;
+}
+
 /**
    Retrieve an item from a state map by URID.
 
@@ -107,8 +139,240 @@ state_map_init(StateMapItem        dict[],
 static StateMapItem*
 state_map_find(StateMapItem dict[], uint32_t n_entries, LV2_URID urid)
 {
-	const StateMapItem key = { NULL, urid, NULL };
+	const StateMapItem key = { NULL, urid, NULL, 0 };
 	return (StateMapItem*)bsearch(
 		&key, dict, n_entries, sizeof(StateMapItem), state_map_cmp);
 }
 
+/**
+   An index for constant-time lookup in a state map.
+
+   Since the set of properties is fixed after state_map_init(), a perfect hash
+   table can be built once, so lookup is two multiplications, a table lookup
+   for a displacement, and a single key comparison.  When URIDs are densely
+   packed, the table is instead indexed directly by URID offset.
+*/
+typedef struct {
+	StateMapItem*  dict;          ///< Sorted state map
+	uint32_t       n_dict;        ///< Number of entries in dict
+	StateMapItem** slots;         ///< Table of entries, or NULL for fallback
+	uint32_t       n_slots;       ///< Size of slots table
+	uint32_t*      disps;         ///< Displacement per bucket, or NULL if direct
+	LV2_URID       base;          ///< Lowest URID (for direct indexing)
+	uint32_t       hash_mult;     ///< Slot hash multiplier
+	uint32_t       hash_shift;    ///< Slot hash shift
+	uint32_t       bucket_mult;   ///< Bucket hash multiplier
+	uint32_t       bucket_shift;  ///< Bucket hash shift
+} StateMapIndex;
+
+/** Return the base slot hash of `urid`, before displacement. */
+static inline uint32_t
+state_map_index_hash(const StateMapIndex* index, LV2_URID urid)
+{
+	return (uint32_t)(urid * index->hash_mult) >> index->hash_shift;
+}
+
+/** Return the bucket of `urid`, which determines its displacement. */
+static inline uint32_t
+state_map_index_bucket(const StateMapIndex* index, LV2_URID urid)
+{
+	return (uint32_t)(urid * index->bucket_mult) >> index->bucket_shift;
+}
+
+/** Return the smallest power of 2 that is at least `n`, as a number of bits. */
+static inline unsigned
+state_map_index_bits(uint32_t n)
+{
+	unsigned bits = 1;
+	while ((1u << bits) < n) {
+		++bits;
+	}
+	return bits;
+}
+
+/**
+   Try to build a perfect hash table with the current multipliers.
+
+   This uses "hash and displace": keys are divided into small buckets, then
+   starting with the largest, each bucket is assigned a displacement which is
+   XORed with the hash of its keys so they all land in free slots.  The
+   `start` and `members` arrays are scratch space for grouping the keys by
+   bucket.
+*/
+static bool
+state_map_index_place(StateMapIndex* index,
+                      uint32_t       n_buckets,
+                      uint32_t*      start,
+                      uint32_t*      members)
+{
+	const uint32_t n = index->n_dict;
+
+	memset(index->slots, 0, index->n_slots * sizeof(StateMapItem*));
+	memset(index->disps, 0, n_buckets * sizeof(uint32_t));
+
+	// Group keys by bucket with a counting sort
+	memset(start, 0, (n_buckets + 1) * sizeof(uint32_t));
+	uint32_t max_size = 0;
+	for (uint32_t i = 0; i < n; ++i) {
+		const uint32_t b = state_map_index_bucket(index, index->dict[i].urid);
+		if (++start[b + 1] > max_size) {
+			max_size = start[b + 1];
+		}
+	}
+	for (uint32_t b = 0; b < n_buckets; ++b) {
+		start[b + 1] += start[b];
+	}
+	for (uint32_t i = 0; i < n; ++i) {
+		const uint32_t b = state_map_index_bucket(index, index->dict[i].urid);
+		members[start[b]++] = i;
+	}
+	for (uint32_t b = n_buckets; b > 0; --b) {
+		start[b] = start[b - 1];  // Shift back to start of each bucket
+	}
+	start[0] = 0;
+
+	// Place buckets from largest to smallest
+	for (uint32_t size = max_size; size > 0; --size) {
+		for (uint32_t b = 0; b < n_buckets; ++b) {
+			if (start[b + 1] - start[b] != size) {
+				continue;
+			}
+
+			// Find a displacement where every key in this bucket is free
+			bool placed = false;
+			for (uint32_t d = 0; d < index->n_slots && !placed; ++d) {
+				uint32_t k = start[b];
+				for (; k < start[b + 1]; ++k) {
+					StateMapItem*  item = &index->dict[members[k]];
+					const uint32_t slot =
+						state_map_index_hash(index, item->urid) ^ d;
+					if (index->slots[slot]) {
+						break;
+					}
+					index->slots[slot] = item;
+				}
+
+				if (k == start[b + 1]) {
+					index->disps[b] = d;
+					placed          = true;
+				} else {
+					// Collision, undo partial placement and try next d
+					while (k-- > start[b]) {
+						StateMapItem* item = &index->dict[members[k]];
+						index->slots[state_map_index_hash(index, item->urid) ^ d] =
+							NULL;
+					}
+				}
+			}
+
+			if (!placed) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+   Build an index for a state map initialised with state_map_init().
+
+   This allocates memory and is not realtime safe.  If no table can be built,
+   the index falls back to binary search, so lookups always work.  The index
+   must be freed with state_map_index_free().
+*/
+static void
+state_map_index_init(StateMapIndex* index, StateMapItem dict[], uint32_t n_entries)
+{
+	memset(index, 0, sizeof(StateMapIndex));
+	index->dict   = dict;
+	index->n_dict = n_entries;
+	if (n_entries == 0) {
+		return;
+	}
+
+	// Use a direct table if URIDs are dense (dict is sorted by URID)
+	const uint32_t range = dict[n_entries - 1].urid - dict[0].urid + 1;
+	if (range <= 4 * n_entries) {
+		index->slots = (StateMapItem**)calloc(range, sizeof(StateMapItem*));
+		if (index->slots) {
+			index->n_slots = range;
+			index->base    = dict[0].urid;
+			for (uint32_t i = 0; i < n_entries; ++i) {
+				index->slots[dict[i].urid - index->base] = &dict[i];
+			}
+		}
+		return;
+	}
+
+	// Otherwise build a perfect hash table with a load factor of at most 1/2
+	const unsigned slot_bits   = state_map_index_bits(2 * n_entries);
+	const unsigned bucket_bits = state_map_index_bits(n_entries / 2);
+	const uint32_t n_buckets   = 1u << bucket_bits;
+
+	index->n_slots      = 1u << slot_bits;
+	index->hash_shift   = 32 - slot_bits;
+	index->bucket_shift = 32 - bucket_bits;
+	index->slots = (StateMapItem**)malloc(index->n_slots * sizeof(StateMapItem*));
+	index->disps = (uint32_t*)malloc(n_buckets * sizeof(uint32_t));
+
+	uint32_t* start   = (uint32_t*)malloc((n_buckets + 1) * sizeof(uint32_t));
+	uint32_t* members = (uint32_t*)malloc(n_entries * sizeof(uint32_t));
+	bool      built   = false;
+	if (index->slots && index->disps && start && members) {
+		uint32_t rng = 0x9E3779B9u;  // 2^32 / golden ratio
+		for (unsigned attempt = 0; attempt < 16 && !built; ++attempt) {
+			index->hash_mult   = rng | 1u;
+			rng                = rng * 1664525u + 1013904223u;
+			index->bucket_mult = rng | 1u;
+			rng                = rng * 1664525u + 1013904223u;
+			built = state_map_index_place(index, n_buckets, start, members);
+		}
+	}
+
+	free(members);
+	free(start);
+	if (!built) {
+		// Failed, fall back to binary search
+		free(index->disps);
+		free(index->slots);
+		index->disps   = NULL;
+		index->slots   = NULL;
+		index->n_slots = 0;
+	}
+}
+
+/** Free memory allocated by state_map_index_init(). */
+static void
+state_map_index_free(StateMapIndex* index)
+{
+	free(index->disps);
+	free(index->slots);
+	index->disps = NULL;
+	index->slots = NULL;
+}
+
+/**
+   Retrieve an item from an indexed state map by URID.
+
+   This takes O(1) time and is realtime safe.
+*/
+static inline StateMapItem*
+state_map_index_find(const StateMapIndex* index, LV2_URID urid)
+{
+	StateMapItem* item = NULL;
+	if (index->disps) {
+		const uint32_t disp =
+			index->disps[state_map_index_bucket(index, urid)];
+		item = index->slots[state_map_index_hash(index, urid) ^ disp];
+	} else if (index->slots) {
+		const uint32_t slot = urid - index->base;
+		item = (slot < index->n_slots) ? index->slots[slot] : NULL;
+	} else {
+		return state_map_find(index->dict, index->n_dict, urid);
+	}
+
+	return (item && item->urid == urid) ? item : NULL;
+}
+
+#endif  /* STATE_MAP_H */
@@ -0,0 +1,223 @@
+/*
+  LV2 State Smoothing
+  Copyright 2019 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   This file defines a smoother which ramps numeric properties in a state map
+   towards new values, rather than jumping to them instantly.
+
+   The value stored in the state map item is always the target value, so
+   patch:Get and state saving are unaffected.  The smoother tracks the value
+   actually being used for processing, which is rendered into a buffer one
+   span at a time.  The usual pattern in run() is to render up to the time of
+   each event, then apply the event with state_smooth_set(), so a patch:Set
+   starts ramping at exactly the frame it was sent for:
+
+   LV2_ATOM_SEQUENCE_FOREACH(self->in_port, ev) {
+       state_smooth_render(&self->gain, self->ramp, offset, ev->time.frames);
+       offset = ev->time.frames;
+       // Set new target with state_smooth_set() ...
+   }
+   state_smooth_render(&self->gain, self->ramp, offset, n_samples);
+
+   The ramp buffer can then be consumed like an audio-rate control signal.
+*/
+
+#ifndef STATE_SMOOTH_H
+#define STATE_SMOOTH_H
+
+#include "state_map.h"
+
+#include "lv2/atom/atom.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Number of frames rendered per iteration of exponential ramps. */
+#define STATE_SMOOTH_LANES 8
+
+typedef enum {
+	STATE_SMOOTH_LINEAR,      ///< Constant slope to target
+	STATE_SMOOTH_EXPONENTIAL  ///< One-pole approach to target (-60dB at end)
+} StateSmoothMode;
+
+typedef struct {
+	const StateMapItem* item;       ///< Property (atom:Float or atom:Double)
+	StateSmoothMode     mode;       ///< Ramp shape
+	uint32_t            ramp_len;   ///< Length of a complete ramp in frames
+	uint32_t            remaining;  ///< Frames left in current ramp
+	float               current;    ///< Current (smoothed) value
+	float               target;     ///< Value being ramped to
+	float               step;       ///< Per-frame increment (linear)
+	float               coef;       ///< Per-frame coefficient (exponential)
+	float               lanes[STATE_SMOOTH_LANES];  ///< coef^1..coef^LANES
+} StateSmoother;
+
+/** Return the value of a numeric state map item as a float. */
+static inline float
+state_smooth_item_value(const StateMapItem* item, LV2_URID atom_Double)
+{
+	return ((item->value->type == atom_Double)
+	        ? (float)((const LV2_Atom_Double*)item->value)->body
+	        : ((const LV2_Atom_Float*)item->value)->body);
+}
+
+/**
+   Initialise a smoother for a numeric state map item.
+
+   The item must have type atom:Float or atom:Double.  The smoother starts at
+   the current value of the item with no ramp in progress.  A ramp_len of zero
+   disables smoothing, so new values are applied immediately.
+*/
+static inline void
+state_smooth_init(StateSmoother*      smoother,
+                  const StateMapItem* item,
+                  LV2_URID            atom_Double,
+                  StateSmoothMode     mode,
+                  uint32_t            ramp_len)
+{
+	smoother->item      = item;
+	smoother->mode      = mode;
+	smoother->ramp_len  = ramp_len;
+	smoother->remaining = 0;
+	smoother->current   = state_smooth_item_value(item, atom_Double);
+	smoother->target    = smoother->current;
+	smoother->step      = 0.0f;
+	smoother->coef      = ramp_len ? expf(logf(0.001f) / (float)ramp_len) : 0.0f;
+
+	float power = 1.0f;
+	for (unsigned i = 0; i < STATE_SMOOTH_LANES; ++i) {
+		power *= smoother->coef;
+		smoother->lanes[i] = power;
+	}
+}
+
+/**
+   Start ramping towards `target`.
+
+   This should be called at the time of the event that changed the value,
+   after the output up until that time has been rendered.  A ramp already in
+   progress continues smoothly from its current value.
+*/
+static inline void
+state_smooth_set(StateSmoother* smoother, float target)
+{
+	smoother->target = target;
+	if (!smoother->ramp_len || smoother->current == target) {
+		smoother->current   = target;
+		smoother->remaining = 0;
+	} else {
+		smoother->remaining = smoother->ramp_len;
+		smoother->step = (target - smoother->current) / (float)smoother->ramp_len;
+	}
+}
+
+/** Return true iff a ramp is in progress. */
+static inline bool
+state_smooth_is_active(const StateSmoother* smoother)
+{
+	return smoother->remaining > 0;
+}
+
+/** Render linear ramp frames to `out[0..n)`, which must be within the ramp. */
+static inline void
+state_smooth_render_linear(StateSmoother* smoother, float* out, uint32_t n)
+{
+	const float base = smoother->current;
+	const float step = smoother->step;
+	for (uint32_t i = 0; i < n; ++i) {
+		out[i] = base + step * (float)(i + 1);
+	}
+
+	smoother->current = base + step * (float)n;
+}
+
+/** Render exponential ramp frames to `out[0..n)`, within the ramp. */
+static inline void
+state_smooth_render_exponential(StateSmoother* smoother, float* out, uint32_t n)
+{
+	const float  target = smoother->target;
+	const float* lanes  = smoother->lanes;
+	const float  stride = lanes[STATE_SMOOTH_LANES - 1];
+	float        delta  = smoother->current - target;
+	uint32_t     i      = 0;
+
+	// Render whole blocks of lanes, which is independent per frame
+	for (; i + STATE_SMOOTH_LANES <= n; i += STATE_SMOOTH_LANES) {
+		for (unsigned j = 0; j < STATE_SMOOTH_LANES; ++j) {
+			out[i + j] = target + delta * lanes[j];
+		}
+		delta *= stride;
+	}
+
+	// Render remaining frames one at a time
+	for (; i < n; ++i) {
+		delta *= smoother->coef;
+		out[i] = target + delta;
+	}
+
+	smoother->current = target + delta;
+}
+
+/**
+   Render the smoothed value for frames [begin..end) to `out`.
+
+   This writes one value per frame, so `out` can be used directly as a
+   control signal.  If `out` is NULL, the smoother is advanced without
+   writing any output.
+*/
+static inline void
+state_smooth_render(StateSmoother* smoother,
+                    float*         out,
+                    uint32_t       begin,
+                    uint32_t       end)
+{
+	uint32_t n_ramp = 0;
+	if (smoother->remaining > 0) {
+		n_ramp = end - begin;
+		if (n_ramp > smoother->remaining) {
+			n_ramp = smoother->remaining;
+		}
+
+		if (!out) {
+			// Advance without output
+			smoother->current =
+				(smoother->mode == STATE_SMOOTH_LINEAR)
+				? smoother->current + smoother->step * (float)n_ramp
+				: smoother->target + (smoother->current - smoother->target) *
+				  powf(smoother->coef, (float)n_ramp);
+		} else if (smoother->mode == STATE_SMOOTH_LINEAR) {
+			state_smooth_render_linear(smoother, out + begin, n_ramp);
+		} else {
+			state_smooth_render_exponential(smoother, out + begin, n_ramp);
+		}
+
+		if ((smoother->remaining -= n_ramp) == 0) {
+			smoother->current = smoother->target;  // Land exactly on target
+		}
+	}
+
+	// Fill the rest of the span with the steady value
+	if (out) {
+		const float value = smoother->current;
+		for (uint32_t i = begin + n_ramp; i < end; ++i) {
+			out[i] = value;
+		}
+	}
+}
+
+#endif  /* STATE_SMOOTH_H */
@@ -25,11 +25,13 @@
 #include "lv2/atom/forge.h"
 #include "lv2/atom/util.h"
 #include "lv2/core/lv2.h"
+#include "lv2/core/lv2_resources.h"
 #include "lv2/core/lv2_util.h"
 #include "lv2/log/log.h"
 #include "lv2/log/logger.h"
 #include "lv2/midi/midi.h"
 #include "lv2/state/state.h"
+#include "lv2/trace/trace.h"
 #include "lv2/urid/urid.h"
 #include "lv2/worker/worker.h"
 
@@ -42,6 +44,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+/** Minimum number of frames to render between handling events. */
+static const uint32_t min_span = 16;
+
 enum {
 	SAMPLER_CONTROL = 0,
 	SAMPLER_NOTIFY  = 1,
@@ -60,6 +65,10 @@ typedef struct {
 	LV2_URID_Map*        map;
 	LV2_Worker_Schedule* schedule;
 	LV2_Log_Logger       logger;
+	LV2_Log_Deferred     rt_logger;  ///< Logger for use in the audio thread
+	bool                 flushing;   ///< Work to flush rt_logger scheduled
+	LV2_Trace_Tracer*    tracer;
+	LV2_Resource_Store*  resources;  ///< Samples shared with other instances
 
 	// Ports
 	const LV2_Atom_Sequence* control_port;
@@ -97,6 +106,14 @@ typedef struct {
 	Sample*  sample;
 } SampleMessage;
 
+/**
+   Arguments for loading a sample.
+*/
+typedef struct {
+	LV2_Log_Logger* logger;
+	const char*     path;
+} SampleArgs;
+
 /**
    Load a new sample and return it.
 
@@ -104,9 +121,12 @@ typedef struct {
    worker thread only.  The sample is loaded and returned only, plugin state is
    not modified.
 */
-static Sample*
-load_sample(LV2_Log_Logger* logger, const char* path)
+static void*
+create_sample(void* arg, size_t* size)
 {
+	LV2_Log_Logger* const logger = ((const SampleArgs*)arg)->logger;
+	const char* const     path   = ((const SampleArgs*)arg)->path;
+
 	lv2_log_trace(logger, "Loading %s\n", path);
 
 	const size_t   path_len = strlen(path);
@@ -142,17 +162,44 @@ load_sample(LV2_Log_Logger* logger, const char* path)
 	sample->path_len = (uint32_t)path_len;
 	memcpy(sample->path, path, path_len + 1);
 
+	*size = sizeof(Sample) + sizeof(float) * info->frames + path_len + 1;
 	return sample;
 }
 
+static void
+destroy_sample(void* data)
+{
+	Sample* const sample = (Sample*)data;
+
+	free(sample->path);
+	free(sample->data);
+	free(sample);
+}
+
+/**
+   Get a sample, loading it if necessary.
+
+   Samples are read-only once loaded, so if the host loaded the library with
+   lv2_lib_descriptor(), every instance that plays the same file shares a
+   single copy of it.  Samples are shared by path alone, so if the file
+   changes while any instance is using it, loading it again returns the old
+   data until every instance has released it.
+*/
+static Sample*
+load_sample(Sampler* self, const char* path)
+{
+	SampleArgs args = { &self->logger, path };
+
+	return (Sample*)lv2_resource_acquire(
+		self->resources, path, NULL, create_sample, destroy_sample, &args);
+}
+
 static void
 free_sample(Sampler* self, Sample* sample)
 {
 	if (sample) {
-		lv2_log_trace(&self->logger, "Freeing %s\n", sample->path);
-		free(sample->path);
-		free(sample->data);
-		free(sample);
+		lv2_log_trace(&self->logger, "Releasing %s\n", sample->path);
+		lv2_resource_release(self->resources, sample, destroy_sample);
 	}
 }
 
@@ -172,7 +219,11 @@ work(LV2_Handle                  instance,
 {
 	Sampler*        self = (Sampler*)instance;
 	const LV2_Atom* atom = (const LV2_Atom*)data;
-	if (atom->type == self->uris.eg_freeSample) {
+	if (atom->type == self->uris.eg_flushLog) {
+		// Forward messages logged in the audio thread
+		lv2_log_deferred_drain(&self->rt_logger);
+		__atomic_store_n(&self->flushing, false, __ATOMIC_RELEASE);
+	} else if (atom->type == self->uris.eg_freeSample) {
 		// Free old sample
 		const SampleMessage* msg = (const SampleMessage*)data;
 		free_sample(self, msg->sample);
@@ -186,7 +237,7 @@ work(LV2_Handle                  instance,
 		}
 
 		// Load sample.
-		Sample* sample = load_sample(&self->logger, path);
+		Sample* sample = load_sample(self, path);
 		if (sample) {
 			// Send new sample to run() to be applied
 			respond(handle, sizeof(sample), &sample);
@@ -268,6 +319,7 @@ instantiate(const LV2_Descriptor*     descriptor,
 		LV2_LOG__log,         &self->logger.log, false,
 		LV2_URID__map,        &self->map,        true,
 		LV2_WORKER__schedule, &self->schedule,   true,
+		LV2_TRACE__tracer,    &self->tracer,     false,
 		NULL);
 	lv2_log_logger_set_map(&self->logger, self->map);
 	if (missing) {
@@ -277,9 +329,11 @@ instantiate(const LV2_Descriptor*     descriptor,
 	}
 
 	// Map URIs and initialise forge
+	self->resources = lv2_resource_store(descriptor, lv2_descriptor(0));
 	map_sampler_uris(self->map, &self->uris);
 	lv2_atom_forge_init(&self->forge, self->map);
 	peaks_sender_init(&self->psend, self->map);
+	lv2_log_deferred_init(&self->rt_logger, &self->logger);
 
 	self->gain = 1.0;
 
@@ -342,17 +396,20 @@ handle_event(Sampler* self, LV2_Atom_Event* ev)
 			                    uris->patch_value,    &value,
 			                    0);
 			if (!property) {
-				lv2_log_error(&self->logger, "Set message with no property\n");
+				lv2_log_deferred_error(&self->rt_logger,
+				                       "Set message with no property\n");
 				return;
 			} else if (property->type != uris->atom_URID) {
-				lv2_log_error(&self->logger, "Set property is not a URID\n");
+				lv2_log_deferred_error(&self->rt_logger,
+				                       "Set property is not a URID\n");
 				return;
 			}
 
 			const uint32_t key = ((const LV2_Atom_URID*)property)->body;
 			if (key == uris->eg_sample) {
 				// Sample change, send it to the worker.
-				lv2_log_trace(&self->logger, "Scheduling sample change\n");
+				lv2_log_deferred_trace(&self->rt_logger,
+				                       "Scheduling sample change\n");
 				self->schedule->schedule_work(self->schedule->handle,
 				                              lv2_atom_total_size(&ev->body),
 				                              &ev->body);
@@ -383,12 +440,13 @@ handle_event(Sampler* self, LV2_Atom_Event* ev)
 				               self->sample->path_len);
 			}
 		} else {
-			lv2_log_trace(&self->logger,
-			              "Unknown object type %d\n", obj->body.otype);
+			lv2_log_deferred_trace(&self->rt_logger,
+			                       "Unknown object type %d\n",
+			                       obj->body.otype);
 		}
 	} else {
-		lv2_log_trace(&self->logger,
-		              "Unknown event type %d\n", ev->body.type);
+		lv2_log_deferred_trace(&self->rt_logger,
+		                       "Unknown event type %d\n", ev->body.type);
 	}
 
 }
@@ -441,28 +499,55 @@ run(LV2_Handle instance, uint32_t sample_count)
 		self->sample_changed = false;
 	}
 
-	// Iterate over incoming events, emitting audio along the way
+	/* Iterate over slices of the cycle between incoming events, emitting
+	   audio along the way.  Events which are very close together are handled
+	   at once, so rendering is never split into tiny pieces. */
+	LV2_Atom_Sequence_Slicer slicer;
+	LV2_Atom_Sequence_Slice  slice;
+	lv2_atom_sequence_slicer_init(
+		&slicer, self->control_port, sample_count, min_span);
+
 	self->frame_offset = 0;
-	LV2_ATOM_SEQUENCE_FOREACH(self->control_port, ev) {
-		// Render output up to the time of this event
-		render(self, self->frame_offset, ev->time.frames);
-
-		/* Update current frame offset to this event's time.  This is stored in
-		   the instance because it is used for sychronous worker event
-		   execution.  This allows a sample load event to be executed with
-		   sample accuracy when running in a non-realtime context (such as
-		   exporting a session). */
-		self->frame_offset = ev->time.frames;
-
-		// Process this event
-		handle_event(self, ev);
+	while (lv2_atom_sequence_slicer_next(&slicer, &slice)) {
+		// Render output up to the time of the events at the end of this slice
+		lv2_trace_begin(self->tracer, "render");
+		render(self, slice.start, slice.end);
+		lv2_trace_end(self->tracer, "render");
+
+		LV2_ATOM_SLICE_FOREACH(&slice, ev) {
+			/* Events in a slice take effect, and are replied to, at the end
+			   of the slice, which is where rendering stopped.  The offset is
+			   stored in the instance because it is also used for synchronous
+			   worker event execution, so a sample load takes effect at the
+			   end of the slice when running in a non-realtime context (such
+			   as exporting a session). */
+			self->frame_offset = slice.end;
+
+			// Process this event
+			lv2_trace_begin(self->tracer, "handle_event");
+			handle_event(self, ev);
+			lv2_trace_end(self->tracer, "handle_event");
+		}
 	}
 
 	// Use available space after any emitted events to send peaks
+	lv2_trace_begin(self->tracer, "peaks_sender_send");
 	peaks_sender_send(&self->psend, &self->forge, sample_count, self->frame_offset);
-
-	// Render output for the rest of the cycle past the last event
-	render(self, self->frame_offset, sample_count);
+	lv2_trace_end(self->tracer, "peaks_sender_send");
+
+	/* Have the worker forward any messages logged in this cycle.  Only one
+	   flush is scheduled at a time, so a slow worker is not flooded with them
+	   while the log stays pending for many cycles.  The flag is set first,
+	   since the host may call work() before schedule_work() returns. */
+	if (lv2_log_deferred_is_pending(&self->rt_logger) &&
+	    !__atomic_load_n(&self->flushing, __ATOMIC_ACQUIRE)) {
+		const LV2_Atom msg = { 0, self->uris.eg_flushLog };
+		__atomic_store_n(&self->flushing, true, __ATOMIC_RELAXED);
+		if (self->schedule->schedule_work(
+			    self->schedule->handle, sizeof(msg), &msg)) {
+			__atomic_store_n(&self->flushing, false, __ATOMIC_RELAXED);
+		}
+	}
 }
 
 static LV2_State_Status
@@ -542,7 +627,7 @@ restore(LV2_Handle                  instance,
 	if (!self->activated || !schedule) {
 		// No scheduling available, load sample immediately
 		lv2_log_trace(&self->logger, "Synchronous restore\n");
-		Sample* sample = load_sample(&self->logger, path);
+		Sample* sample = load_sample(self, path);
 		if (sample) {
 			free_sample(self, self->sample);
 			self->sample         = sample;
@@ -601,3 +686,10 @@ const LV2_Descriptor* lv2_descriptor(uint32_t index)
 		return NULL;
 	}
 }
+
+LV2_SYMBOL_EXPORT
+const LV2_Lib_Descriptor*
+lv2_lib_descriptor(const char* bundle_path, const LV2_Feature* const* features)
+{
+	return lv2_resource_lib_new(lv2_descriptor);
+}
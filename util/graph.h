@@ -0,0 +1,462 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @file graph.h A parallel graph executor for the minimal host.
+
+   Instances are nodes in a directed acyclic graph, where an edge connects an
+   output of one instance to an input of another.  Every cycle, nodes are run
+   by a pool of threads as soon as all of their predecessors have finished.
+   Each thread has its own queue of ready nodes, and steals from the others
+   when it runs out.
+
+   This follows the threading rules in lv2.h: run() is in the "audio"
+   threading class, so it is called for a given instance by only one thread
+   at a time, but different instances are run concurrently.  Everything else,
+   including connect_port(), is only called while the pool is idle.  Since
+   the host URID map is not thread-safe, plugins must not map URIs in run(),
+   which none of the examples do.
+
+   A thread pushes nodes that it makes ready to its own queue and takes the
+   most recent one first, so a successor usually runs on the thread that just
+   wrote its input.  Nodes are aligned to cache lines so that the counters
+   updated by different threads do not share them.
+
+   This uses the GCC atomic builtins and POSIX threads and semaphores.
+*/
+
+#ifndef LV2_UTIL_GRAPH_H
+#define LV2_UTIL_GRAPH_H
+
+#include "host.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GRAPH_MAX_SUCCESSORS 8
+#define GRAPH_MAX_THREADS    64
+#define GRAPH_CACHE_LINE     64
+
+/** An instance in a graph. */
+typedef struct {
+	HostInstance* inst;                         /**< Instance to run */
+	uint32_t      n_preds;                      /**< Number of inputs */
+	uint32_t      n_succs;                      /**< Number of outputs */
+	uint32_t      succs[GRAPH_MAX_SUCCESSORS];  /**< Successor indices */
+	uint32_t      pending;                      /**< Unfinished inputs */
+} __attribute__((aligned(GRAPH_CACHE_LINE))) GraphNode;
+
+/** A queue of ready nodes, popped at the tail by its owner. */
+typedef struct {
+	uint32_t  lock;   /**< Spin lock */
+	uint32_t  head;   /**< Index of first node, where others steal */
+	uint32_t  tail;   /**< Index after last node, where the owner pushes */
+	uint32_t* nodes;  /**< Node indices, one slot for every node */
+} __attribute__((aligned(GRAPH_CACHE_LINE))) GraphQueue;
+
+struct GraphImpl;
+
+/** A thread in the pool, where thread 0 is the caller of graph_run(). */
+typedef struct {
+	struct GraphImpl* graph;
+	uint32_t          index;
+	pthread_t         thread;
+	sem_t             sem;
+	GraphQueue        queue;
+} GraphThread;
+
+/** A graph of instances, and the threads that run it. */
+typedef struct GraphImpl {
+	GraphNode*   nodes;      /**< Nodes, in order of addition */
+	uint32_t     n_nodes;    /**< Number of nodes */
+	uint32_t     capacity;   /**< Number of allocated nodes */
+	uint32_t*    order;      /**< Nodes in topological order */
+	GraphThread* threads;    /**< Thread pool */
+	uint32_t     n_threads;  /**< Number of threads, including the caller */
+	uint32_t     n_frames;   /**< Frames to run in the current cycle */
+	uint32_t     remaining;  /**< Nodes not yet run in the current cycle */
+	uint32_t     active;     /**< Pool threads still in the current cycle */
+	bool         exit;       /**< Set to stop the pool threads */
+} Graph;
+
+/** @cond */
+
+static inline void
+graph_lock(GraphQueue* queue)
+{
+	while (__atomic_test_and_set(&queue->lock, __ATOMIC_ACQUIRE)) {
+		while (__atomic_load_n(&queue->lock, __ATOMIC_RELAXED)) {
+		}
+	}
+}
+
+static inline void
+graph_unlock(GraphQueue* queue)
+{
+	__atomic_clear(&queue->lock, __ATOMIC_RELEASE);
+}
+
+static inline void
+graph_push(GraphQueue* queue, uint32_t node)
+{
+	graph_lock(queue);
+	queue->nodes[queue->tail] = node;
+	__atomic_store_n(&queue->tail, queue->tail + 1, __ATOMIC_RELAXED);
+	graph_unlock(queue);
+}
+
+/** Pop the most recently pushed node, or return false if there are none. */
+static inline bool
+graph_pop(GraphQueue* queue, uint32_t* node)
+{
+	bool found = false;
+	graph_lock(queue);
+	if (queue->tail > queue->head) {
+		__atomic_store_n(&queue->tail, queue->tail - 1, __ATOMIC_RELAXED);
+		*node = queue->nodes[queue->tail];
+		found = true;
+	}
+	graph_unlock(queue);
+	return found;
+}
+
+/** Steal the least recently pushed node, or return false if there are none. */
+static inline bool
+graph_steal(GraphQueue* queue, uint32_t* node)
+{
+	if (__atomic_load_n(&queue->tail, __ATOMIC_RELAXED) ==
+	    __atomic_load_n(&queue->head, __ATOMIC_RELAXED)) {
+		return false;  // Avoid the lock of an empty queue, this is only a hint
+	}
+
+	bool found = false;
+	graph_lock(queue);
+	if (queue->tail > queue->head) {
+		*node = queue->nodes[queue->head];
+		__atomic_store_n(&queue->head, queue->head + 1, __ATOMIC_RELAXED);
+		found = true;
+	}
+	graph_unlock(queue);
+	return found;
+}
+
+/** Run nodes until every node in the cycle has been run. */
+static inline void
+graph_work(Graph* graph, uint32_t index)
+{
+	GraphQueue* const queue = &graph->threads[index].queue;
+	uint32_t          n     = 0;
+	while (__atomic_load_n(&graph->remaining, __ATOMIC_ACQUIRE)) {
+		if (!graph_pop(queue, &n)) {
+			bool stolen = false;
+			for (uint32_t i = 1; i < graph->n_threads && !stolen; ++i) {
+				const uint32_t victim = (index + i) % graph->n_threads;
+				stolen = graph_steal(&graph->threads[victim].queue, &n);
+			}
+
+			if (!stolen) {
+				sched_yield();  // Let a preempted thread finish its node
+				continue;
+			}
+		}
+
+		GraphNode* const node = &graph->nodes[n];
+		host_run_plugin(node->inst, graph->n_frames);
+
+		for (uint32_t s = 0; s < node->n_succs; ++s) {
+			GraphNode* const succ = &graph->nodes[node->succs[s]];
+			if (!__atomic_sub_fetch(&succ->pending, 1, __ATOMIC_ACQ_REL)) {
+				graph_push(queue, node->succs[s]);
+			}
+		}
+
+		__atomic_sub_fetch(&graph->remaining, 1, __ATOMIC_RELEASE);
+	}
+}
+
+static inline void*
+graph_thread(void* data)
+{
+	GraphThread* const thread = (GraphThread*)data;
+	Graph* const       graph  = thread->graph;
+	for (;;) {
+		while (sem_wait(&thread->sem)) {
+		}
+
+		if (__atomic_load_n(&graph->exit, __ATOMIC_ACQUIRE)) {
+			break;
+		}
+
+		graph_work(graph, thread->index);
+		__atomic_sub_fetch(&graph->active, 1, __ATOMIC_RELEASE);
+	}
+
+	return NULL;
+}
+
+/** @endcond */
+
+/** Initialise an empty graph. */
+static inline void
+graph_init(Graph* graph)
+{
+	memset(graph, 0, sizeof(Graph));
+}
+
+/**
+   Add an instance to the graph, and return its node index.
+
+   The instance is not owned by the graph, and must outlive it.  Returns
+   UINT32_MAX on allocation failure.
+*/
+static inline uint32_t
+graph_add(Graph* graph, HostInstance* inst)
+{
+	if (graph->n_nodes == graph->capacity) {
+		const uint32_t capacity = graph->capacity ? graph->capacity * 2 : 16;
+		void*          nodes    = NULL;
+		if (posix_memalign(&nodes, GRAPH_CACHE_LINE,
+		                   capacity * sizeof(GraphNode))) {
+			return UINT32_MAX;
+		}
+
+		if (graph->nodes) {
+			memcpy(nodes, graph->nodes, graph->n_nodes * sizeof(GraphNode));
+		}
+
+		free(graph->nodes);
+		graph->nodes    = (GraphNode*)nodes;
+		graph->capacity = capacity;
+	}
+
+	GraphNode* const node = &graph->nodes[graph->n_nodes];
+	memset(node, 0, sizeof(GraphNode));
+	node->inst = inst;
+	return graph->n_nodes++;
+}
+
+/**
+   Connect an output port of one node to an input port of another.
+
+   The input is connected directly to the output buffer, so the source must
+   run first.  Returns false if the source has too many connections.
+*/
+static inline bool
+graph_connect(Graph*   graph,
+              uint32_t src,
+              uint32_t src_port,
+              uint32_t dst,
+              uint32_t dst_port)
+{
+	GraphNode* const s = &graph->nodes[src];
+	GraphNode* const d = &graph->nodes[dst];
+
+	bool linked = false;
+	for (uint32_t i = 0; i < s->n_succs; ++i) {
+		linked = linked || s->succs[i] == dst;
+	}
+
+	if (!linked) {
+		if (s->n_succs == GRAPH_MAX_SUCCESSORS) {
+			return false;
+		}
+
+		s->succs[s->n_succs++] = dst;
+		++d->n_preds;
+	}
+
+	d->inst->plugin->descriptor->connect_port(
+		d->inst->handle, dst_port, s->inst->buffers[src_port]);
+	return true;
+}
+
+/**
+   Prepare a graph to run with `n_threads` threads, including the caller.
+
+   This sorts the nodes and starts the pool.  Returns false if the graph has
+   a cycle, or if threads could not be started.
+*/
+static inline bool
+graph_start(Graph* graph, uint32_t n_threads)
+{
+	n_threads = n_threads < 1 ? 1 : n_threads;
+	n_threads = n_threads > GRAPH_MAX_THREADS ? GRAPH_MAX_THREADS : n_threads;
+
+	// Sort nodes topologically (Kahn's algorithm)
+	uint32_t* const order = (uint32_t*)calloc(graph->n_nodes + 1,
+	                                          sizeof(uint32_t));
+	if (!order) {
+		return false;
+	}
+
+	uint32_t n_sorted = 0;
+	for (uint32_t i = 0; i < graph->n_nodes; ++i) {
+		graph->nodes[i].pending = graph->nodes[i].n_preds;
+		if (!graph->nodes[i].n_preds) {
+			order[n_sorted++] = i;
+		}
+	}
+
+	for (uint32_t i = 0; i < n_sorted; ++i) {
+		const GraphNode* const node = &graph->nodes[order[i]];
+		for (uint32_t s = 0; s < node->n_succs; ++s) {
+			if (!--graph->nodes[node->succs[s]].pending) {
+				order[n_sorted++] = node->succs[s];
+			}
+		}
+	}
+
+	if (n_sorted != graph->n_nodes) {
+		free(order);
+		return false;
+	}
+
+	void* threads = NULL;
+	if (posix_memalign(&threads, GRAPH_CACHE_LINE,
+	                   n_threads * sizeof(GraphThread))) {
+		free(order);
+		return false;
+	}
+
+	graph->order     = order;
+	graph->threads   = (GraphThread*)threads;
+	graph->n_threads = 0;
+	graph->exit      = false;
+	memset(graph->threads, 0, n_threads * sizeof(GraphThread));
+	for (uint32_t i = 0; i < n_threads; ++i) {
+		GraphThread* const thread = &graph->threads[i];
+		thread->graph             = graph;
+		thread->index             = i;
+		thread->queue.nodes       = (uint32_t*)calloc(graph->n_nodes + 1,
+		                                              sizeof(uint32_t));
+		if (!thread->queue.nodes || sem_init(&thread->sem, 0, 0)) {
+			free(thread->queue.nodes);
+			return false;
+		}
+
+		if (i > 0 &&
+		    pthread_create(&thread->thread, NULL, graph_thread, thread)) {
+			sem_destroy(&thread->sem);
+			free(thread->queue.nodes);
+			return false;
+		}
+
+		graph->n_threads = i + 1;
+	}
+
+	return true;
+}
+
+/**
+   Run every node in the graph for one cycle on the pool.
+
+   The calling thread works on the cycle as well, and this returns when every
+   node has been run and every other thread is idle again.  Work scheduled by
+   the nodes is not done, the cycle must be finished with
+   graph_finish_cycle().
+*/
+static inline void
+graph_run(Graph* graph, uint32_t n_frames)
+{
+	graph->n_frames  = n_frames;
+	graph->remaining = graph->n_nodes;
+	for (uint32_t i = 0; i < graph->n_nodes; ++i) {
+		graph->nodes[i].pending = graph->nodes[i].n_preds;
+	}
+
+	for (uint32_t i = 0; i < graph->n_threads; ++i) {
+		graph->threads[i].queue.head = 0;
+		graph->threads[i].queue.tail = 0;
+	}
+
+	// Distribute sources in the same way every cycle, to keep them local
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < graph->n_nodes; ++i) {
+		if (!graph->nodes[i].n_preds) {
+			GraphQueue* const queue = &graph->threads[next].queue;
+			queue->nodes[queue->tail++] = i;
+			next = (next + 1) % graph->n_threads;
+		}
+	}
+
+	__atomic_store_n(&graph->active, graph->n_threads - 1, __ATOMIC_RELEASE);
+	for (uint32_t i = 1; i < graph->n_threads; ++i) {
+		sem_post(&graph->threads[i].sem);
+	}
+
+	graph_work(graph, 0);
+
+	while (__atomic_load_n(&graph->active, __ATOMIC_ACQUIRE)) {
+		sched_yield();
+	}
+}
+
+/**
+   Run every node in the graph for one cycle in order on this thread.
+
+   Like graph_run(), the cycle must be finished with graph_finish_cycle().
+*/
+static inline void
+graph_run_serial(Graph* graph, uint32_t n_frames)
+{
+	for (uint32_t i = 0; i < graph->n_nodes; ++i) {
+		host_run_plugin(graph->nodes[graph->order[i]].inst, n_frames);
+	}
+}
+
+/**
+   Finish a cycle of every node, see host_finish_cycle().
+
+   This does the work that nodes scheduled in the cycle on this thread, as a
+   host would in its worker thread, so it is not part of the cycle time.
+*/
+static inline void
+graph_finish_cycle(Graph* graph)
+{
+	for (uint32_t i = 0; i < graph->n_nodes; ++i) {
+		host_finish_cycle(graph->nodes[i].inst);
+	}
+}
+
+/** Stop the pool and free the graph, but not the instances in it. */
+static inline void
+graph_free(Graph* graph)
+{
+	__atomic_store_n(&graph->exit, true, __ATOMIC_RELEASE);
+	for (uint32_t i = 0; i < graph->n_threads; ++i) {
+		GraphThread* const thread = &graph->threads[i];
+		if (i > 0) {
+			sem_post(&thread->sem);
+			pthread_join(thread->thread, NULL);
+		}
+
+		sem_destroy(&thread->sem);
+		free(thread->queue.nodes);
+	}
+
+	free(graph->threads);
+	free(graph->order);
+	free(graph->nodes);
+	memset(graph, 0, sizeof(Graph));
+}
+
+#endif /* LV2_UTIL_GRAPH_H */
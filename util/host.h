@@ -0,0 +1,612 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @file host.h A minimal host for the example plugins.
+
+   This is just enough of a host to load and run the example plugins from the
+   command line, for tools that replay or benchmark them.  There is no data
+   model, so ports are described by a table of the examples rather than read
+   from their bundles.  Work scheduled in run() is done in the same thread
+   after run() returns, as a host may do when free-wheeling.
+
+   If Host::trace_capacity is set, every instance gets a trace recorder (see
+   lv2/trace/recorder.h), which is passed to the plugin as the trace:tracer
+   feature and also records a region around every call to run().
+*/
+
+#ifndef LV2_UTIL_HOST_H
+#define LV2_UTIL_HOST_H
+
+#include "lv2/atom/atom.h"
+#include "lv2/clone/clone.h"
+#include "lv2/core/lv2.h"
+#include "lv2/log/log.h"
+#include "lv2/trace/recorder.h"
+#include "lv2/urid/urid.h"
+#include "lv2/worker/worker.h"
+
+#include <dlfcn.h>
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HOST_MAX_PORTS     8
+#define HOST_ATOM_CAPACITY 65536
+#define HOST_WORK_CAPACITY 4096
+#define HOST_PI            3.14159265358979323846
+
+/**
+   Ports of an example plugin, as a string with one character per port.
+
+   The characters are 'c' for a control input, 'a' and 'A' for an audio input
+   and output, and 'e' and 'E' for an atom sequence input and output.
+*/
+typedef struct {
+	const char* uri;     /**< Plugin URI */
+	const char* bundle;  /**< Bundle directory name */
+	const char* binary;  /**< Module name, without extension */
+	const char* ports;   /**< Port types */
+} HostPluginInfo;
+
+static const HostPluginInfo host_plugins[] = {
+	{ "http://lv2plug.in/plugins/eg-amp", "eg-amp.lv2", "amp", "caA" },
+	{ "http://lv2plug.in/plugins/eg-fifths", "eg-fifths.lv2", "fifths", "eE" },
+	{ "http://lv2plug.in/plugins/eg-metro", "eg-metro.lv2", "metro", "eA" },
+	{ "http://lv2plug.in/plugins/eg-midigate",
+	  "eg-midigate.lv2", "midigate", "eaA" },
+	{ "http://lv2plug.in/plugins/eg-params", "eg-params.lv2", "params", "eE" },
+	{ "http://lv2plug.in/plugins/eg-sampler",
+	  "eg-sampler.lv2", "sampler", "eEA" },
+	{ "http://lv2plug.in/plugins/eg-scope#Mono",
+	  "eg-scope.lv2", "examploscope", "eEaA" },
+	{ "http://lv2plug.in/plugins/eg-scope#Stereo",
+	  "eg-scope.lv2", "examploscope", "eEaAaA" },
+	{ NULL, NULL, NULL, NULL }
+};
+
+/** Features shared by all instances. */
+typedef struct {
+	char**         uris;
+	uint32_t       n_uris;
+	LV2_URID_Map   map;
+	LV2_URID_Unmap unmap;
+	LV2_Log_Log    log;
+	LV2_URID       atom_Chunk;
+	LV2_URID       atom_Sequence;
+	uint32_t       trace_capacity;  ///< Regions per recorder, or 0 for none
+	uint32_t       n_recorders;     ///< Number of recorders made, for IDs
+} Host;
+
+/** A loaded plugin module. */
+typedef struct {
+	void*                     lib;
+	const LV2_Lib_Descriptor* lib_descriptor;  ///< Or NULL if not used
+	const LV2_Descriptor*     descriptor;
+	const HostPluginInfo*     info;
+	char                      bundle_path[1024];  ///< With trailing slash
+} HostPlugin;
+
+/** A plugin instance, with a buffer connected to every port. */
+typedef struct {
+	Host*                       host;
+	const HostPlugin*           plugin;
+	LV2_Handle                  handle;
+	const LV2_Worker_Interface* worker;
+	LV2_Worker_Schedule         schedule;
+	LV2_Clone_Prototype         prototype;
+	LV2_Trace_Recorder          recorder;
+	const LV2_Trace_Tracer*     tracer;  ///< Recorder tracer, or NULL
+	LV2_Feature                 features[6];
+	const LV2_Feature*          feature_list[7];
+	uint32_t                    n_features;
+	uint32_t                    n_ports;
+	uint32_t                    block_length;
+	float                       controls[HOST_MAX_PORTS];
+	void*                       buffers[HOST_MAX_PORTS];
+	bool                        running;
+	uint32_t                    requests_size;
+	uint8_t                     requests[HOST_WORK_CAPACITY];
+	uint32_t                    responses_size;
+	uint8_t                     responses[HOST_WORK_CAPACITY];
+} HostInstance;
+
+static inline LV2_URID
+host_map_uri(LV2_URID_Map_Handle handle, const char* uri)
+{
+	Host* const host = (Host*)handle;
+	for (uint32_t i = 0; i < host->n_uris; ++i) {
+		if (!strcmp(host->uris[i], uri)) {
+			return i + 1;
+		}
+	}
+
+	char** const uris = (char**)realloc(
+		host->uris, (host->n_uris + 1) * sizeof(char*));
+	if (!uris) {
+		return 0;
+	}
+
+	const size_t len = strlen(uri);
+	host->uris       = uris;
+	if (!(host->uris[host->n_uris] = (char*)malloc(len + 1))) {
+		return 0;
+	}
+
+	memcpy(host->uris[host->n_uris], uri, len + 1);
+	return ++host->n_uris;
+}
+
+static inline const char*
+host_unmap_uri(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+	const Host* const host = (const Host*)handle;
+	return (urid > 0 && urid <= host->n_uris) ? host->uris[urid - 1] : NULL;
+}
+
+static inline int
+host_vprintf(LV2_Log_Handle handle, LV2_URID type, const char* fmt, va_list ap)
+{
+	const char* const uri  = host_unmap_uri(handle, type);
+	const char* const name = uri ? strrchr(uri, '#') : NULL;
+
+	fprintf(stderr, "%s: ", name ? name + 1 : "log");
+	return vfprintf(stderr, fmt, ap);
+}
+
+static inline int
+host_printf(LV2_Log_Handle handle, LV2_URID type, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	const int ret = host_vprintf(handle, type, fmt, args);
+	va_end(args);
+	return ret;
+}
+
+static inline uint64_t
+host_trace_clock(void* handle)
+{
+	(void)handle;
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static inline void
+host_init(Host* host)
+{
+	memset(host, 0, sizeof(Host));
+	host->map.handle    = host;
+	host->map.map       = host_map_uri;
+	host->unmap.handle  = host;
+	host->unmap.unmap   = host_unmap_uri;
+	host->log.handle    = host;
+	host->log.printf    = host_printf;
+	host->log.vprintf   = host_vprintf;
+	host->atom_Chunk    = host_map_uri(host, LV2_ATOM__Chunk);
+	host->atom_Sequence = host_map_uri(host, LV2_ATOM__Sequence);
+}
+
+static inline void
+host_cleanup(Host* host)
+{
+	for (uint32_t i = 0; i < host->n_uris; ++i) {
+		free(host->uris[i]);
+	}
+
+	free(host->uris);
+	host->uris   = NULL;
+	host->n_uris = 0;
+}
+
+static inline const HostPluginInfo*
+host_plugin_info(const char* uri)
+{
+	for (const HostPluginInfo* i = host_plugins; i->uri; ++i) {
+		if (!strcmp(i->uri, uri)) {
+			return i;
+		}
+	}
+
+	return NULL;
+}
+
+static inline void
+host_plugin_unload(HostPlugin* plugin)
+{
+	if (plugin->lib_descriptor) {
+		plugin->lib_descriptor->cleanup(plugin->lib_descriptor->handle);
+		plugin->lib_descriptor = NULL;
+	}
+
+	if (plugin->lib) {
+		dlclose(plugin->lib);
+		plugin->lib = NULL;
+	}
+}
+
+/**
+   Load a plugin, searching the directories in the LV2_PATH environment
+   variable for its bundle.
+
+   If `use_lib` is true and the library provides lv2_lib_descriptor(), the
+   plugin is loaded with that, otherwise with lv2_descriptor().
+*/
+static inline bool
+host_plugin_load_entry(HostPlugin* plugin, const char* uri, bool use_lib)
+{
+	memset(plugin, 0, sizeof(HostPlugin));
+	if (!(plugin->info = host_plugin_info(uri))) {
+		fprintf(stderr, "error: Unknown plugin <%s>\n", uri);
+		return false;
+	}
+
+	const char* dirs = getenv("LV2_PATH");
+	char        path[1024];
+	for (const char* d = dirs ? dirs : "."; *d && !plugin->lib;) {
+		const size_t len = strcspn(d, ":");
+		snprintf(path, sizeof(path), "%.*s/%s/%s.so",
+		         (int)len, d, plugin->info->bundle, plugin->info->binary);
+
+		plugin->lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+		d += len + (d[len] == ':');
+	}
+
+	if (!plugin->lib) {
+		fprintf(stderr, "error: Failed to find %s in LV2_PATH\n",
+		        plugin->info->bundle);
+		return false;
+	}
+
+	// Bundle path is the directory of the library, with a trailing slash
+	const size_t bundle_len = (size_t)(strrchr(path, '/') - path) + 1;
+	snprintf(plugin->bundle_path, sizeof(plugin->bundle_path), "%.*s",
+	         (int)bundle_len, path);
+
+	LV2_Lib_Descriptor_Function ldf = NULL;
+	LV2_Descriptor_Function     df  = NULL;
+	if (use_lib) {
+		*(void**)&ldf = dlsym(plugin->lib, "lv2_lib_descriptor");
+	}
+
+	if (ldf) {
+		static const LV2_Feature* const no_features[] = { NULL };
+
+		plugin->lib_descriptor = ldf(plugin->bundle_path, no_features);
+	} else {
+		*(void**)&df = dlsym(plugin->lib, "lv2_descriptor");
+	}
+
+	const LV2_Lib_Descriptor* const ld = plugin->lib_descriptor;
+	for (uint32_t i = 0; (ld || df) && !plugin->descriptor; ++i) {
+		const LV2_Descriptor* const desc =
+			ld ? ld->get_plugin(ld->handle, i) : df(i);
+		if (!desc) {
+			break;
+		} else if (!strcmp(desc->URI, uri)) {
+			plugin->descriptor = desc;
+		}
+	}
+
+	if (!plugin->descriptor) {
+		fprintf(stderr, "error: <%s> not found in %s\n", uri, path);
+		host_plugin_unload(plugin);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+   Load a plugin with lv2_lib_descriptor() if possible.
+*/
+static inline bool
+host_plugin_load(HostPlugin* plugin, const char* uri)
+{
+	return host_plugin_load_entry(plugin, uri, true);
+}
+
+/** Append a message with a size prefix to a worker queue. */
+static inline LV2_Worker_Status
+host_queue_push(uint8_t*    queue,
+                uint32_t*   queue_size,
+                uint32_t    size,
+                const void* data)
+{
+	const uint32_t pad = (size + 7U) & ~7U;
+	if (*queue_size + sizeof(uint32_t) + pad > HOST_WORK_CAPACITY) {
+		return LV2_WORKER_ERR_NO_SPACE;
+	}
+
+	uint8_t* const r = queue + *queue_size;
+	memcpy(r, &size, sizeof(size));
+	memcpy(r + sizeof(uint32_t), data, size);
+	*queue_size += (uint32_t)sizeof(uint32_t) + pad;
+	return LV2_WORKER_SUCCESS;
+}
+
+static inline LV2_Worker_Status
+host_respond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data)
+{
+	HostInstance* const inst = (HostInstance*)handle;
+	return host_queue_push(
+		inst->responses, &inst->responses_size, size, data);
+}
+
+static inline LV2_Worker_Status
+host_schedule_work(LV2_Worker_Schedule_Handle handle,
+                   uint32_t                   size,
+                   const void*                data)
+{
+	HostInstance* const inst = (HostInstance*)handle;
+	if (!inst->worker) {
+		return LV2_WORKER_ERR_UNKNOWN;
+	} else if (inst->running) {
+		// Defer work until after run(), so it is not part of the cycle
+		return host_queue_push(
+			inst->requests, &inst->requests_size, size, data);
+	}
+
+	return inst->worker->work(inst->handle, host_respond, inst, size, data);
+}
+
+static inline void
+host_add_feature(HostInstance* inst, const char* uri, void* data)
+{
+	const LV2_Feature feature = { uri, data };
+
+	inst->features[inst->n_features]     = feature;
+	inst->feature_list[inst->n_features] = &inst->features[inst->n_features];
+	++inst->n_features;
+}
+
+/**
+   Instantiate a plugin and connect every port to a buffer.
+
+   If `prototype` is non-NULL, it is passed to the plugin with the
+   clone:prototype feature, so the plugin may copy from it rather than
+   initialising everything from scratch.  It must be an instance of the same
+   plugin with the same rate.
+
+   If the host has a trace capacity, a recorder with that many regions is
+   allocated for the instance.  The capacity must be a power of 2.
+
+   Audio inputs are filled with a sine, and atom inputs are empty sequences,
+   until they are connected elsewhere by the caller.
+*/
+static inline bool
+host_instantiate_from(HostInstance*       inst,
+                      Host*               host,
+                      const HostPlugin*   plugin,
+                      double              rate,
+                      uint32_t            block_length,
+                      const HostInstance* prototype)
+{
+	memset(inst, 0, sizeof(HostInstance));
+	inst->host                   = host;
+	inst->plugin                 = plugin;
+	inst->n_ports                = (uint32_t)strlen(plugin->info->ports);
+	inst->block_length           = block_length;
+	inst->schedule.handle        = inst;
+	inst->schedule.schedule_work = host_schedule_work;
+
+	host_add_feature(inst, LV2_URID__map, &host->map);
+	host_add_feature(inst, LV2_URID__unmap, &host->unmap);
+	host_add_feature(inst, LV2_LOG__log, &host->log);
+	host_add_feature(inst, LV2_WORKER__schedule, &inst->schedule);
+
+	if (host->trace_capacity) {
+		LV2_Trace_Region* const regions = (LV2_Trace_Region*)calloc(
+			host->trace_capacity, sizeof(LV2_Trace_Region));
+		if (!regions) {
+			return false;
+		}
+
+		lv2_trace_recorder_init(&inst->recorder,
+		                        ++host->n_recorders,
+		                        plugin->info->uri,
+		                        regions,
+		                        host->trace_capacity,
+		                        host_trace_clock,
+		                        NULL);
+
+		inst->tracer = &inst->recorder.tracer;
+		host_add_feature(inst, LV2_TRACE__tracer, &inst->recorder.tracer);
+	}
+
+	if (prototype) {
+		inst->prototype.descriptor = prototype->plugin->descriptor;
+		inst->prototype.instance   = prototype->handle;
+		host_add_feature(inst, LV2_CLONE__prototype, &inst->prototype);
+	}
+
+	const LV2_Descriptor* const desc = plugin->descriptor;
+	if (!(inst->handle = desc->instantiate(
+		      desc, rate, plugin->bundle_path, inst->feature_list))) {
+		fprintf(stderr, "error: Failed to instantiate <%s>\n", desc->URI);
+		return false;
+	}
+
+	if (desc->extension_data) {
+		inst->worker = (const LV2_Worker_Interface*)desc->extension_data(
+			LV2_WORKER__interface);
+	}
+
+	for (uint32_t p = 0; p < inst->n_ports; ++p) {
+		const char type = plugin->info->ports[p];
+		if (type == 'c') {
+			desc->connect_port(inst->handle, p, &inst->controls[p]);
+			continue;
+		}
+
+		const size_t size = (type == 'e' || type == 'E')
+			? HOST_ATOM_CAPACITY : block_length * sizeof(float);
+		if (!(inst->buffers[p] = calloc(1, size))) {
+			return false;
+		}
+
+		if (type == 'a') {
+			float* const in = (float*)inst->buffers[p];
+			for (uint32_t i = 0; i < block_length; ++i) {
+				in[i] = 0.5f * sinf((float)(i * 2.0 * HOST_PI * 440.0 / rate));
+			}
+		} else if (type == 'e') {
+			LV2_Atom* const seq = (LV2_Atom*)inst->buffers[p];
+			seq->size = sizeof(LV2_Atom_Sequence_Body);
+			seq->type = host->atom_Sequence;
+		}
+
+		desc->connect_port(inst->handle, p, inst->buffers[p]);
+	}
+
+	if (desc->activate) {
+		desc->activate(inst->handle);
+	}
+
+	return true;
+}
+
+/** Instantiate a plugin from scratch, see host_instantiate_from(). */
+static inline bool
+host_instantiate(HostInstance*     inst,
+                 Host*             host,
+                 const HostPlugin* plugin,
+                 double            rate,
+                 uint32_t          block_length)
+{
+	return host_instantiate_from(inst, host, plugin, rate, block_length, NULL);
+}
+
+/**
+   Call run() for one cycle, without doing any work it schedules.
+
+   Atom outputs are reset to empty chunks before run().  This is the part of
+   a cycle that runs in the audio thread, so the time it takes is the
+   realtime load of the plugin.  The cycle must be finished with
+   host_finish_cycle().
+*/
+static inline void
+host_run_plugin(HostInstance* inst, uint32_t n_frames)
+{
+	for (uint32_t p = 0; p < inst->n_ports; ++p) {
+		if (inst->plugin->info->ports[p] == 'E') {
+			LV2_Atom* const out = (LV2_Atom*)inst->buffers[p];
+			out->size = HOST_ATOM_CAPACITY - sizeof(LV2_Atom);
+			out->type = inst->host->atom_Chunk;
+		}
+	}
+
+	inst->running = true;
+	lv2_trace_begin(inst->tracer, "run");
+	inst->plugin->descriptor->run(inst->handle, n_frames);
+	lv2_trace_end(inst->tracer, "run");
+	inst->running = false;
+}
+
+/**
+   Finish a cycle started with host_run_plugin().
+
+   Work scheduled in run() is done, then the worker responses are delivered.
+*/
+static inline void
+host_finish_cycle(HostInstance* inst)
+{
+	if (inst->worker) {
+		for (uint32_t offset = 0; offset < inst->requests_size;) {
+			uint32_t size = 0;
+			memcpy(&size, inst->requests + offset, sizeof(size));
+			inst->worker->work(inst->handle, host_respond, inst, size,
+			                   inst->requests + offset + sizeof(size));
+			offset += (uint32_t)sizeof(uint32_t) + ((size + 7U) & ~7U);
+		}
+
+		inst->requests_size = 0;
+		for (uint32_t offset = 0; offset < inst->responses_size;) {
+			uint32_t size = 0;
+			memcpy(&size, inst->responses + offset, sizeof(size));
+			inst->worker->work_response(
+				inst->handle, size, inst->responses + offset + sizeof(size));
+			offset += (uint32_t)sizeof(uint32_t) + ((size + 7U) & ~7U);
+		}
+
+		inst->responses_size = 0;
+		if (inst->worker->end_run) {
+			inst->worker->end_run(inst->handle);
+		}
+	}
+}
+
+/**
+   Run an instance for one cycle.
+
+   This calls run(), then does any work it scheduled and delivers the worker
+   responses.
+*/
+static inline void
+host_run(HostInstance* inst, uint32_t n_frames)
+{
+	host_run_plugin(inst, n_frames);
+	host_finish_cycle(inst);
+}
+
+/** Connect an atom input to a sequence owned by the caller. */
+static inline void
+host_connect_sequence(HostInstance*            inst,
+                      uint32_t                 port,
+                      const LV2_Atom_Sequence* seq)
+{
+	inst->plugin->descriptor->connect_port(inst->handle, port, (void*)seq);
+}
+
+/** Return the index of the first port of the given type, or -1. */
+static inline int
+host_find_port(const HostInstance* inst, char type)
+{
+	const char* const p = strchr(inst->plugin->info->ports, type);
+	return p ? (int)(p - inst->plugin->info->ports) : -1;
+}
+
+static inline void
+host_free_instance(HostInstance* inst)
+{
+	if (inst->handle) {
+		if (inst->plugin->descriptor->deactivate) {
+			inst->plugin->descriptor->deactivate(inst->handle);
+		}
+
+		inst->plugin->descriptor->cleanup(inst->handle);
+		inst->handle = NULL;
+	}
+
+	for (uint32_t p = 0; p < inst->n_ports; ++p) {
+		free(inst->buffers[p]);
+		inst->buffers[p] = NULL;
+	}
+
+	free(inst->recorder.regions);
+	inst->recorder.regions = NULL;
+	inst->tracer           = NULL;
+}
+
+#endif  /* LV2_UTIL_HOST_H */
@@ -0,0 +1,282 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark the example plugins.
+
+   Every plugin is instantiated for every combination of sample rate and
+   block length, and run() is called for a number of cycles, which are timed
+   individually.  The mean time per sample, the 50th, 90th and 99th
+   percentile cycle times, and the worst cycle time are printed for each, as
+   tab-separated lines or as JSON.  Times are in ns.  Work scheduled by the
+   plugin is done after each cycle, and is not included, since a real host
+   does it in another thread.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "host.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_VALUES 16
+#define N_WARMUP   16
+
+typedef struct {
+	const char* uri;
+	double      rate;
+	uint32_t    block_length;
+	uint32_t    n_cycles;
+	double      ns_per_sample;
+	double      p50;
+	double      p90;
+	double      p99;
+	double      worst;
+} Result;
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int
+compare_doubles(const void* a, const void* b)
+{
+	const double da = *(const double*)a;
+	const double db = *(const double*)b;
+	return (da > db) - (da < db);
+}
+
+/** Return the nearest-rank percentile `p` of sorted `values`. */
+static double
+percentile(const double* values, uint32_t n, double p)
+{
+	const uint32_t rank = (uint32_t)(p * n + 0.999999);
+	return values[rank > 0 ? rank - 1 : 0];
+}
+
+/** Parse a comma-separated list of positive numbers. */
+static unsigned
+parse_list(const char* str, double* values)
+{
+	unsigned n = 0;
+	for (const char* s = str; *s && n < MAX_VALUES;) {
+		char* end = NULL;
+		if ((values[n] = strtod(s, &end)) <= 0.0 || end == s ||
+		    (*end && *end != ',')) {
+			return 0;
+		}
+
+		++n;
+		s = *end ? end + 1 : end;
+	}
+
+	return n;
+}
+
+static bool
+bench(Host*             host,
+      const HostPlugin* plugin,
+      double*           times,
+      Result*           result)
+{
+	HostInstance inst;
+	if (!host_instantiate(
+		    &inst, host, plugin, result->rate, result->block_length)) {
+		host_free_instance(&inst);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < N_WARMUP; ++i) {
+		host_run(&inst, result->block_length);
+	}
+
+	double total = 0.0;
+	for (uint32_t i = 0; i < result->n_cycles; ++i) {
+		// Time only run(), since work is done in another thread
+		const double start = now();
+		host_run_plugin(&inst, result->block_length);
+		times[i] = now() - start;
+		total += times[i];
+		host_finish_cycle(&inst);
+	}
+
+	host_free_instance(&inst);
+
+	qsort(times, result->n_cycles, sizeof(double), compare_doubles);
+	result->ns_per_sample =
+		total / ((double)result->n_cycles * result->block_length);
+	result->p50   = percentile(times, result->n_cycles, 0.50);
+	result->p90   = percentile(times, result->n_cycles, 0.90);
+	result->p99   = percentile(times, result->n_cycles, 0.99);
+	result->worst = times[result->n_cycles - 1];
+	return true;
+}
+
+static void
+print_result(const Result* result, bool json, bool first)
+{
+	if (json) {
+		printf("%s\n  {\"plugin\": \"%s\", \"rate\": %.0f, \"block\": %u, "
+		       "\"cycles\": %u, \"ns_per_sample\": %.3f, \"p50\": %.0f, "
+		       "\"p90\": %.0f, \"p99\": %.0f, \"max\": %.0f}",
+		       first ? "" : ",",
+		       result->uri,
+		       result->rate,
+		       result->block_length,
+		       result->n_cycles,
+		       result->ns_per_sample,
+		       result->p50,
+		       result->p90,
+		       result->p99,
+		       result->worst);
+	} else {
+		printf("%s\t%.0f\t%u\t%.3f\t%.0f\t%.0f\t%.0f\t%.0f\n",
+		       result->uri,
+		       result->rate,
+		       result->block_length,
+		       result->ns_per_sample,
+		       result->p50,
+		       result->p90,
+		       result->p99,
+		       result->worst);
+	}
+}
+
+static int
+print_usage(const char* name, int error)
+{
+	FILE* const os = error ? stderr : stdout;
+	fprintf(os, "Usage: %s [OPTION]... [PLUGIN_URI]...\n", name);
+	fprintf(os, "Benchmark plugins, or all example plugins found.\n\n");
+	fprintf(os, "  -b SIZES  Block lengths (default: 64,256,1024)\n");
+	fprintf(os, "  -h        Display this help and exit\n");
+	fprintf(os, "  -j        Write results as JSON\n");
+	fprintf(os, "  -n N      Run N cycles for each case (default: 1000)\n");
+	fprintf(os, "  -s RATES  Sample rates (default: 48000)\n");
+	fprintf(os, "\nPlugins are searched for in LV2_PATH.  Lists are "
+	        "separated by commas.\n");
+	return error;
+}
+
+int
+main(int argc, char** argv)
+{
+	double   blocks[MAX_VALUES] = { 64, 256, 1024 };
+	double   rates[MAX_VALUES]  = { 48000 };
+	unsigned n_blocks           = 3;
+	unsigned n_rates            = 1;
+	uint32_t n_cycles           = 1000;
+	bool     json               = false;
+
+	int o = 0;
+	while ((o = getopt(argc, argv, "b:hjn:s:")) != -1) {
+		switch (o) {
+		case 'b':
+			if (!(n_blocks = parse_list(optarg, blocks))) {
+				return print_usage(argv[0], 1);
+			}
+			break;
+		case 'h':
+			return print_usage(argv[0], 0);
+		case 'j':
+			json = true;
+			break;
+		case 'n':
+			n_cycles = (uint32_t)strtoul(optarg, NULL, 10);
+			break;
+		case 's':
+			if (!(n_rates = parse_list(optarg, rates))) {
+				return print_usage(argv[0], 1);
+			}
+			break;
+		default:
+			return print_usage(argv[0], 1);
+		}
+	}
+
+	if (!n_cycles) {
+		return print_usage(argv[0], 1);
+	}
+
+	// Benchmark the given plugins, or every example that can be loaded
+	const bool  all       = optind == argc;
+	const char* uris[16]  = { NULL };
+	unsigned    n_plugins = 0;
+	if (all) {
+		for (const HostPluginInfo* i = host_plugins; i->uri; ++i) {
+			uris[n_plugins++] = i->uri;
+		}
+	} else {
+		for (int i = optind; i < argc && n_plugins < 16; ++i) {
+			uris[n_plugins++] = argv[i];
+		}
+	}
+
+	double* const times = (double*)calloc(n_cycles, sizeof(double));
+	if (!times) {
+		return 1;
+	}
+
+	Host host;
+	host_init(&host);
+
+	int  ret   = 0;
+	bool first = true;
+	if (json) {
+		printf("[");
+	}
+
+	for (unsigned p = 0; p < n_plugins; ++p) {
+		HostPlugin plugin;
+		if (!host_plugin_load(&plugin, uris[p])) {
+			ret = all ? ret : 1;
+			continue;
+		}
+
+		for (unsigned r = 0; r < n_rates; ++r) {
+			for (unsigned b = 0; b < n_blocks; ++b) {
+				Result result = { uris[p], rates[r], (uint32_t)blocks[b],
+				                  n_cycles, 0.0, 0.0, 0.0, 0.0, 0.0 };
+				if (bench(&host, &plugin, times, &result)) {
+					print_result(&result, json, first);
+					first = false;
+				} else {
+					ret = 1;
+				}
+			}
+		}
+
+		host_plugin_unload(&plugin);
+	}
+
+	if (json) {
+		printf("\n]\n");
+	}
+
+	host_cleanup(&host);
+	free(times);
+	return first ? 1 : ret;
+}
@@ -0,0 +1,288 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark running a graph of example plugins in parallel.
+
+   The graph has a layer of metronomes, followed by layers of amplifiers that
+   each read an output of the previous layer, where half of the nodes in a
+   layer feed two amplifiers and the rest feed none.  It is run for a number
+   of cycles in topological order on one thread as a baseline, then on the
+   pool with each number of threads.
+
+   For each, a tab-separated line is printed with the number of threads, the
+   number of nodes, the mean and 99th percentile cycle times, the speedup
+   over the baseline, and the scheduling overhead per node.  The overhead is
+   the CPU time spent on all threads beyond that of the baseline, so with one
+   thread it is the cost of scheduling alone.  Times are in ns.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "graph.h"
+#include "host.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define AMP_URI    "http://lv2plug.in/plugins/eg-amp"
+#define METRO_URI  "http://lv2plug.in/plugins/eg-metro"
+#define MAX_VALUES 16
+#define N_WARMUP   16
+
+typedef struct {
+	double mean;
+	double p99;
+} Times;
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int
+compare_doubles(const void* a, const void* b)
+{
+	const double da = *(const double*)a;
+	const double db = *(const double*)b;
+	return (da > db) - (da < db);
+}
+
+/** Parse a comma-separated list of positive integers. */
+static unsigned
+parse_list(const char* str, uint32_t* values)
+{
+	unsigned n = 0;
+	for (const char* s = str; *s && n < MAX_VALUES;) {
+		char* end = NULL;
+		if (!(values[n] = (uint32_t)strtoul(s, &end, 10)) || end == s ||
+		    (*end && *end != ',')) {
+			return 0;
+		}
+
+		++n;
+		s = *end ? end + 1 : end;
+	}
+
+	return n;
+}
+
+/** Run the graph for `n_cycles`, on the pool if `parallel`. */
+static Times
+bench(Graph*   graph,
+      bool     parallel,
+      uint32_t block_length,
+      uint32_t n_cycles,
+      double*  times)
+{
+	for (uint32_t i = 0; i < N_WARMUP; ++i) {
+		if (parallel) {
+			graph_run(graph, block_length);
+		} else {
+			graph_run_serial(graph, block_length);
+		}
+		graph_finish_cycle(graph);
+	}
+
+	double total = 0.0;
+	for (uint32_t i = 0; i < n_cycles; ++i) {
+		const double start = now();
+		if (parallel) {
+			graph_run(graph, block_length);
+		} else {
+			graph_run_serial(graph, block_length);
+		}
+		times[i] = now() - start;
+		total += times[i];
+		graph_finish_cycle(graph);
+	}
+
+	qsort(times, n_cycles, sizeof(double), compare_doubles);
+
+	const uint32_t rank = (uint32_t)(0.99 * n_cycles + 0.999999);
+	const Times    result = { total / n_cycles, times[rank - 1] };
+	return result;
+}
+
+/** Instantiate the nodes of a graph with `width` nodes in each layer. */
+static bool
+build(Graph*            graph,
+      HostInstance*     insts,
+      Host*             host,
+      const HostPlugin* metro,
+      const HostPlugin* amp,
+      uint32_t          width,
+      uint32_t          depth,
+      uint32_t          block_length)
+{
+	for (uint32_t l = 0; l < depth; ++l) {
+		for (uint32_t c = 0; c < width; ++c) {
+			HostInstance* const inst = &insts[l * width + c];
+			if (!host_instantiate(inst, host, l ? amp : metro, 48000.0,
+			                      block_length)) {
+				return false;
+			}
+
+			const uint32_t node = graph_add(graph, inst);
+			if (node == UINT32_MAX) {
+				return false;
+			}
+
+			if (l > 0) {
+				// Connect the amp input to the output of the previous layer
+				const uint32_t col  = c / 2 + (l % 2) * (width / 2);
+				const uint32_t src  = (l - 1) * width + col % width;
+				const uint32_t port = l > 1 ? 2 : 1;
+				if (!graph_connect(graph, src, port, node, 1)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+static int
+print_usage(const char* name, int error)
+{
+	FILE* const os = error ? stderr : stdout;
+	fprintf(os, "Usage: %s [OPTION]...\n", name);
+	fprintf(os, "Benchmark running a graph of plugins in parallel.\n\n");
+	fprintf(os, "  -b LENGTH  Block length (default: 256)\n");
+	fprintf(os, "  -d DEPTH   Number of layers (default: 8)\n");
+	fprintf(os, "  -h         Display this help and exit\n");
+	fprintf(os, "  -n N       Run N cycles for each case (default: 1000)\n");
+	fprintf(os, "  -t COUNTS  Numbers of threads (default: 1,CPUS)\n");
+	fprintf(os, "  -w WIDTH   Number of nodes in a layer (default: 32)\n");
+	fprintf(os, "\nPlugins are searched for in LV2_PATH.  Lists are "
+	        "separated by commas.\n");
+	return error;
+}
+
+int
+main(int argc, char** argv)
+{
+	const long n_cpus              = sysconf(_SC_NPROCESSORS_ONLN);
+	uint32_t   threads[MAX_VALUES] = { 1, n_cpus > 1 ? (uint32_t)n_cpus : 2 };
+	unsigned   n_threads           = 2;
+	uint32_t   block_length        = 256;
+	uint32_t   depth               = 8;
+	uint32_t   width               = 32;
+	uint32_t   n_cycles            = 1000;
+
+	int o = 0;
+	while ((o = getopt(argc, argv, "b:d:hn:t:w:")) != -1) {
+		switch (o) {
+		case 'b':
+			block_length = (uint32_t)strtoul(optarg, NULL, 10);
+			break;
+		case 'd':
+			depth = (uint32_t)strtoul(optarg, NULL, 10);
+			break;
+		case 'h':
+			return print_usage(argv[0], 0);
+		case 'n':
+			n_cycles = (uint32_t)strtoul(optarg, NULL, 10);
+			break;
+		case 't':
+			if (!(n_threads = parse_list(optarg, threads))) {
+				return print_usage(argv[0], 1);
+			}
+			break;
+		case 'w':
+			width = (uint32_t)strtoul(optarg, NULL, 10);
+			break;
+		default:
+			return print_usage(argv[0], 1);
+		}
+	}
+
+	if (!block_length || !depth || !width || !n_cycles || optind < argc) {
+		return print_usage(argv[0], 1);
+	}
+
+	Host       host;
+	HostPlugin metro;
+	HostPlugin amp;
+	host_init(&host);
+	if (!host_plugin_load(&metro, METRO_URI)) {
+		host_cleanup(&host);
+		return 1;
+	} else if (!host_plugin_load(&amp, AMP_URI)) {
+		host_plugin_unload(&metro);
+		host_cleanup(&host);
+		return 1;
+	}
+
+	const uint32_t      n_nodes = width * depth;
+	HostInstance* const insts =
+		(HostInstance*)calloc(n_nodes, sizeof(HostInstance));
+	double* const times = (double*)calloc(n_cycles, sizeof(double));
+
+	int ret = 1;
+	if (insts && times) {
+		ret = 0;
+		for (unsigned t = 0; t < n_threads && !ret; ++t) {
+			Graph graph;
+			graph_init(&graph);
+			if (!build(&graph, insts, &host, &metro, &amp, width, depth,
+			           block_length) ||
+			    !graph_start(&graph, threads[t])) {
+				fprintf(stderr, "error: Failed to build graph\n");
+				ret = 1;
+			} else {
+				const Times serial =
+					bench(&graph, false, block_length, n_cycles, times);
+				const Times parallel =
+					bench(&graph, true, block_length, n_cycles, times);
+
+				if (t == 0) {
+					printf("serial\t%u\t%.0f\t%.0f\t%.2f\t%.1f\n",
+					       n_nodes, serial.mean, serial.p99, 1.0, 0.0);
+				}
+
+				printf("%u\t%u\t%.0f\t%.0f\t%.2f\t%.1f\n",
+				       graph.n_threads,
+				       n_nodes,
+				       parallel.mean,
+				       parallel.p99,
+				       serial.mean / parallel.mean,
+				       (parallel.mean * graph.n_threads - serial.mean) /
+				       n_nodes);
+			}
+
+			graph_free(&graph);
+			for (uint32_t i = 0; i < n_nodes; ++i) {
+				host_free_instance(&insts[i]);
+			}
+		}
+	}
+
+	free(times);
+	free(insts);
+	host_plugin_unload(&amp);
+	host_plugin_unload(&metro);
+	host_cleanup(&host);
+	return ret;
+}
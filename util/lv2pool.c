@@ -0,0 +1,268 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Benchmark creating many instances of the example plugins.
+
+   For each plugin, a number of instances are created with instantiate(),
+   first from scratch and then with a clone:prototype, and a pool of the same
+   size is filled and every instance taken from it and returned.  Only the
+   call to instantiate() is timed, not the allocation of port buffers by the
+   host.  This is done once with the descriptor from lv2_descriptor(), and
+   again from lv2_lib_descriptor() if the plugin provides it, where instances
+   may share resources.
+
+   For each, a tab-separated line is printed with the entry point, the number
+   of instances, the mean heap memory used by an instance created from
+   scratch, the mean time to instantiate from scratch and from a prototype,
+   and the mean times to take an instance from the pool and to return it.
+   Memory is in bytes and times are in ns.  Memory is only measured with
+   glibc, and is otherwise zero.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "host.h"
+#include "pool.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __GLIBC__
+#    include <malloc.h>
+#endif
+
+#define RATE 48000.0
+
+typedef struct {
+	double bytes;
+	double scratch;
+	double clone;
+	double acquire;
+	double release;
+} Result;
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/** Return the number of bytes allocated on the heap. */
+static double
+heap_size(void)
+{
+#if defined(__GLIBC__) && \
+	(__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	return (double)mallinfo2().uordblks;
+#else
+	return 0.0;
+#endif
+}
+
+/**
+   Instantiate `n` instances with `features`, and return the mean time.
+
+   If `bytes` is not NULL, it is set to the mean heap size of an instance.
+*/
+static double
+instantiate_all(const LV2_Descriptor*     desc,
+                const char*               bundle,
+                const LV2_Feature* const* features,
+                LV2_Handle*               handles,
+                uint32_t                  n,
+                double*                   bytes)
+{
+	const double heap_start = heap_size();
+	const double start      = now();
+	for (uint32_t i = 0; i < n; ++i) {
+		handles[i] = desc->instantiate(desc, RATE, bundle, features);
+	}
+	const double ns = (now() - start) / n;
+	if (bytes) {
+		*bytes = (heap_size() - heap_start) / n;
+	}
+
+	bool ok = true;
+	for (uint32_t i = 0; i < n; ++i) {
+		ok = ok && handles[i];
+		if (handles[i]) {
+			desc->cleanup(handles[i]);
+		}
+	}
+
+	return ok ? ns : -1.0;
+}
+
+static bool
+bench(Host* host, const HostPlugin* plugin, uint32_t n, Result* result)
+{
+	LV2_Handle* const handles = (LV2_Handle*)calloc(n, sizeof(LV2_Handle));
+	if (!handles) {
+		return false;
+	}
+
+	/* Instantiate directly with the features of a host instance, which are
+	   the same as for a clone, except the clone has a prototype. */
+	HostInstance proto;
+	HostInstance clone;
+	memset(&clone, 0, sizeof(clone));
+	bool ok = host_instantiate(&proto, host, plugin, RATE, 64) &&
+	          host_instantiate_from(&clone, host, plugin, RATE, 64, &proto);
+	if (ok) {
+		const LV2_Descriptor* const desc   = plugin->descriptor;
+		const char* const           bundle = plugin->info->bundle;
+
+		result->scratch = instantiate_all(
+			desc, bundle, proto.feature_list, handles, n, &result->bytes);
+		result->clone = instantiate_all(
+			desc, bundle, clone.feature_list, handles, n, NULL);
+		ok = result->scratch >= 0.0 && result->clone >= 0.0;
+	}
+
+	host_free_instance(&clone);
+	host_free_instance(&proto);
+	free(handles);
+
+	HostPool pool;
+	if (!ok || !host_pool_init(&pool, host, plugin, RATE, 64, n)) {
+		return false;
+	}
+
+	// Take every instance, then return them all
+	HostInstance** const taken =
+		(HostInstance**)calloc(n, sizeof(HostInstance*));
+	if (taken) {
+		const double acquire_start = now();
+		for (uint32_t i = 0; i < n; ++i) {
+			ok = (taken[i] = host_pool_acquire(&pool)) && ok;
+		}
+		result->acquire = (now() - acquire_start) / n;
+
+		ok = ok && !host_pool_acquire(&pool);
+
+		const double release_start = now();
+		for (uint32_t i = 0; i < n; ++i) {
+			if (taken[i]) {
+				host_pool_release(&pool, taken[i]);
+			}
+		}
+		result->release = (now() - release_start) / n;
+	}
+
+	free(taken);
+	host_pool_free(&pool);
+	return ok && taken;
+}
+
+static int
+print_usage(const char* name, int error)
+{
+	FILE* const os = error ? stderr : stdout;
+	fprintf(os, "Usage: %s [OPTION]... [PLUGIN_URI]...\n", name);
+	fprintf(os, "Benchmark creating many instances of plugins.\n\n");
+	fprintf(os, "  -h    Display this help and exit\n");
+	fprintf(os, "  -n N  Create N instances of each plugin (default: 500)\n");
+	fprintf(os, "\nPlugins are searched for in LV2_PATH.  Without any "
+	        "plugins, all examples found\nare benchmarked.\n");
+	return error;
+}
+
+int
+main(int argc, char** argv)
+{
+	uint32_t n_insts = 500;
+
+	int o = 0;
+	while ((o = getopt(argc, argv, "hn:")) != -1) {
+		switch (o) {
+		case 'h':
+			return print_usage(argv[0], 0);
+		case 'n':
+			n_insts = (uint32_t)strtoul(optarg, NULL, 10);
+			break;
+		default:
+			return print_usage(argv[0], 1);
+		}
+	}
+
+	if (!n_insts) {
+		return print_usage(argv[0], 1);
+	}
+
+	// Benchmark the given plugins, or every example that can be loaded
+	const bool  all       = optind == argc;
+	const char* uris[16]  = { NULL };
+	unsigned    n_plugins = 0;
+	if (all) {
+		for (const HostPluginInfo* i = host_plugins; i->uri; ++i) {
+			uris[n_plugins++] = i->uri;
+		}
+	} else {
+		for (int i = optind; i < argc && n_plugins < 16; ++i) {
+			uris[n_plugins++] = argv[i];
+		}
+	}
+
+	Host host;
+	host_init(&host);
+
+	int  ret  = 0;
+	bool none = true;
+	for (unsigned p = 0; p < n_plugins; ++p) {
+		// Benchmark with lv2_descriptor(), then lv2_lib_descriptor()
+		for (unsigned use_lib = 0; use_lib < 2; ++use_lib) {
+			HostPlugin plugin;
+			if (!host_plugin_load_entry(&plugin, uris[p], use_lib)) {
+				ret = all ? ret : 1;
+				break;
+			} else if (use_lib && !plugin.lib_descriptor) {
+				host_plugin_unload(&plugin);
+				break;
+			}
+
+			Result result = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+			if (bench(&host, &plugin, n_insts, &result)) {
+				printf("%s\t%s\t%u\t%.0f\t%.0f\t%.0f\t%.1f\t%.1f\n",
+				       uris[p],
+				       use_lib ? "lib" : "plain",
+				       n_insts,
+				       result.bytes,
+				       result.scratch,
+				       result.clone,
+				       result.acquire,
+				       result.release);
+				none = false;
+			} else {
+				fprintf(stderr, "error: Failed to instantiate <%s>\n",
+				        uris[p]);
+				ret = 1;
+			}
+
+			host_plugin_unload(&plugin);
+		}
+	}
+
+	host_cleanup(&host);
+	return none ? 1 : ret;
+}
@@ -0,0 +1,190 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   Replay a capture into a plugin.
+
+   Every cycle of the capture (see lv2/atom/capture.h) is connected to the
+   first atom input of the plugin, and run() is called with the number of
+   frames in the cycle.  The time spent in run() for every cycle is measured,
+   and a tab-separated line of plugin URI, cycles, frames, mean ns per frame,
+   and the worst cycle in ns is printed when done.  Work scheduled by the
+   plugin is done after each cycle, and is not included, since a real host
+   does it in another thread.
+
+   With -t, the regions the plugin marks with the trace:tracer feature, and
+   every call to run(), are recorded and written to a JSON file for viewing
+   in Chrome (chrome://tracing) or Perfetto.  Only the first TRACE_CAPACITY
+   regions are recorded, the number dropped after that is noted in the file.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "host.h"
+
+#include "lv2/atom/capture.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRACE_CAPACITY 65536U
+
+static double
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int
+print_usage(const char* name, int error)
+{
+	FILE* const os = error ? stderr : stdout;
+	fprintf(os, "Usage: %s [OPTION]... PLUGIN_URI CAPTURE\n", name);
+	fprintf(os, "Replay a captured input sequence into a plugin.\n\n");
+	fprintf(os, "  -h       Display this help and exit\n");
+	fprintf(os, "  -n N     Replay the capture N times (default: 1)\n");
+	fprintf(os, "  -s RATE  Run at sample rate RATE (default: 48000)\n");
+	fprintf(os, "  -t FILE  Write a JSON trace to FILE\n");
+	fprintf(os, "\nPlugins are searched for in LV2_PATH.\n");
+	return error;
+}
+
+int
+main(int argc, char** argv)
+{
+	unsigned    n_repeats  = 1;
+	double      rate       = 48000.0;
+	const char* trace_path = NULL;
+
+	int o = 0;
+	while ((o = getopt(argc, argv, "hn:s:t:")) != -1) {
+		switch (o) {
+		case 'h':
+			return print_usage(argv[0], 0);
+		case 'n':
+			n_repeats = (unsigned)strtoul(optarg, NULL, 10);
+			break;
+		case 's':
+			rate = strtod(optarg, NULL);
+			break;
+		case 't':
+			trace_path = optarg;
+			break;
+		default:
+			return print_usage(argv[0], 1);
+		}
+	}
+
+	if (argc - optind != 2 || !n_repeats || rate <= 0.0) {
+		return print_usage(argv[0], 1);
+	}
+
+	const char* const uri  = argv[optind];
+	const char* const path = argv[optind + 1];
+
+	Host host;
+	host_init(&host);
+	host.trace_capacity = trace_path ? TRACE_CAPACITY : 0U;
+
+	LV2_Atom_Replay            replay;
+	const LV2_Atom_File_Status st =
+		lv2_atom_replay_open(&replay, path, &host.map);
+	if (st) {
+		fprintf(stderr, "error: Failed to open capture %s (%d)\n", path, st);
+		host_cleanup(&host);
+		return 1;
+	}
+
+	// Find the longest cycle, so buffers are large enough for all of them
+	uint32_t                 max_frames = 0;
+	uint32_t                 n_frames   = 0;
+	const LV2_Atom_Sequence* seq        = NULL;
+	while ((seq = lv2_atom_replay_next(&replay, &n_frames))) {
+		max_frames = n_frames > max_frames ? n_frames : max_frames;
+	}
+
+	HostPlugin   plugin;
+	HostInstance inst;
+	if (!host_plugin_load(&plugin, uri)) {
+		lv2_atom_replay_close(&replay);
+		host_cleanup(&host);
+		return 1;
+	} else if (!host_instantiate(&inst, &host, &plugin, rate, max_frames) ||
+	           host_find_port(&inst, 'e') < 0) {
+		if (inst.handle) {
+			fprintf(stderr, "error: <%s> has no atom input\n", uri);
+		}
+
+		host_free_instance(&inst);
+		host_plugin_unload(&plugin);
+		lv2_atom_replay_close(&replay);
+		host_cleanup(&host);
+		return 1;
+	}
+
+	const uint32_t in       = (uint32_t)host_find_port(&inst, 'e');
+	uint64_t       total    = 0;
+	double         total_ns = 0.0;
+	double         worst_ns = 0.0;
+	for (unsigned r = 0; r < n_repeats; ++r) {
+		lv2_atom_replay_rewind(&replay);
+		while ((seq = lv2_atom_replay_next(&replay, &n_frames))) {
+			host_connect_sequence(&inst, in, seq);
+
+			// Time only run(), since work is done in another thread
+			const double start = now();
+			host_run_plugin(&inst, n_frames);
+			const double ns = now() - start;
+			host_finish_cycle(&inst);
+
+			total    += n_frames;
+			total_ns += ns;
+			worst_ns  = ns > worst_ns ? ns : worst_ns;
+		}
+	}
+
+	printf("%s\t%u\t%llu\t%.3f\t%.0f\n",
+	       uri,
+	       replay.n_cycles * n_repeats,
+	       (unsigned long long)total,
+	       total ? total_ns / (double)total : 0.0,
+	       worst_ns);
+
+	int ret = 0;
+	if (trace_path) {
+		LV2_Trace_Recorder* const recorders[] = { &inst.recorder };
+
+		FILE* const trace = fopen(trace_path, "w");
+		if (!trace) {
+			fprintf(stderr, "error: Failed to open %s\n", trace_path);
+			ret = 1;
+		} else {
+			lv2_trace_write_json(trace, recorders, 1, (uint32_t)getpid());
+			ret = fclose(trace) ? 1 : 0;
+		}
+	}
+
+	host_free_instance(&inst);
+	host_plugin_unload(&plugin);
+	lv2_atom_replay_close(&replay);
+	host_cleanup(&host);
+	return ret;
+}
@@ -0,0 +1,138 @@
+/*
+  Copyright 2026 David Robillard <d@drobilla.net>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @file pool.h A pool of pre-instantiated instances for the minimal host.
+
+   A pool instantiates a number of identical instances in advance, so that
+   one can be taken when needed, for example to play a voice, without any
+   allocation or initialisation.  The first instance is created from scratch,
+   and the rest are created with it as a clone:prototype, so plugins that
+   support the feature copy their tables from it rather than building them
+   again for every instance.
+
+   Instances are reset with deactivate() and activate() when they are
+   returned to the pool, so taking one is cheap and realtime safe, but
+   returning one is not.  This only resets what activate() resets, so any
+   other state, such as parameters or a loaded sample, is kept.
+*/
+
+#ifndef LV2_UTIL_POOL_H
+#define LV2_UTIL_POOL_H
+
+#include "host.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** A pool of instances of one plugin. */
+typedef struct {
+	HostInstance*  insts;    /**< Instances, the first is the prototype */
+	HostInstance** idle;     /**< Stack of instances not in use */
+	uint32_t       n_insts;  /**< Number of instances */
+	uint32_t       n_idle;   /**< Number of instances not in use */
+} HostPool;
+
+/** Free every instance in a pool. */
+static inline void
+host_pool_free(HostPool* pool)
+{
+	for (uint32_t i = 0; i < pool->n_insts; ++i) {
+		host_free_instance(&pool->insts[i]);
+	}
+
+	free(pool->idle);
+	free(pool->insts);
+	memset(pool, 0, sizeof(HostPool));
+}
+
+/**
+   Fill a pool with `n_insts` activated instances of a plugin.
+
+   Returns false, with the pool empty, if any instance could not be created.
+*/
+static inline bool
+host_pool_init(HostPool*         pool,
+               Host*             host,
+               const HostPlugin* plugin,
+               double            rate,
+               uint32_t          block_length,
+               uint32_t          n_insts)
+{
+	memset(pool, 0, sizeof(HostPool));
+	pool->insts = (HostInstance*)calloc(n_insts, sizeof(HostInstance));
+	pool->idle  = (HostInstance**)calloc(n_insts, sizeof(HostInstance*));
+	if (!pool->insts || !pool->idle) {
+		host_pool_free(pool);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < n_insts; ++i) {
+		HostInstance* const inst = &pool->insts[i];
+
+		pool->n_insts = i + 1;
+		if (!host_instantiate_from(inst, host, plugin, rate, block_length,
+		                           i ? &pool->insts[0] : NULL)) {
+			host_pool_free(pool);
+			return false;
+		}
+
+		// Push in reverse so that the prototype is taken first
+		pool->idle[n_insts - 1 - i] = inst;
+	}
+
+	pool->n_idle = n_insts;
+	return true;
+}
+
+/**
+   Take an instance from the pool, or return NULL if all are in use.
+
+   This is realtime safe.
+*/
+static inline HostInstance*
+host_pool_acquire(HostPool* pool)
+{
+	return pool->n_idle ? pool->idle[--pool->n_idle] : NULL;
+}
+
+/**
+   Reset an instance taken from the pool and return it.
+
+   The instance is deactivated and activated again, which resets its DSP
+   state, such as filter memory or playback position.  Any other state, such
+   as parameters set by the previous user or a loaded sample, is kept, so a
+   user that needs particular state must set it after acquiring the instance.
+   This is not realtime safe.
+*/
+static inline void
+host_pool_release(HostPool* pool, HostInstance* inst)
+{
+	const LV2_Descriptor* const desc = inst->plugin->descriptor;
+	if (desc->deactivate) {
+		desc->deactivate(inst->handle);
+	}
+
+	if (desc->activate) {
+		desc->activate(inst->handle);
+	}
+
+	pool->idle[pool->n_idle++] = inst;
+}
+
+#endif  /* LV2_UTIL_POOL_H */